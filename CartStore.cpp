@@ -0,0 +1,344 @@
+#include "CartStore.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+    const char* const LOG_HEADER = "CARTLOG 1";
+    const int DEFAULT_FLUSH_MS = 200;
+
+    void appendInt(string& out, int value) {
+        char buf[16];
+        auto res = to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, res.ptr);
+    }
+}
+
+// ==================== CartStore ====================
+
+CartStore::CartStore(string file)
+    : fileName(std::move(file)), loaded(false), liveBytes(0), fileBytes(0), failed(false),
+      foreignFile(false), flushIntervalMs(DEFAULT_FLUSH_MS), stopFlusher(false) {}
+
+CartStore::~CartStore() {
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopFlusher = true;
+    }
+    flusherCv.notify_all();
+    if (flusher.joinable()) flusher.join();
+    lock_guard<mutex> lock(stateMutex);
+    flushLocked();
+}
+
+CartStore& CartStore::instance() {
+    static CartStore store;
+    return store;
+}
+
+bool CartStore::ensureLoaded() {
+    lock_guard<mutex> lock(stateMutex);
+    if (!loaded) loadLocked();
+    return !foreignFile;
+}
+
+// C|userID|lineCount|productID q0 q1 q2 q3 q4 q5|...
+void CartStore::appendRecord(string& out, int userID, const vector<CartLine>& lines) {
+    out += "C|";
+    appendInt(out, userID);
+    out += '|';
+    appendInt(out, static_cast<int>(lines.size()));
+    for (const CartLine& line : lines) {
+        out += '|';
+        appendInt(out, line.productID);
+        for (int q : line.qty) {
+            out += ' ';
+            appendInt(out, q);
+        }
+    }
+    out += '\n';
+}
+
+bool CartStore::parseRecord(string_view line, int& userID, vector<CartLine>& lines) {
+    string_view fields[4];
+    size_t n = splitFields(line, '|', fields, 4);
+    int count;
+    if (n < 3 || fields[0] != "C" || !parseField(fields[1], userID) || userID <= 0 ||
+        !parseField(fields[2], count) || count < 0) {
+        return false;
+    }
+    lines.clear();
+    string_view rest = n == 4 ? fields[3] : string_view();
+    if ((count == 0) != (n == 3)) return false;
+    for (int i = 0; i < count; ++i) {
+        size_t bar = rest.find('|');
+        bool last = i + 1 == count;
+        if (last != (bar == string_view::npos)) return false;     // too few or too many lines
+        string_view nums[8];
+        if (splitFields(rest.substr(0, bar), ' ', nums, 8) != 7) return false;
+        CartLine l;
+        bool any = false;
+        if (!parseField(nums[0], l.productID) || l.productID <= 0) return false;
+        for (int s = 0; s < 6; ++s) {
+            if (!parseField(nums[s + 1], l.qty[s]) || l.qty[s] < 0) return false;
+            any = any || l.qty[s] > 0;
+        }
+        if (!any) return false;
+        lines.push_back(l);
+        if (!last) rest.remove_prefix(bar + 1);
+    }
+    return true;
+}
+
+// Caller holds stateMutex. Replaces the in-memory cart only (no log record).
+void CartStore::setCartLocked(int userID, vector<CartLine> lines) {
+    auto it = carts.find(userID);
+    if (it != carts.end()) {
+        liveBytes -= recordEstimate(it->second);
+        if (lines.empty()) {
+            carts.erase(it);
+            return;
+        }
+        it->second = std::move(lines);
+        liveBytes += recordEstimate(it->second);
+    } else if (!lines.empty()) {
+        liveBytes += recordEstimate(lines);
+        carts.emplace(userID, std::move(lines));
+    }
+}
+
+// Caller holds stateMutex
+bool CartStore::loadLocked() {
+    carts.clear();
+    liveBytes = 0;
+    fileBytes = 0;
+    loaded = true;
+    foreignFile = false;
+    pending.clear();
+    logFile.close();
+
+    MappedFile file;
+    if (!file.open(fileName)) return true;      // no log yet: no carts
+    string_view text = file.view();
+    fileBytes = static_cast<long long>(text.size());
+    // a record cut off by a crash has no line end; it is dropped and the log rewritten below
+    bool torn = !text.empty() && text.back() != '\n';
+    if (torn) text = text.substr(0, text.rfind('\n') + 1);
+
+    LineReader reader(text);
+    string_view line;
+    if (reader.next(line) && line != LOG_HEADER) {
+        // someone else's file: leave it alone (carts are kept in memory only)
+        cout << fileName << " is not a cart log; carts will not be saved." << endl;
+        foreignFile = true;
+        return false;
+    }
+    size_t malformed = 0;
+    int userID;
+    vector<CartLine> lines;
+    while (reader.next(line)) {
+        if (line.empty()) continue;
+        if (parseRecord(line, userID, lines)) setCartLocked(userID, lines);
+        else ++malformed;
+    }
+    file.close();
+    if (malformed > 0) cout << fileName << ": " << malformed << " malformed cart record(s) skipped." << endl;
+    if (torn || malformed > 0) return compactLocked();
+    return true;
+}
+
+// Caller holds stateMutex
+bool CartStore::flushLocked() {
+    if (foreignFile) return false;
+    if (pending.empty()) return true;
+    if (!logFile.isOpen()) {
+        if (!logFile.open(fileName)) {
+            failed = true;
+            return false;
+        }
+        fileBytes = logFile.size();
+        if (fileBytes == 0) {
+            string header = string(LOG_HEADER) + "\n";
+            if (!logFile.append(header.data(), header.size())) {
+                failed = true;
+                return false;
+            }
+            fileBytes = static_cast<long long>(header.size());
+        }
+    }
+    if (!logFile.append(pending.data(), pending.size())) {
+        failed = true;
+        return false;
+    }
+    fileBytes += static_cast<long long>(pending.size());
+    pending.clear();
+    failed = false;
+    if (static_cast<size_t>(fileBytes) > COMPACT_MIN_BYTES && static_cast<size_t>(fileBytes) > 2 * liveBytes) {
+        return compactLocked();
+    }
+    return true;
+}
+
+// Caller holds stateMutex. The rewritten log holds the in-memory state, which already
+// includes every queued record, so the queue is dropped.
+bool CartStore::compactLocked() {
+    if (foreignFile) return false;
+    vector<int> users;
+    users.reserve(carts.size());
+    for (const auto& entry : carts) users.push_back(entry.first);
+    sort(users.begin(), users.end());
+
+    string out = string(LOG_HEADER) + "\n";
+    out.reserve(liveBytes + out.size());
+    for (int userID : users) appendRecord(out, userID, carts[userID]);
+
+    string tmpName = fileName + ".tmp";
+    FILE* f = fopen(tmpName.c_str(), "wb");
+    bool ok = f && fwrite(out.data(), 1, out.size(), f) == out.size();
+    if (f && fclose(f) != 0) ok = false;
+    logFile.close();
+    if (!ok || rename(tmpName.c_str(), fileName.c_str()) != 0) {
+        remove(tmpName.c_str());
+        cout << "Failed to compact " << fileName << endl;
+        failed = true;
+        return false;
+    }
+    fileBytes = static_cast<long long>(out.size());
+    pending.clear();
+    failed = false;
+    return true;
+}
+
+// Caller holds stateMutex
+void CartStore::startFlusherLocked() {
+    if (!flusher.joinable()) flusher = thread(&CartStore::flusherLoop, this);
+}
+
+// Background writer: once records are queued, wait out the flush interval (or until the
+// queue is large) and append them in one write
+void CartStore::flusherLoop() {
+    unique_lock<mutex> lock(stateMutex);
+    while (!stopFlusher) {
+        flusherCv.wait(lock, [this] { return stopFlusher || !pending.empty(); });
+        if (stopFlusher) break;
+        flusherCv.wait_for(lock, chrono::milliseconds(flushIntervalMs),
+                           [this] { return stopFlusher || pending.size() >= FLUSH_BYTES; });
+        if (!flushLocked()) {
+            // keep the records queued; try again after another interval
+            flusherCv.wait_for(lock, chrono::milliseconds(max(flushIntervalMs, 1)), [this] { return stopFlusher; });
+        }
+    }
+}
+
+void CartStore::load(int userID, ShoppingCart& cart) {
+    lock_guard<mutex> lock(stateMutex);
+    if (!loaded) loadLocked();
+    cart.clearCart();
+    auto it = carts.find(userID);
+    if (it == carts.end()) return;
+    for (const CartLine& line : it->second) {
+        for (int s = 0; s < 6; ++s) {
+            if (line.qty[s] > 0) cart.setQuantity(line.productID, static_cast<Size>(s), line.qty[s]);
+        }
+    }
+}
+
+void CartStore::save(int userID, const ShoppingCart& cart) {
+    // cart lines are in productID order, so the same cart always gives the same record
+    vector<CartLine> lines;
+    lines.reserve(cart.getItems().size());
+    for (CartLine line : cart.getItems()) {
+        bool any = false;
+        for (int& q : line.qty) {
+            q = max(q, 0);
+            any = any || q > 0;
+        }
+        if (any) lines.push_back(line);     // a line loaded from an old file may be all zeros
+    }
+
+    lock_guard<mutex> lock(stateMutex);
+    if (!loaded) loadLocked();
+    if (foreignFile) {
+        setCartLocked(userID, std::move(lines));    // this session only
+        return;
+    }
+    bool wasEmpty = pending.empty();
+    appendRecord(pending, userID, lines);
+    setCartLocked(userID, std::move(lines));
+    if (flushIntervalMs == 0) {
+        flushLocked();
+        return;
+    }
+    startFlusherLocked();
+    // wake the flusher only when it has something new to do: start an interval, or write early
+    if (wasEmpty || pending.size() >= FLUSH_BYTES) flusherCv.notify_one();
+}
+
+bool CartStore::hasCart(int userID) const {
+    lock_guard<mutex> lock(stateMutex);
+    return carts.count(userID) != 0;
+}
+
+size_t CartStore::cartCount() const {
+    lock_guard<mutex> lock(stateMutex);
+    return carts.size();
+}
+
+bool CartStore::flush() {
+    lock_guard<mutex> lock(stateMutex);
+    return flushLocked();
+}
+
+bool CartStore::compact() {
+    lock_guard<mutex> lock(stateMutex);
+    if (!loaded && !loadLocked()) return false;
+    return compactLocked();
+}
+
+void CartStore::setFlushInterval(int millis) {
+    lock_guard<mutex> lock(stateMutex);
+    flushIntervalMs = max(millis, 0);
+    if (flushIntervalMs == 0) flushLocked();
+}
+
+size_t CartStore::migrateLegacyFiles(const string& dir) {
+    // cart_<userID>.txt, exactly as ShoppingCart::getShoppingCartFileName writes it
+    vector<pair<int, filesystem::path>> found;
+    error_code ec;
+    for (filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        string name = it->path().filename().string();
+        if (name.size() <= 9 || name.compare(0, 5, "cart_") != 0 || name.compare(name.size() - 4, 4, ".txt") != 0) {
+            continue;
+        }
+        int userID;
+        if (!parseField(string_view(name).substr(5, name.size() - 9), userID) || userID <= 0 ||
+            name != ShoppingCart::getShoppingCartFileName(userID)) {
+            continue;
+        }
+        found.emplace_back(userID, it->path());
+    }
+    if (found.empty()) return 0;
+    if (!ensureLoaded()) return 0;  // nowhere to put them: keep the files
+
+    size_t imported = 0;
+    vector<filesystem::path> migrated;
+    for (const auto& entry : found) {
+        if (hasCart(entry.first)) {
+            migrated.push_back(entry.second);
+            continue;
+        }
+        ShoppingCart cart;
+        if (!cart.loadFromFile(entry.second.string())) continue;
+        save(entry.first, cart);
+        migrated.push_back(entry.second);
+        ++imported;
+    }
+    if (!flush()) return imported;     // keep the old files until the log has the carts
+    for (const auto& path : migrated) filesystem::remove(path, ec);
+    return imported;
+}
@@ -0,0 +1,102 @@
+#ifndef CARTSTORE_H
+#define CARTSTORE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "FileIO.h"
+#include "ShoppingCart.h"
+
+using namespace std;
+
+// ==================== CartStore ====================
+// Every user's cart in one log file (carts.log) instead of one cart_<userID>.txt per user.
+// All carts are held in memory keyed by userID, so loading a cart is one hash lookup.
+// Saving a cart replaces it in memory and queues one record for the log. The queue is
+// written behind, in batches: a background thread appends it every flush interval, or
+// sooner once it grows past FLUSH_BYTES. flush() writes it at once.
+//
+// Log layout: a "CARTLOG 1" line, then one line per saved cart, oldest first:
+//   C|userID|lineCount|productID q0 q1 q2 q3 q4 q5|...     (lineCount 0 = cart emptied)
+// The last record of a user wins. Once the file is more than twice the size of the live
+// records it is compacted (rewritten with one record per non-empty cart).
+//
+// migrateLegacyFiles() moves old cart_<userID>.txt files into the store.
+// All functions are thread-safe.
+class CartStore {
+private:
+    static const size_t FLUSH_BYTES = 64 << 10;     // queue size that triggers an early write
+    static const size_t COMPACT_MIN_BYTES = 1 << 20; // smaller logs are never compacted
+
+    string fileName;
+    bool loaded;
+    unordered_map<int, vector<CartLine>> carts;     // non-empty carts only
+    size_t liveBytes;           // estimated log bytes of the newest record of every cart
+    long long fileBytes;        // current log size
+    string pending;             // records not yet in the file
+    AppendFile logFile;
+    bool failed;                // the last write failed (pending is kept and retried)
+    bool foreignFile;           // the file is not a cart log: it is never written to
+    mutable mutex stateMutex;
+
+    int flushIntervalMs;        // 0 = write on every save
+    thread flusher;
+    condition_variable flusherCv;
+    bool stopFlusher;
+
+    bool loadLocked();
+    bool flushLocked();
+    bool compactLocked();
+    void startFlusherLocked();
+    void flusherLoop();
+    static void appendRecord(string& out, int userID, const vector<CartLine>& lines);
+    static bool parseRecord(string_view line, int& userID, vector<CartLine>& lines);
+    static size_t recordEstimate(const vector<CartLine>& lines) { return 16 + 40 * lines.size(); }
+    void setCartLocked(int userID, vector<CartLine> lines);
+
+public:
+    explicit CartStore(string file = "carts.log");
+    ~CartStore();           // writes what is still queued
+    CartStore(const CartStore&) = delete;
+    CartStore& operator=(const CartStore&) = delete;
+
+    // The single store used by the application
+    static CartStore& instance();
+    static string defaultFileName() { return "carts.log"; }
+
+    const string& getFileName() const { return fileName; }
+    // Read the log on first use only (cheap after that). A missing file is an empty store.
+    // false if the file is not a cart log; the store then keeps carts in memory only and
+    // never writes to (or replaces) that file.
+    bool ensureLoaded();
+
+    // Replace cart with the user's stored cart (emptied if there is none)
+    void load(int userID, ShoppingCart& cart);
+    // Store the user's cart; the log write follows within the flush interval (none if the
+    // file is not a cart log)
+    void save(int userID, const ShoppingCart& cart);
+    bool hasCart(int userID) const;
+    size_t cartCount() const;
+
+    // Write every queued record now (and compact if due). false if the write failed.
+    bool flush();
+    // Rewrite the log with the live carts only
+    bool compact();
+    // How long saved carts may stay queued; 0 writes every save straight through
+    void setFlushInterval(int millis);
+
+    // Import cart_<userID>.txt files from dir for users without a stored cart, then delete
+    // them once the store is flushed (files of users who already have a stored cart are
+    // outdated and deleted too). Returns the number of files imported; unreadable files are
+    // reported by ShoppingCart::loadFromFile and left in place. Nothing is imported or deleted
+    // while the log cannot be loaded.
+    size_t migrateLegacyFiles(const string& dir = ".");
+};
+
+#endif // CARTSTORE_H
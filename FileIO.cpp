@@ -0,0 +1,232 @@
+#include "FileIO.h"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// ==================== AppendFile ====================
+
+bool AppendFile::open(const string& filename) {
+    close();
+#ifdef _WIN32
+    fd = ::_open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(filename.c_str(), O_WRONLY | O_CREAT, 0644);
+#endif
+    if (fd < 0) return false;
+    path = filename;
+    return true;
+}
+
+void AppendFile::close() {
+    if (fd < 0) return;
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+    fd = -1;
+}
+
+long long AppendFile::size() const {
+    if (fd < 0) return -1;
+#ifdef _WIN32
+    return ::_lseeki64(fd, 0, SEEK_END);
+#else
+    return static_cast<long long>(::lseek(fd, 0, SEEK_END));
+#endif
+}
+
+bool AppendFile::append(const char* data, size_t len) {
+    if (fd < 0) return false;
+#ifdef _WIN32
+    if (::_lseeki64(fd, 0, SEEK_END) < 0) return false;
+    while (len > 0) {
+        int n = ::_write(fd, data, static_cast<unsigned>(len));
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+#else
+    if (::lseek(fd, 0, SEEK_END) < 0) return false;
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+#endif
+    return true;
+}
+
+bool AppendFile::writeAt(size_t offset, const char* data, size_t len) {
+    if (fd < 0) return false;
+#ifdef _WIN32
+    if (::_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+    return ::_write(fd, data, static_cast<unsigned>(len)) == static_cast<int>(len);
+#else
+    return ::pwrite(fd, data, len, static_cast<off_t>(offset)) == static_cast<ssize_t>(len);
+#endif
+}
+
+bool AppendFile::truncate(long long length) {
+    if (fd < 0 || length < 0) return false;
+#ifdef _WIN32
+    return ::_chsize_s(fd, length) == 0;
+#else
+    return ::ftruncate(fd, static_cast<off_t>(length)) == 0;
+#endif
+}
+
+bool AppendFile::sync() {
+    if (fd < 0) return false;
+#ifdef _WIN32
+    return ::_commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+// ==================== MappedFile ====================
+
+bool MappedFile::open(const string& filename) {
+    close();
+#ifdef _WIN32
+    int fd = ::_open(filename.c_str(), _O_RDONLY | _O_BINARY);
+    if (fd < 0) return false;
+    long long fileSize = ::_lseeki64(fd, 0, SEEK_END);
+    ::_lseeki64(fd, 0, SEEK_SET);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    long long fileSize = ::fstat(fd, &st) == 0 ? static_cast<long long>(st.st_size) : -1;
+    if (fileSize > 0) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(fileSize), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::madvise(p, static_cast<size_t>(fileSize), MADV_SEQUENTIAL);
+            ::close(fd);
+            ptr = static_cast<const char*>(p);
+            len = static_cast<size_t>(fileSize);
+            mapped = true;
+            return true;
+        }
+    }
+#endif
+    // fallback: read everything in large blocks (also used for pipes / unknown sizes)
+    const size_t BLOCK = size_t(1) << 20;
+    buffer.clear();
+    if (fileSize > 0) buffer.reserve(static_cast<size_t>(fileSize) + BLOCK);
+    bool ok = true;
+    while (true) {
+        size_t old = buffer.size();
+        buffer.resize(old + BLOCK);
+#ifdef _WIN32
+        int n = ::_read(fd, buffer.data() + old, static_cast<unsigned>(BLOCK));
+#else
+        ssize_t n = ::read(fd, buffer.data() + old, BLOCK);
+#endif
+        if (n < 0) ok = false;
+        buffer.resize(old + (n > 0 ? static_cast<size_t>(n) : 0));
+        if (n <= 0) break;
+    }
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+    if (!ok) {
+        buffer.clear();
+        return false;
+    }
+    ptr = buffer.data();
+    len = buffer.size();
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapped) ::munmap(const_cast<char*>(ptr), len);
+#endif
+    mapped = false;
+    ptr = nullptr;
+    len = 0;
+    vector<char>().swap(buffer);
+}
+
+// ==================== LineReader ====================
+
+bool LineReader::next(string_view& line) {
+    if (cur >= end) return false;
+    const char* nl = static_cast<const char*>(memchr(cur, '\n', static_cast<size_t>(end - cur)));
+    const char* stop = nl ? nl : end;
+    const char* lineEnd = (stop > cur && stop[-1] == '\r') ? stop - 1 : stop;
+    line = string_view(cur, static_cast<size_t>(lineEnd - cur));
+    cur = nl ? nl + 1 : end;
+    ++lineNo;
+    return true;
+}
+
+// ==================== Field parsing ====================
+
+namespace {
+    string_view trimSpaces(string_view f) {
+        while (!f.empty() && f.front() == ' ') f.remove_prefix(1);
+        while (!f.empty() && f.back() == ' ') f.remove_suffix(1);
+        return f;
+    }
+
+    template <typename Int>
+    bool parseInteger(string_view f, Int& out) {
+        f = trimSpaces(f);
+        if (!f.empty() && f.front() == '+') f.remove_prefix(1);
+        if (f.empty()) return false;
+        auto [end, ec] = from_chars(f.data(), f.data() + f.size(), out);
+        return ec == errc() && end == f.data() + f.size();
+    }
+}
+
+bool parseField(string_view field, int& out) { return parseInteger(field, out); }
+
+bool parseField(string_view field, long long& out) { return parseInteger(field, out); }
+
+bool parseField(string_view field, double& out) {
+    string_view f = trimSpaces(field);
+    if (f.empty()) return false;
+#if defined(__cpp_lib_to_chars)
+    auto [end, ec] = from_chars(f.data(), f.data() + f.size(), out);
+    return ec == errc() && end == f.data() + f.size();
+#else
+    // standard libraries without floating-point from_chars: strtod on a small copy
+    char buf[64];
+    if (f.size() >= sizeof(buf)) return false;
+    f.copy(buf, f.size());
+    buf[f.size()] = '\0';
+    char* end = nullptr;
+    out = strtod(buf, &end);
+    return end == buf + f.size();
+#endif
+}
+
+size_t splitFields(string_view line, char delim, string_view* fields, size_t maxFields) {
+    size_t count = 0;
+    while (count < maxFields) {
+        size_t pos = (count + 1 == maxFields) ? string_view::npos : line.find(delim);
+        fields[count++] = line.substr(0, pos);
+        if (pos == string_view::npos) break;
+        line.remove_prefix(pos + 1);
+    }
+    return count;
+}
@@ -0,0 +1,83 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Thin wrapper over a raw file descriptor for append-only logs.
+// Writes go straight to the OS (no stdio buffering) so the caller decides
+// when data is batched and when it is forced to disk with sync().
+class AppendFile {
+private:
+    int fd;             // -1 when closed
+    string path;
+
+public:
+    AppendFile() : fd(-1) {}
+    ~AppendFile() { close(); }
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+
+    bool open(const string& filename);     // open (create if missing) for appending
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    const string& getPath() const { return path; }
+
+    long long size() const;                                     // current file size, -1 on error
+    bool append(const char* data, size_t len);                  // write at end of file
+    bool writeAt(size_t offset, const char* data, size_t len);  // overwrite bytes in place
+    bool truncate(long long length);                            // cut the file back to length bytes
+    bool sync();                                                // flush to stable storage
+};
+
+// Read-only view of a whole file for parsers that work in place.
+// The file is memory-mapped where possible; otherwise (or if mapping fails) it is read
+// into one buffer with large block reads. Either way data() stays valid until close().
+class MappedFile {
+private:
+    const char* ptr;
+    size_t len;
+    bool mapped;            // ptr comes from mmap (else it points into buffer)
+    vector<char> buffer;    // fallback storage
+
+public:
+    MappedFile() : ptr(nullptr), len(0), mapped(false) {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& filename);  // false if the file cannot be opened/read
+    void close();
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+    string_view view() const { return string_view(ptr, len); }
+};
+
+// Split a buffer into lines without copying: call next() until it returns false.
+// A trailing '\r' (CRLF files) is dropped; the last line need not end with '\n'.
+class LineReader {
+private:
+    const char* cur;
+    const char* end;
+    size_t lineNo;
+
+public:
+    explicit LineReader(string_view text) : cur(text.data()), end(text.data() + text.size()), lineNo(0) {}
+    bool next(string_view& line);
+    size_t lineNumber() const { return lineNo; }   // 1-based number of the last line returned
+};
+
+// In-place field parsing for the record loaders (no temporary strings).
+// A field must be exactly one number; surrounding spaces are ignored.
+bool parseField(string_view field, int& out);
+bool parseField(string_view field, long long& out);
+bool parseField(string_view field, double& out);
+// Split line at delim into at most maxFields views; returns the number of fields found
+// (the last view holds the rest of the line when there are more).
+size_t splitFields(string_view line, char delim, string_view* fields, size_t maxFields);
+
+#endif // FILEIO_H
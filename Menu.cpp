@@ -1,10 +1,14 @@
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <limits>
 
+#include "CartStore.h"
+#include "OutputSink.h"
 #include "ProductManager.h"
 #include "ShoppingCart.h"
+#include "Snapshot.h"
 #include "User.h"
 
 using namespace std;
@@ -94,6 +98,79 @@ static Size chooseSizeXSXL() {
     return static_cast<Size>(s);
 }
 
+// -------------------- product / cart input --------------------
+// Ask whether the product has sizes and for its stock (XS-XL, or one None count)
+static bool readProductStock(SizeStock& stock) {
+    stock.fill(0);
+    bool hasSize = readInt("Does this product have size attributes? (1 for Yes, 0 for No): ", 0, 1) == 1;
+    if (hasSize) {
+        cout << "Enter stock for each size:\n";
+        const char* names[5] = {"XS: ", "S: ", "M: ", "L: ", "XL: "};
+        for (int i = 0; i < 5; ++i) stock[i] = readInt(names[i], 0, 1000000000);
+    } else {
+        stock[5] = readInt("Enter total stock for this product: ", 0, 1000000000);
+    }
+    return hasSize;
+}
+
+// Ask for quantity and (for sized products) size of a cart line; false if the product
+// cannot be put in a cart at all
+static bool readCartLine(const ProductManager& pm, int productID, Size& size, int& quantity) {
+    const Product* p = pm.getProduct(productID);
+    if (!p) {
+        cout << "Product ID " << productID << " not found.\n";
+        return false;
+    }
+    if (p->getTotalStock() == 0) {
+        cout << "Product ID " << productID << " Product name: " << p->getProductName() << " is out of stock.\n";
+        return false;
+    }
+    quantity = readInt("Please enter quantity: ", 1, 1000000000);
+    size = p->getHasSize() ? chooseSizeXSXL() : Size::None;
+    return true;
+}
+
+// Interactive shortage handler for checkout: show what is missing, then let the
+// user change or drop a line (checkout re-checks afterwards) or cancel
+static ShortageHandler askOnShortage(const ProductManager& pm) {
+    return [&pm](ShoppingCart& cart, const ShortageList& shortages) {
+        cout << "\n========== STOCK SHORTAGE ALERT ==========\n";
+        cout << "The following items have insufficient stock:\n";
+        for (const auto& [productID, itemShortages] : shortages) {
+            const Product* p = pm.getProduct(productID);
+            cout << "\nProduct ID: " << productID << " - " << (p ? p->getProductName() : "Unknown Product") << "\n";
+            for (const auto& [size, shortage] : itemShortages) {
+                cout << "  Size: " << sizeToString(size) << " - Short by: " << shortage
+                     << " (Available: " << (p ? p->getStock(size) : 0) << ")\n";
+            }
+        }
+        cout << "\n============================================\n";
+        cout << "1) Update item quantity\n";
+        cout << "2) Remove item from cart\n";
+        cout << "3) Cancel checkout\n";
+
+        switch (readInt("Enter choice (1-3): ", 1, 3)) {
+            case 1: {
+                int id = readInt("Enter Product ID to update: ", 1, 1000000000);
+                Size size;
+                int quantity;
+                if (readCartLine(pm, id, size, quantity)) {
+                    CartStatus status = cart.updateItem(id, size, quantity, pm);
+                    if (status != CartStatus::Success) cout << "Update failed: " << cartStatusToString(status) << "\n";
+                }
+                return true;
+            }
+            case 2: {
+                int id = readInt("Enter Product ID to remove: ", 1, 1000000000);
+                if (cart.removeItem(id) != CartStatus::Success) cout << "No such item in cart.\n";
+                return true;
+            }
+            default:
+                return false;
+        }
+    };
+}
+
 // -------------------- small UI helpers --------------------
 static void pauseEnter() {
     cout << "Press ENTER to continue...";
@@ -111,6 +188,25 @@ static void showUserInfo(const User& u) {
     cout << "discountRate: " << u.discountRate() << "\n";
 }
 
+// Save the data files, then write the binary snapshot of them (the snapshot stamps the files,
+// so they must be saved first). Prints the reason on failure.
+static bool saveCheckpoint(ProductManager& pm, const UserList& users, int nextUserID, const string& productFile) {
+    if (!pm.saveToFile(productFile) || !User::saveAll(users, nextUserID) ||
+        !TransactionStore::instance().ensureLoaded()) {
+        cout << "Checkpoint failed: data files could not be saved.\n";
+        return false;
+    }
+    SnapshotSources sources;
+    sources.productFile = productFile;
+    SnapshotStatus status = Snapshot::write(Snapshot::defaultFileName(), pm, users, nextUserID,
+                                            TransactionStore::instance(), sources);
+    if (status != SnapshotStatus::Success) {
+        cout << "Checkpoint failed: " << snapshotStatusToString(status) << "\n";
+        return false;
+    }
+    return true;
+}
+
 // -------------------- admin transaction view (NEW) --------------------
 static void adminTransactionsMenu() {
     TransactionManager adminTM(-1); // -1 => no filter, view all
@@ -121,9 +217,10 @@ static void adminTransactionsMenu() {
         cout << "1) Summary (all users)\n";
         cout << "2) Show all invoices (all users)\n";
         cout << "3) Show one invoice by Transaction ID\n";
+        cout << "4) Browse invoices page by page\n";
         cout << "0) Back\n";
 
-        int op = readInt("Choose: ", 0, 3);
+        int op = readInt("Choose: ", 0, 4);
         if (op == 0) return;
 
         switch (op) {
@@ -141,6 +238,24 @@ static void adminTransactionsMenu() {
                 pauseEnter();
                 break;
             }
+            case 4: {
+                const size_t pageSize = 10;
+                int cursor = 0;     // last Transaction ID shown
+                while (true) {
+                    vector<const Transaction*> page = adminTM.getPage(cursor, pageSize);
+                    if (page.empty()) {
+                        cout << "No more invoices.\n";
+                        pauseEnter();
+                        break;
+                    }
+                    ConsoleSink sink;
+                    for (const Transaction* tx : page) tx->displayInvoice(sink.stream());
+                    sink.flush();
+                    cursor = page.back()->getTransactionID();
+                    if (readInt("1) Next page  0) Back: ", 0, 1) == 0) break;
+                }
+                break;
+            }
             default:
                 break;
         }
@@ -149,7 +264,7 @@ static void adminTransactionsMenu() {
 
 // -------------------- admin menu actions --------------------
 // Note: adminMenu now takes additional parameters for user management
-static void adminMenu(ProductManager& pm, vector<User>& users, int& nextUserID) {
+static void adminMenu(ProductManager& pm, UserList& users, int& nextUserID) {
     const string productFile = "products.txt";
 
     while (true) {
@@ -168,9 +283,10 @@ static void adminMenu(ProductManager& pm, vector<User>& users, int& nextUserID)
         cout << "12) Load products from file\n";
         cout << "13) View transaction records (TransactionRecord.txt)\n";
         cout << "14) Manage admin requests\n"; // NEW
+        cout << "15) Checkpoint (save data files + write binary snapshot)\n";
         cout << "0) Back\n";
 
-        int op = readInt("Choose: ", 0, 14);
+        int op = readInt("Choose: ", 0, 15);
         if (op == 0) return;
 
         switch (op) {
@@ -199,8 +315,15 @@ static void adminMenu(ProductManager& pm, vector<User>& users, int& nextUserID)
                 Category cat = chooseCategory();
                 Section sec = chooseSection(cat);
                 double price = readDouble("Enter price: ", 0.0);
-                int newID = pm.addProduct(name, cat, sec, price);
-                cout << "addProduct result ID = " << newID << "\n";
+                ProductStatus status = pm.checkNewProduct(name, cat, sec);
+                int newID = -1;
+                if (status == ProductStatus::Success) {
+                    SizeStock stock;
+                    bool hasSize = readProductStock(stock);
+                    status = pm.addProduct(name, cat, sec, price, hasSize, stock, &newID);
+                }
+                if (status == ProductStatus::Success) cout << "Product added successfully with ID: " << newID << "\n";
+                else cout << "Add product failed: " << productStatusToString(status) << "\n";
                 pauseEnter();
                 break;
             }
@@ -301,6 +424,13 @@ static void adminMenu(ProductManager& pm, vector<User>& users, int& nextUserID)
                 }
                 break;
             }
+            case 15: {
+                if (saveCheckpoint(pm, users, nextUserID, productFile)) {
+                    cout << "Checkpoint written to " << Snapshot::defaultFileName() << "\n";
+                }
+                pauseEnter();
+                break;
+            }
             default:
                 break;
         }
@@ -336,7 +466,7 @@ static void showTransactionsMenu(User& u) {
 
 // -------------------- user menu actions --------------------
 static void userMenu(User& u, ProductManager& pm) {
-    u.loadCartFromFile();
+    u.loadCart();
 
     while (true) {
         cout << "\n===== USER MENU (" << u.username << ") =====\n";
@@ -356,7 +486,7 @@ static void userMenu(User& u, ProductManager& pm) {
         int op = readInt("Choose: ", 0, 11);
 
         if (op == 0) {
-            u.saveCartToFile();
+            u.saveCart();
             cout << "Logged out.\n";
             return;
         }
@@ -384,28 +514,53 @@ static void userMenu(User& u, ProductManager& pm) {
             }
             case 5: {
                 int id = readInt("Enter productID to add: ", 1, 1000000000);
-                u.addToCart(id, pm);
-                u.saveCartToFile();
+                Size size;
+                int quantity;
+                if (readCartLine(pm, id, size, quantity)) {
+                    CartStatus status = u.addToCart(id, size, quantity, pm);
+                    if (status == CartStatus::Success) {
+                        cout << "Add successfully to cart, Product ID: " << id
+                             << ", Name: " << pm.getProduct(id)->getProductName()
+                             << ", Size: " << sizeToString(size) << ", Quantity: " << quantity << "\n";
+                    } else {
+                        cout << "Add to cart failed: " << cartStatusToString(status) << "\n";
+                    }
+                }
+                u.saveCart();
                 pauseEnter();
                 break;
             }
             case 6: {
                 int id = readInt("Enter productID to update: ", 1, 1000000000);
-                u.updateCartItem(id, pm);
-                u.saveCartToFile();
+                Size size;
+                int quantity;
+                if (!u.getCart().getItems().contains(id)) {
+                    cout << "Item not found in cart.\n";
+                } else if (readCartLine(pm, id, size, quantity)) {
+                    CartStatus status = u.updateCartItem(id, size, quantity, pm);
+                    if (status == CartStatus::Success) {
+                        cout << "Update successfully in cart, Product ID: " << id
+                             << ", Name: " << pm.getProduct(id)->getProductName()
+                             << ", Size: " << sizeToString(size) << ", New Quantity: " << quantity << "\n";
+                    } else {
+                        cout << "Update failed: " << cartStatusToString(status) << "\n";
+                    }
+                }
+                u.saveCart();
                 pauseEnter();
                 break;
             }
             case 7: {
                 int id = readInt("Enter productID to remove from cart: ", 1, 1000000000);
-                u.removeFromCart(id);
-                u.saveCartToFile();
+                if (u.removeFromCart(id) == CartStatus::Success) cout << "Item removed from cart, product ID:" << id << "\n";
+                else cout << "No such item in cart, product ID:" << id << "\n";
+                u.saveCart();
                 pauseEnter();
                 break;
             }
             case 8: u.showCart(pm); pauseEnter(); break;
             case 9: {
-                bool ok = u.checkout(pm);
+                bool ok = u.checkout(pm, askOnShortage(pm));
                 if (ok) cout << "Checkout finished.\n";
                 pauseEnter();
                 break;
@@ -426,11 +581,24 @@ int main() {
     ProductManager pm;
     const string productFile = "products.txt";
 
-    pm.loadFromFile(productFile);
-
-    vector<User> users;
+    UserList users;
     int nextUserID = 1;
-    User::loadAll(users, nextUserID);
+
+    // Start from the binary snapshot while it matches the data files, else parse the text files
+    SnapshotSources sources;
+    sources.productFile = productFile;
+    SnapshotStatus snap = Snapshot::load(Snapshot::defaultFileName(), pm, users, nextUserID,
+                                         TransactionStore::instance(), &sources);
+    if (snap != SnapshotStatus::Success) {
+        if (snap != SnapshotStatus::NotFound) {
+            cout << "Snapshot not used (" << snapshotStatusToString(snap) << "), loading data files.\n";
+        }
+        pm.loadFromFile(productFile);
+        User::loadAll(users, nextUserID);
+    }
+    // carts used to be one cart_<userID>.txt per user; move any left over into carts.log
+    size_t migratedCarts = CartStore::instance().migrateLegacyFiles();
+    if (migratedCarts > 0) cout << "Moved " << migratedCarts << " saved cart(s) into " << CartStore::defaultFileName() << ".\n";
 
     while (true) {
         cout << "\n===== ONLINE SHOPPING SYSTEM =====\n";
@@ -489,8 +657,14 @@ int main() {
             pauseEnter();
         }
         else if (op == 5) {
-            User::saveAll(users, nextUserID);
-            pm.saveToFile(productFile);
+            // once checkpoints are in use, keep the snapshot current so the next start can use it
+            if (filesystem::exists(Snapshot::defaultFileName())) {
+                saveCheckpoint(pm, users, nextUserID, productFile);
+            } else {
+                User::saveAll(users, nextUserID);
+                pm.saveToFile(productFile);
+            }
+            CartStore::instance().flush();
             cout << "Saved. Bye!\n";
             break;
         }
@@ -0,0 +1,89 @@
+#include "OutputSink.h"
+#include <iostream>
+
+using namespace std;
+
+// ==================== OutputSink ====================
+
+OutputSink::OutputSink(size_t capacity) : buffer(capacity > 0 ? capacity : 1), failed(false), out(this) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+bool OutputSink::drain() {
+    size_t len = static_cast<size_t>(pptr() - pbase());
+    if (len > 0 && !failed && !deliver(pbase(), len)) failed = true;
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return !failed;
+}
+
+bool OutputSink::flush() {
+    if (!drain()) return false;
+    if (!flushDestination()) failed = true;
+    return !failed;
+}
+
+int OutputSink::overflow(int c) {
+    if (!drain()) return traits_type::eof();
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+}
+
+streamsize OutputSink::xsputn(const char* s, streamsize n) {
+    // Fits: copy into the buffer. Larger than the whole buffer: pass it straight through.
+    if (n <= epptr() - pptr()) {
+        traits_type::copy(pptr(), s, static_cast<size_t>(n));
+        pbump(static_cast<int>(n));
+        return n;
+    }
+    if (static_cast<size_t>(n) < buffer.size()) return streambuf::xsputn(s, n);
+    if (!drain()) return 0;
+    if (!deliver(s, static_cast<size_t>(n))) {
+        failed = true;
+        return 0;
+    }
+    return n;
+}
+
+int OutputSink::sync() {
+    return flush() ? 0 : -1;
+}
+
+// ==================== ConsoleSink ====================
+
+bool ConsoleSink::deliver(const char* data, size_t len) {
+    return cout.rdbuf()->sputn(data, static_cast<streamsize>(len)) == static_cast<streamsize>(len);
+}
+
+bool ConsoleSink::flushDestination() {
+    cout.flush();
+    return !cout.bad();
+}
+
+// ==================== StringSink ====================
+
+bool StringSink::deliver(const char* data, size_t len) {
+    target.append(data, len);
+    return true;
+}
+
+// ==================== FileSink ====================
+
+FileSink::FileSink(const string& filename, size_t capacity)
+    : OutputSink(capacity), file(fopen(filename.c_str(), "wb")) {
+    if (file) setvbuf(file, nullptr, _IONBF, 0);    // the sink buffer is the only one
+}
+
+FileSink::~FileSink() {
+    flush();
+    if (file) fclose(file);
+}
+
+bool FileSink::deliver(const char* data, size_t len) {
+    return file && fwrite(data, 1, len, file) == len;
+}
+
+bool FileSink::flushDestination() {
+    return file && fflush(file) == 0;
+}
@@ -0,0 +1,91 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <cstddef>
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// ==================== OutputSink ====================
+// Destination for rendered text (product listings, invoices, summaries). Renderers write to
+// stream() with '\n' line ends, never endl: the text collects in one large buffer and is handed
+// to the destination only when the buffer is full or at an explicit flush() (or stream().flush()).
+// Subclasses decide where it goes: the console, a string, a file; a network response would be
+// one more deliver() implementation.
+//
+// Subclass destructors must call flush(): deliver() is virtual and cannot run from ~OutputSink().
+class OutputSink : public streambuf {
+private:
+    vector<char> buffer;
+    bool failed;        // a deliver() failed; later output is dropped
+    ostream out;
+
+    bool drain();       // hand the buffered bytes to deliver() and empty the buffer
+
+protected:
+    // Take len bytes in order. false = the destination failed.
+    virtual bool deliver(const char* data, size_t len) = 0;
+    // Push delivered bytes on to their final destination (e.g. fflush); called by flush()
+    virtual bool flushDestination() { return true; }
+
+    int overflow(int c) override;
+    streamsize xsputn(const char* s, streamsize n) override;
+    int sync() override;
+
+public:
+    static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit OutputSink(size_t capacity = DEFAULT_CAPACITY);
+    ~OutputSink() override = default;
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    ostream& stream() { return out; }
+    bool flush();       // deliver everything written so far and flush the destination
+    bool good() const { return !failed; }
+};
+
+// Writes into cout's stream buffer, so output stays in order with other cout output and
+// follows cout when it is redirected. flush() flushes cout.
+class ConsoleSink : public OutputSink {
+protected:
+    bool deliver(const char* data, size_t len) override;
+    bool flushDestination() override;
+public:
+    explicit ConsoleSink(size_t capacity = DEFAULT_CAPACITY) : OutputSink(capacity) {}
+    ~ConsoleSink() override { flush(); }
+};
+
+// Collects the text in a string (its own, or the caller's target which is appended to)
+class StringSink : public OutputSink {
+private:
+    string own;
+    string& target;
+protected:
+    bool deliver(const char* data, size_t len) override;
+public:
+    explicit StringSink(size_t capacity = DEFAULT_CAPACITY) : OutputSink(capacity), target(own) {}
+    explicit StringSink(string& appendTo, size_t capacity = DEFAULT_CAPACITY)
+        : OutputSink(capacity), target(appendTo) {}
+    ~StringSink() override { flush(); }
+    const string& str() { flush(); return target; }
+};
+
+// Writes to a file (created or truncated); check isOpen() after constructing
+class FileSink : public OutputSink {
+private:
+    FILE* file;
+protected:
+    bool deliver(const char* data, size_t len) override;
+    bool flushDestination() override;
+public:
+    explicit FileSink(const string& filename, size_t capacity = DEFAULT_CAPACITY);
+    ~FileSink() override;
+    bool isOpen() const { return file != nullptr; }
+};
+
+#endif // OUTPUTSINK_H
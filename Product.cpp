@@ -3,60 +3,244 @@
 //
 
 #include "Product.h"
-#include <numeric>
+#include <mutex>
 using namespace std;
 
+// ==================== NameTable ====================
+// Names are kept in fixed-size blocks that are never reallocated, so a reference returned by
+// get() stays valid and readers do not race with intern(). An open-addressing hash finds
+// existing names; each 8-byte slot holds a 32-bit hash tag next to the ID, so probing and
+// rehashing never have to touch the strings except on a tag match.
+namespace {
+    const size_t NAME_BLOCK_BITS = 16;
+    const size_t NAME_BLOCK_SIZE = size_t(1) << NAME_BLOCK_BITS;
+    const size_t MAX_NAME_BLOCKS = 65536;   // up to 2^32 names
+
+    struct NameStorage {
+        string* blocks[MAX_NAME_BLOCKS] = {};
+        uint32_t count = 0;
+        vector<uint64_t> slots;     // hash slots: tag << 32 | (ID+1), 0 = empty
+        mutex lock;
+
+        NameStorage() {
+            // ID 0 is the empty name, so default-constructed products need no lookup
+            grow(1024);
+            blocks[0] = new string[NAME_BLOCK_SIZE];
+            uint32_t tag = hashOf(at(0));
+            slots[tag & (slots.size() - 1)] = (uint64_t(tag) << 32) | 1;
+            count = 1;
+        }
+
+        string& at(uint32_t id) { return blocks[id >> NAME_BLOCK_BITS][id & (NAME_BLOCK_SIZE - 1)]; }
+        static uint32_t hashOf(string_view s) {
+            size_t h = hash<string_view>()(s);
+            return static_cast<uint32_t>(h ^ (uint64_t(h) >> 32));
+        }
+        // keep the load factor <= 0.75 for n names
+        bool needsGrow(size_t n) const { return n * 4 > slots.size() * 3; }
+        void grow(size_t minSlots) {
+            size_t newSize = slots.empty() ? 1024 : slots.size();
+            while (newSize < minSlots) newSize *= 2;
+            if (newSize == slots.size()) return;
+            vector<uint64_t> bigger(newSize, 0);
+            size_t mask = newSize - 1;
+            for (uint64_t v : slots) {
+                if (v == 0) continue;
+                size_t i = (v >> 32) & mask;
+                while (bigger[i] != 0) i = (i + 1) & mask;
+                bigger[i] = v;
+            }
+            slots.swap(bigger);
+        }
+        // slot holding name, or the empty slot where it would go
+        size_t probe(string_view name, uint32_t tag) {
+            size_t mask = slots.size() - 1;
+            size_t i = tag & mask;
+            while (slots[i] != 0) {
+                if (static_cast<uint32_t>(slots[i] >> 32) == tag &&
+                    at(static_cast<uint32_t>(slots[i]) - 1) == name) {
+                    return i;
+                }
+                i = (i + 1) & mask;
+            }
+            return i;
+        }
+    };
+
+    NameStorage& nameStorage() {
+        static NameStorage* storage = new NameStorage();   // lives for the whole process
+        return *storage;
+    }
+}
+
+uint32_t NameTable::intern(string_view name) {
+    NameStorage& st = nameStorage();
+    uint32_t tag = NameStorage::hashOf(name);
+    lock_guard<mutex> guard(st.lock);
+    if (st.needsGrow(st.count + 1)) st.grow(st.slots.size() * 2);
+    size_t i = st.probe(name, tag);
+    if (st.slots[i] != 0) return static_cast<uint32_t>(st.slots[i]) - 1;
+    uint32_t id = st.count;
+    size_t block = id >> NAME_BLOCK_BITS;
+    if (st.blocks[block] == nullptr) st.blocks[block] = new string[NAME_BLOCK_SIZE];
+    st.at(id) = name;
+    st.slots[i] = (uint64_t(tag) << 32) | (id + 1);
+    ++st.count;
+    return id;
+}
+
+uint32_t NameTable::find(string_view name) {
+    NameStorage& st = nameStorage();
+    uint32_t tag = NameStorage::hashOf(name);
+    lock_guard<mutex> guard(st.lock);
+    size_t i = st.probe(name, tag);
+    return st.slots[i] != 0 ? static_cast<uint32_t>(st.slots[i]) - 1 : NOT_FOUND;
+}
+
+void NameTable::reserve(size_t count) {
+    NameStorage& st = nameStorage();
+    lock_guard<mutex> guard(st.lock);
+    size_t minSlots = 1024;
+    while (minSlots * 3 < count * 4) minSlots *= 2;
+    st.grow(minSlots);
+}
+
+const string& NameTable::get(uint32_t id) {
+    return nameStorage().at(id);
+}
+
+size_t NameTable::size() {
+    NameStorage& st = nameStorage();
+    lock_guard<mutex> guard(st.lock);
+    return st.count;
+}
+
+size_t NameTable::memoryUsage() {
+    NameStorage& st = nameStorage();
+    lock_guard<mutex> guard(st.lock);
+    size_t bytes = st.slots.capacity() * sizeof(uint64_t);
+    size_t blocks = (st.count + NAME_BLOCK_SIZE - 1) / NAME_BLOCK_SIZE;
+    bytes += blocks * NAME_BLOCK_SIZE * sizeof(string);
+    for (uint32_t id = 0; id < st.count; ++id) {
+        if (st.at(id).capacity() > 15) bytes += st.at(id).capacity() + 1;  // heap part beyond SSO
+    }
+    return bytes;
+}
+
+// ==================== Product ====================
+
 // Constructor:initialize Product with default values
 Product::Product() {
     productID=0;
-    productName="";
+    nameID=0;   // empty name
     category=Category::Men;
     section=Section::Eastern;
     price=0.0;
-    sizeStock.resize(6,0); // initialize stock for 6 sizes to 0
+    setSizeStock(SizeStock{}); // initialize stock for 6 sizes to 0
     hasSize = false;       // default: no size attributes
 }
 
 // Constructor with parameters: initialize Product with given values
-Product::Product(int id, string name, Category cat, Section sec, const vector<int> &stock, double prc) {
+Product::Product(int id, string_view name, Category cat, Section sec, const SizeStock &stock, double prc) {
     productID=id;
-    productName=name;
+    nameID=NameTable::intern(name);
     category=cat;
     section=sec;
-    sizeStock=stock;
+    setSizeStock(stock);
     price=prc;
-    if (sizeStock.size()<6) sizeStock.resize(6,0);
     // auto-detect hasSize from stock data: if any XS-XL has stock, treat as sized
     bool anySized = false;
     for (int i = 0; i < 5; ++i) {
-        if (sizeStock[i] != 0) { anySized = true; break; }
+        if (stock[i] != 0) { anySized = true; break; }
     }
-    int noneStock = sizeStock[static_cast<int>(Size::None)];
+    int noneStock = stock[static_cast<int>(Size::None)];
     hasSize = anySized || (noneStock == 0); // if only None used and non-zero, then size-less
 }
 
+// Copy constructor: atomics are not copyable, so copy their current values
+Product::Product(const Product& other) {
+    *this = other;
+}
+
+Product& Product::operator=(const Product& other) {
+    productID=other.productID;
+    nameID=other.nameID;
+    price=other.price;
+    setSizeStock(other.getSizeStock());
+    category=other.category;
+    section=other.section;
+    hasSize=other.hasSize;
+    return *this;
+}
+
+// Read all six counters (each one is exact; together they are a snapshot)
+SizeStock Product::getSizeStock() const {
+    SizeStock stock;
+    for (int i = 0; i < 6; ++i) stock[i] = sizeStock[i].load(memory_order_relaxed);
+    return stock;
+}
+
+StockVec Product::getStockVec() const {
+    return StockVec(sizeStock[0].load(memory_order_relaxed), sizeStock[1].load(memory_order_relaxed),
+                    sizeStock[2].load(memory_order_relaxed), sizeStock[3].load(memory_order_relaxed),
+                    sizeStock[4].load(memory_order_relaxed), sizeStock[5].load(memory_order_relaxed));
+}
+
+void Product::setSizeStock(const SizeStock& stock) {
+    for (int i = 0; i < 6; ++i) sizeStock[i].store(stock[i], memory_order_relaxed);
+}
+
 // Get total stock across all sizes.
 int Product::getTotalStock() const {
     if (!hasSize) {
         // size-less product: only use None slot
-        return sizeStock[static_cast<int>(Size::None)];
+        return getStock(Size::None);
     }
     // sized product: sum XS-XL and ignore None
-    return accumulate(sizeStock.begin(), sizeStock.begin() + 5, 0);
+    return StockVec(sizeStock[0].load(memory_order_relaxed), sizeStock[1].load(memory_order_relaxed),
+                    sizeStock[2].load(memory_order_relaxed), sizeStock[3].load(memory_order_relaxed),
+                    sizeStock[4].load(memory_order_relaxed), 0).sum();
 }
 
 // Update stock for a specific size by adding quantity (can be negative to reduce stock)
 bool Product::updateStock(Size size, int quantity) {
     int index = static_cast<int>(size); // convert Size enum to index
     // check if index is valid
-    if (index < 0 || index >= sizeStock.size()) {
+    if (index < 0 || index >= 6) {
         return false;
     }
-    sizeStock[index] += quantity;   // update stock
-    // ensure stock does not go negative
-    if (sizeStock[index] < 0) {
-        sizeStock[index] -= quantity; // revert change
-        return false;
+    // compare-and-swap loop: the new value is only published if nobody changed it meanwhile,
+    // so two threads can never both take the last unit
+    int current = sizeStock[index].load(memory_order_relaxed);
+    do {
+        // ensure stock does not go negative
+        if (current + quantity < 0) return false;
+    } while (!sizeStock[index].compare_exchange_weak(current, current + quantity,
+                                                     memory_order_acq_rel, memory_order_relaxed));
+    return true;
+}
+
+// Take stock for several sizes at once; if one size is short, sizes already taken are given back.
+bool Product::reserveStock(const SizeStock& qty) {
+    StockVec want(qty);
+    unsigned sizes = want.positiveMask();
+    // a size already short in a snapshot fails without touching any counter
+    if ((want.greaterThan(getStockVec()) & sizes) != 0) return false;
+    for (int i = 0; i < 6; ++i) {
+        if (!(sizes & (1u << i))) continue;
+        if (!updateStock(static_cast<Size>(i), -qty[i])) {
+            for (int j = 0; j < i; ++j) {
+                if (sizes & (1u << j)) sizeStock[j].fetch_add(qty[j], memory_order_acq_rel);
+            }
+            return false;
+        }
     }
     return true;
 }
+
+void Product::releaseStock(const SizeStock& qty) {
+    unsigned sizes = StockVec(qty).positiveMask();
+    for (int i = 0; i < 6; ++i) {
+        if (sizes & (1u << i)) sizeStock[i].fetch_add(qty[i], memory_order_acq_rel);
+    }
+}
@@ -4,23 +4,31 @@
 
 #ifndef ASSIGNMENT2_PRODUCT_H
 #define ASSIGNMENT2_PRODUCT_H
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include "StockVec.h"
 using namespace std;
 
 // Represents available clothing sizes. None is used for size-less products
-enum class Size{ XS, S, M, L, XL, None};
+enum class Size : uint8_t { XS, S, M, L, XL, None};
 
 // Product category
-enum class Category { Men, Women, Kids,Other };
+enum class Category : uint8_t { Men, Women, Kids,Other };
 
 /* Section (sub-category) inside each Category
    Men/Women: Eastern, Western, Other
    Kids: Boys, Girls, Other
    Other: only uses Other
 */
-enum class Section { Eastern,Western,Boys,Girls,Other };
+enum class Section : uint8_t { Eastern,Western,Boys,Girls,Other };
+
+// Stock (or quantity) per size index: 0..4 = XS-XL, 5 = None
+using SizeStock = array<int,6>;
 
 // Convert Size enum to string.
 static string sizeToString(Size size) {
@@ -67,38 +75,65 @@ static string sectionToString(Section sec) {
 // Convert integer index [0..4] to Section (caller should ensure range is valid)
 static Section intToSection(int index) { return static_cast<Section>(index);}
 
+// Process-wide table of interned product names.
+// A name is stored once and referred to by a 32-bit ID; interning the same text again returns
+// the same ID, so reloading a catalog does not grow the table. Strings never move once added,
+// so get() needs no locking; intern() is serialized internally.
+class NameTable {
+public:
+    static constexpr uint32_t NOT_FOUND = 0xFFFFFFFFu;
+    static uint32_t intern(string_view name);    // ID for name, adding it if new
+    static uint32_t find(string_view name);  // ID for name, or NOT_FOUND (never adds)
+    static void reserve(size_t count);  // make room for count names before a bulk load
+    static const string& get(uint32_t id);  // text of an interned name
+    static size_t size();   // number of distinct names
+    static size_t memoryUsage();    // approximate bytes held by the table
+};
+
 // Represents a single product with name, id, category, section, size-based stock and price.
+// Kept small and flat (48 bytes): the six stock counters are inline and the name lives in NameTable.
+// Stock counters are atomic, so concurrent checkouts can take stock without a catalog lock;
+// the other fields change only through ProductManager's (single-threaded) admin functions.
 class Product {
 private:
     int productID;          // unique identifier for the product
-    string productName;     // name of the product
-    Category category;      // product category (Men/Women/Kids/Other)
-    Section section;        // product section(sub-category) within the category
+    uint32_t nameID;        // name of the product (NameTable ID)
+    double price;           // unit price
     // Stock for each size index (0..4: XS-XL, 5: None).
     // For size-less(None) products, only None is used and others are 0
-    vector<int> sizeStock;
+    atomic<int> sizeStock[6];
+    Category category;      // product category (Men/Women/Kids/Other)
+    Section section;        // product section(sub-category) within the category
     bool hasSize;           // whether this product uses size XS-XL
-    double price;           // unit price
 public:
     Product(); // default constructor
-    Product(int id, string name, Category cat, Section sec, const vector<int>& stock, double prc); // Constructor with parameters
+    Product(int id, string_view name, Category cat, Section sec, const SizeStock& stock, double prc); // Constructor with parameters
+    Product(const Product& other);  // copies a snapshot of the stock counters
+    Product& operator=(const Product& other);
     // Getter fucntions
     int getProductID() const { return productID;}
-    string getProductName() const { return productName;}
+    const string& getProductName() const { return NameTable::get(nameID);}
+    uint32_t getNameID() const { return nameID;}
     Category getCategory() const {return category;}
     Section getSection() const { return section;}
-    const vector<int>& getSizeStock() const { return sizeStock;}
+    SizeStock getSizeStock() const; // snapshot of all six counters
+    StockVec getStockVec() const;   // the same snapshot as a StockVec
+    int getStock(Size size) const { return sizeStock[static_cast<int>(size)].load(memory_order_relaxed);}
     int getTotalStock() const ; // Get total available stock
     double getPrice() const { return price;}
     bool getHasSize() const { return hasSize; } // whether product has size attributes
     // Setter functions
-    void setName(const string& name) { productName=name;}
+    void setName(const string& name) { nameID=NameTable::intern(name);}
     void setPrice(double prc){ price=prc;}
     void setCategory(Category cat) { category=cat;}
     void setSection(Section sec) { section=sec;}
-    void setSizeStock(const vector<int>& stock) { sizeStock=stock;}
+    void setSizeStock(const SizeStock& stock);
+    void setStock(Size size, int stock) { sizeStock[static_cast<int>(size)].store(stock, memory_order_relaxed);}   // set one size in place
     void setHasSize(bool value) { hasSize = value; } // set size flag
     bool updateStock(Size size, int quantity); // Update stock for a specific size by quantity (can be negative)
+    // Take qty[i] units of every size at once, or nothing if any size is short. Thread-safe.
+    bool reserveStock(const SizeStock& qty);
+    void releaseStock(const SizeStock& qty);    // Give back stock taken by reserveStock()
 };
 
 
@@ -3,16 +3,40 @@
 //
 
 #include "ProductManager.h"
+#include "FileIO.h"
+#include "OutputSink.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <limits>
 using namespace std;
 
+// Loader limits and error reporting (fields are parsed in place with parseField, see FileIO.h)
+namespace {
+    const size_t RECORD_FIELDS = 11;    // id,name,catIdx,secIdx,price + 6 stock fields
+    const size_t MAX_REPORTED_LINES = 5; // malformed lines echoed before only counting them
+
+    // Echo the first few bad lines with their position, then only count them
+    void reportMalformed(const string &file, size_t lineNo, string_view line, size_t &count) {
+        if (++count <= MAX_REPORTED_LINES) {
+            cout << "Invalid product record at " << file << ":" << lineNo << ", skip line: " << line << endl;
+        }
+    }
+}
+
 // Initialize ProductManager with empty product containers.
 ProductManager::ProductManager() {
+    static atomic<uint32_t> managerCount{0};
+    catalogVersion=static_cast<uint64_t>(++managerCount)<<32;
     nextProductID=1;
-    products.resize(4); // 4 categories：Men, Women, Kids, Other
-    for (auto& category:products) {
+    persistedNextID=1;
+    journalRecords=0;
+    productCount=0;
+    products.resize(1); // slot 0 is never used, IDs start at 1
+    sectionIndex.resize(4); // 4 categories：Men, Women, Kids, Other
+    for (auto& category:sectionIndex) {
         category.resize(3); // 3 sections each: two specific + Other
     }
 }
@@ -45,136 +69,95 @@ int ProductManager::getSectionIndex(Category cat, Section sec) const {
 
 // Get productID by product name (or -1 if not found).
 int ProductManager::getProductID(const string &name) {
-    auto it=nameMap.find(name);
+    int id=findByName(name);
     // check if product exists
-    if (it==nameMap.end()) {
+    if (id==0) {
         cout<<"No product found with name: "<<name<<endl;
         return -1;  // In user class, method should check -1 for not found
     }
-    return it->second;  // return productID
+    return id;  // return productID
+}
+
+int ProductManager::findByName(const string &name) const {
+    uint32_t nameID=NameTable::find(name);
+    if (nameID==NameTable::NOT_FOUND || nameID>=productOfName.size()) return 0;
+    return productOfName[nameID];
+}
+
+void ProductManager::setNameOwner(uint32_t nameID, int productID) {
+    if (nameID>=productOfName.size()) productOfName.resize(nameID+1, 0);
+    productOfName[nameID]=productID;
 }
 
 // Add new product and interactively read size stock from user and return productID if added successfully
-int ProductManager::addProduct(const string &name, Category cat, Section sec, double price) {
-    auto it=nameMap.find(name);
-    // check if product with same name exists
-    if (it!=nameMap.end()) {
-        cout<<"Product with name "<<name<<" already exists with ID: "<<it->second<<endl;
-        return -1; // return -1 for failure, admin should call update() instead
-    }
+// check that a product with this name can be added to (cat, sec)
+ProductStatus ProductManager::checkNewProduct(const string &name, Category cat, Section sec) const {
+    if (name.empty() || name.find(',')!=string::npos) return ProductStatus::InvalidName;
+    // check if product with same name exists, admin should call update() instead
+    if (findByName(name)!=0) return ProductStatus::DuplicateName;
+    // check if category and section correspond (Other/anything is corrected to Other/Other by addProduct)
+    if ((cat == Category::Men || cat == Category::Women) &&
+        (sec == Section::Boys || sec == Section::Girls)) {
+        return ProductStatus::InvalidSection;
+    }
+    if (cat == Category::Kids && (sec == Section::Eastern || sec == Section::Western)) {
+        return ProductStatus::InvalidSection;
+    }
+    return ProductStatus::Success;
+}
 
-    // check if category and section are valid and correspond, return -1 for invalid input
-    if (cat == Category::Other && sec != Section::Other) {
-        cout << "Category 'Other' only supports section 'Other'. Auto-change section to Other." << endl;
-        sec = Section::Other;   // auto change to Other
-    } else if ((cat == Category::Men || cat == Category::Women) &&
-               (sec == Section::Boys || sec == Section::Girls)) {
-        cout << "Invalid section for Men/Women category." << endl;
-        return -1;
-    } else if (cat == Category::Kids &&
-               (sec == Section::Eastern || sec == Section::Western)) {
-        cout << "Invalid section for Kids category." << endl;
-        return -1;
-    }
-    vector<int> sizeStock(6,0); // initialize XS, S, M, L, XL, None to zero-stock
-    // User interaction: ask if size attributes exist
-    cout << "Does this product have size attributes? (1 for Yes, 0 for No): ";
-    int hasSizeFlag;
-    cin >> hasSizeFlag;
-    cin.ignore(numeric_limits<streamsize>::max(), '\n'); // clear newline from input buffer
-    bool hasSize = (hasSizeFlag == 1);
-    // Input size stock based on hasSize flag
+ProductStatus ProductManager::addProduct(const string &name, Category cat, Section sec, double price,
+                                         bool hasSize, const SizeStock &stock, int *newID) {
+    ProductStatus status=checkNewProduct(name,cat,sec);
+    if (status!=ProductStatus::Success) return status;
+    if (price<0) return ProductStatus::InvalidPrice;
+    if (cat == Category::Other) sec = Section::Other;   // Other only has section Other
+
+    SizeStock sizeStock{};  // initialize XS, S, M, L, XL, None to zero-stock
     if (hasSize) {
-        // sized product: read XS-XL stocks; None always 0
-        cout << "Enter stock for each size:\n";
-        cout << "XS: ";
-        cin >> sizeStock[0];
-        cout << "S: ";
-        cin >> sizeStock[1];
-        cout << "M: ";
-        cin >> sizeStock[2];
-        cout << "L: ";
-        cin >> sizeStock[3];
-        cout << "XL: ";
-        cin >> sizeStock[4];
-        sizeStock[5] = 0; // None not used for sized product
+        // sized product: XS-XL stocks; None always 0
+        for (int i = 0; i < 5; ++i) sizeStock[i] = stock[i];
     } else {
         // size-less product: only None slot is used
-        cout<<"Enter total stock for this product: ";
-        cin>>sizeStock[5]; // store in None
-        for (int i = 0; i < 5; ++i) sizeStock[i] = 0; // ensure sized slots are 0
+        sizeStock[5] = stock[5];
+    }
+    for (int q : sizeStock) {
+        if (q < 0) return ProductStatus::InvalidStock;
     }
-    cin.ignore(numeric_limits<streamsize>::max(), '\n'); // clear newline from input buffer
     int productID=nextProductID++;  // assign and increment next productID
     Product newProduct(productID,name,cat,sec,sizeStock,price); // create new Product
     newProduct.setHasSize(hasSize); // record whether this product has sizes
-    // Get category and section index
-    int catIndex=getCategoryIndex(cat);
-    int secIndex=getSectionIndex(cat,sec);
-    products[catIndex][secIndex][productID]=newProduct; // store new product in products
-    map[productID]=catIndex;    // record productID to category index in map
-    nameMap[name]=productID;  // record name to productID in nameMap
-    cout<<"Product added successfully with ID: "<<productID<<endl;
-    return productID;   // return new productID
+    storeProduct(newProduct);   // store in products table, section list and name index
+    markDirty(productID);   // persist on next save
+    if (newID) *newID=productID;
+    return ProductStatus::Success;
 }
 
 // Get non-const pointer to product by ID and return nullptr if not found
 Product* ProductManager::getProduct(int productID) {
-    auto it=map.find(productID);
     // check if product exists
-    if (it==map.end()) {
+    Product* p=findLive(productID);
+    if (!p) {
         cout<<"Product ID "<<productID<<" not found."<<endl;
         return nullptr;
     }
-    int catIndex=it->second;    // get category index from map
-    // traverse all sections in category to find the product
-    for (auto& secMap:products[catIndex]) {
-        auto prodIt=secMap.find(productID);
-        if (prodIt!=secMap.end()) {
-            return &(prodIt->second);
-        }
-    }
-    cout<<"Product ID "<<productID<<" not found in its category."<<endl;
-    return nullptr;
+    return p;
 }
 
 // Get const pointer to product by ID and return nullptr if not found(same as non-const version)
 const Product* ProductManager::getProduct(int productID) const {
-    auto it = map.find(productID);
-    if (it == map.end()) {
-        return nullptr;
-    }
-    int catIndex = it->second;
-    for (const auto& secMap : products[catIndex]) {
-        auto prodIt = secMap.find(productID);
-        if (prodIt != secMap.end()) {
-            return &(prodIt->second);
-        }
-    }
-    return nullptr;
+    return findLive(productID);
 }
 
 // Remove product by ID, return true if removed successfully
 bool ProductManager::removeProduct(int productID) {
     Product* prod=getProduct(productID);    // get non-const product pointer
-    if (prod!=nullptr) {
-        int catIndex=map[productID];    // get category index from map
-        string oldName = prod->getProductName();    // store old name for nameMap remove
-        // traverse all sections in category to find and erase the product
-        for (auto& secMap : products[catIndex]) {
-            // erase returns number of elements removed (0 or 1)
-            if (secMap.erase(productID) > 0) {
-                cout << "Product: " << oldName << " removed successfully." << endl;
-                map.erase(productID);   // remove from map
-                auto it = nameMap.find(oldName);
-                if (it != nameMap.end() && it->second == productID) {
-                    nameMap.erase(it);  // remove from nameMap
-                }
-                return true;
-            }
-        }
-    }
-    return false;   // return false if not found
+    if (prod==nullptr) return false;    // return false if not found
+    string oldName = prod->getProductName();    // store old name for output
+    eraseProduct(productID);    // clear slot, section list and name index entry
+    cout << "Product: " << oldName << " removed successfully." << endl;
+    markDirty(productID); // journal the removal on next save
+    return true;
 }
 
 // Update stock for a specific size of a product.
@@ -196,15 +179,14 @@ bool ProductManager::updateProduct(int productID, Size size, int newStock) {
         cout << "Update failed: Sized product does not use None stock." << endl;
         return false;
     }
-    vector<int> stock=prod->getSizeStock(); // use a vector to get old stock
     int idx = static_cast<int>(size);
     // check if size index is valid
-    if (idx < 0 || idx >= static_cast<int>(stock.size())) {
+    if (idx < 0 || idx >= static_cast<int>(prod->getSizeStock().size())) {
         cout << "Update failed: invalid size index." << endl;
         return false;
     }
-    stock[idx] = newStock;  // update stock in vector
-    prod->setSizeStock(stock);  // set updated stock back to product
+    prod->setStock(size, newStock);  // update the size slot in place
+    markDirty(productID);
     // output product name and new size info
     cout << "Update stock successfully for product ID: " << productID
          << " name: " << prod->getProductName()
@@ -222,6 +204,8 @@ bool ProductManager::updateProduct(int productID, double newPrice) {
         return false;
     }
     prod->setPrice(newPrice);   // call setter to set new price
+    ++catalogVersion;
+    markDirty(productID);
     cout<<"Update price successfully for product ID: "<<productID
         <<" name: "<<prod->getProductName()
         <<" new price: "<<newPrice<<endl;
@@ -232,20 +216,18 @@ bool ProductManager::updateProduct(int productID, double newPrice) {
 bool ProductManager::updateProduct(int productID, const string &newName) {
     Product* prod = getProduct(productID);
     if (!prod) return false;
-    auto it=nameMap.find(newName);
+    int existing=findByName(newName);
     // check if newname already exists
-    if (it!=nameMap.end()) {
-        cout<<"Update failed: Product name "<<newName<<" already exists with ID: "<<it->second<<endl;
+    if (existing!=0) {
+        cout<<"Update failed: Product name "<<newName<<" already exists with ID: "<<existing<<endl;
         return false;
     }
-    string oldName=prod->getProductName();  // store old name for nameMap update
+    uint32_t oldNameID=prod->getNameID();  // store old name for name index update
     prod->setName(newName); // call setter to set new name
-    // update nameMap: remove old name entry and add new name
-    auto oldIt=nameMap.find(oldName);
-    if (oldIt!=nameMap.end()&& oldIt->second==productID) {
-        nameMap.erase(oldIt);
-    }
-    nameMap[newName]=productID;
+    // update name index: remove old name entry and add new name
+    if (productOfName[oldNameID]==productID) productOfName[oldNameID]=0;
+    setNameOwner(prod->getNameID(), productID);
+    markDirty(productID);
     cout << "Update name successfully for product ID: " << productID
          << " new name: " << newName << endl;
     return true;
@@ -268,24 +250,18 @@ bool ProductManager::updateProduct(int productID, Category newCat, Section newSe
         cout << "Invalid section for Kids category." << endl;
         return false;
     }
-    Product oldCopy = *prod;    // make a copy of the old product to avoid dangling pointer
-    // get old category and section index
-    int oldCatIndex = map[productID];
-    int oldSecIndex = getSectionIndex(oldCopy.getCategory(), oldCopy.getSection());
-    // remove from old location
-    auto &oldSecMap = products[oldCatIndex][oldSecIndex];
-    auto it = oldSecMap.find(productID);
-    if (it != oldSecMap.end()) {
-        oldSecMap.erase(it);
-    }
-    // update category and section in the copy
-    oldCopy.setCategory(newCat);
-    oldCopy.setSection(newSec);
-    // get new category and section index and insert into new location
-    int newCatIndex = getCategoryIndex(newCat);
-    int newSecIndex = getSectionIndex(newCat, newSec);
-    products[newCatIndex][newSecIndex][productID] = oldCopy;
-    map[productID] = newCatIndex;
+    // move the ID from the old section list to the new one; the product itself stays in its slot
+    auto &oldList = sectionIndex[getCategoryIndex(prod->getCategory())]
+                                [getSectionIndex(prod->getCategory(), prod->getSection())];
+    auto it = lower_bound(oldList.begin(), oldList.end(), productID);
+    if (it != oldList.end() && *it == productID) {
+        oldList.erase(it);
+    }
+    prod->setCategory(newCat);
+    prod->setSection(newSec);
+    auto &newList = sectionIndex[getCategoryIndex(newCat)][getSectionIndex(newCat, newSec)];
+    newList.insert(lower_bound(newList.begin(), newList.end(), productID), productID);
+    markDirty(productID);
     // output new category and section info
     cout << "Update category and section successfully for product ID: " << productID
          << " new category: " << static_cast<int>(newCat)
@@ -293,127 +269,185 @@ bool ProductManager::updateProduct(int productID, Category newCat, Section newSe
     return true;
 }
 
+// productIDs of one section (the same list displayBySection prints)
+const vector<int>& ProductManager::getSectionProductIDs(Category cat, Section sec) const {
+    static const vector<int> none;
+    if (cat == Category::Other) sec = Section::Other;
+    if ((cat == Category::Men || cat == Category::Women) && (sec == Section::Boys || sec == Section::Girls)) return none;
+    if (cat == Category::Kids && (sec == Section::Eastern || sec == Section::Western)) return none;
+    return sectionIndex[getCategoryIndex(cat)][getSectionIndex(cat,sec)];
+}
+
+// Up to limit products with ID > afterID, in ID order (the table is indexed by ID; removed
+// slots are skipped). Sparse IDs are merged in by ID.
+vector<const Product*> ProductManager::getProductPage(int afterID, size_t limit) const {
+    vector<const Product*> page;
+    size_t id = static_cast<size_t>(max(afterID, 0)) + 1;
+    auto sparse = sparseProducts.upper_bound(afterID);
+    while (page.size() < limit) {
+        while (id < products.size() && products[id].getProductID() != static_cast<int>(id)) ++id;
+        bool dense = id < products.size();
+        if (sparse != sparseProducts.end() && (!dense || sparse->first < static_cast<int>(id))) {
+            page.push_back(&(sparse++)->second);
+        } else if (dense) {
+            page.push_back(&products[id++]);
+        } else {
+            break;
+        }
+    }
+    return page;
+}
+
+// The category's section lists are each sorted by ID: merge them from the cursor on
+vector<const Product*> ProductManager::getProductPage(Category cat, int afterID, size_t limit) const {
+    const auto& sections = sectionIndex[getCategoryIndex(cat)];
+    vector<vector<int>::const_iterator> next, end;
+    for (const auto& ids : sections) {
+        next.push_back(upper_bound(ids.begin(), ids.end(), afterID));
+        end.push_back(ids.end());
+    }
+    vector<const Product*> page;
+    while (page.size() < limit) {
+        size_t best = next.size();
+        for (size_t i = 0; i < next.size(); ++i) {
+            if (next[i] != end[i] && (best == next.size() || *next[i] < *next[best])) best = i;
+        }
+        if (best == next.size()) break;
+        page.push_back(findLive(*next[best]++));
+    }
+    return page;
+}
+
+vector<const Product*> ProductManager::getProductPage(Category cat, Section sec, int afterID, size_t limit) const {
+    const vector<int>& ids = getSectionProductIDs(cat, sec);
+    vector<const Product*> page;
+    for (auto it = upper_bound(ids.begin(), ids.end(), afterID); it != ids.end() && page.size() < limit; ++it) {
+        page.push_back(findLive(*it));
+    }
+    return page;
+}
+
 // Display a single product by ID.
-void ProductManager::displaySingleProduct(int productID) const {
+void ProductManager::displaySingleProduct(int productID, ostream &out) const {
     const Product* p=getProduct(productID); // get const product pointer
     // check if product exists
     if (p==nullptr) {
-        cout<<"Product ID "<<productID<<" not found."<<endl;
+        out<<"Product ID "<<productID<<" not found.\n";
         return;
     }
-    cout<<"Product Informations:"<<endl;
-    cout << "ID: " << p->getProductID()
+    out<<"Product Informations:\n";
+    out << "ID: " << p->getProductID()
         << ", Name: " << p->getProductName()
         << ", Category: " << categoryToString(p->getCategory())
         << ", Section: " << sectionToString(p->getSection())
         << ", Price: " << p->getPrice()
         << ", Total Stock: " << p->getTotalStock();
-    vector<int> stock = p->getSizeStock(); // get size stock
+    const SizeStock& stock = p->getSizeStock(); // get size stock
     // check if product has size attributes and display each size if so
     if (p->getHasSize()) {
-        cout << ", Stock for size "
-             << "XS: " << stock[0]
-             << ", S: " << stock[1]
-             << ", M: " << stock[2]
-             << ", L: " << stock[3]
-             << ", XL: " << stock[4];
-    }
-    cout << endl;
+        out << ", Stock for size "
+            << "XS: " << stock[0]
+            << ", S: " << stock[1]
+            << ", M: " << stock[2]
+            << ", L: " << stock[3]
+            << ", XL: " << stock[4];
+    }
+    out << '\n';
 }
 
 // Display all products in a specific (category, section).
-void ProductManager::displayBySection(Category cat, Section sec) const {
+void ProductManager::displayBySection(Category cat, Section sec, ostream &out) const {
     // check if category and section are valid and correspond(same as in addProduct())
     if (cat == Category::Other && sec != Section::Other) {
-        cout << "Category 'Other' only supports section 'Other'. Auto-change section to Other." << endl;
+        out << "Category 'Other' only supports section 'Other'. Auto-change section to Other.\n";
         sec=Section::Other;
     } else if ((cat == Category::Men || cat== Category::Women) &&
            (sec == Section::Boys || sec == Section::Girls)) {
-        cout << "Invalid section for Men/Women category." << endl;
+        out << "Invalid section for Men/Women category.\n";
         return;
     } else if (cat == Category::Kids &&
            (sec == Section::Eastern || sec == Section::Western)) {
-        cout << "Invalid section for Kids category." << endl;
+        out << "Invalid section for Kids category.\n";
     return;
     }
     // get category and section index
     int catIndex=getCategoryIndex(cat);
     int secIndex=getSectionIndex(cat,sec);
-    const auto& secMap=products[catIndex][secIndex];    // get section map
-    // check if section map is empty
-    if (secMap.empty()) {
-        cout<<"No products found in category: "
-            << categoryToString(cat)
-            << ", section: " << sectionToString(sec) << endl;
+    const auto& ids=sectionIndex[catIndex][secIndex];    // get productIDs of the section
+    // check if section is empty
+    if (ids.empty()) {
+        out<<"No products found in category: "
+           << categoryToString(cat)
+           << ", section: " << sectionToString(sec) << '\n';
         return;
     }
     // display all products in the section
-    cout<<"All products in category: "
-        << categoryToString(cat)
-        << ", section: " << sectionToString(sec) << endl;
-    for (const auto& pair : secMap) {
-        const Product& p = pair.second;
-        cout << "ID: " << p.getProductID()
-             << ", Name: " << p.getProductName()
-             << ", Price: " << p.getPrice()
-             << ", Total Stock: " << p.getTotalStock();
-        vector<int> stock=p.getSizeStock();
+    out<<"All products in category: "
+       << categoryToString(cat)
+       << ", section: " << sectionToString(sec) << '\n';
+    for (int id : ids) {
+        const Product& p = *findLive(id);
+        out << "ID: " << p.getProductID()
+            << ", Name: " << p.getProductName()
+            << ", Price: " << p.getPrice()
+            << ", Total Stock: " << p.getTotalStock();
+        const SizeStock& stock=p.getSizeStock();
         // check if product has size attributes and display each size if so
         if (p.getHasSize()) {
-            cout<<"Stock for size XS: "<<stock[0]
-                <<", S: "<<stock[1]
-                <<", M: "<<stock[2]
-                <<", L: "<<stock[3]
-                <<", XL: "<<stock[4];
+            out<<"Stock for size XS: "<<stock[0]
+               <<", S: "<<stock[1]
+               <<", M: "<<stock[2]
+               <<", L: "<<stock[3]
+               <<", XL: "<<stock[4];
         }
-        cout<<endl;
+        out<<'\n';
     }
 }
 
 // Display all products in a given category with all sections inside
-void ProductManager::displayByCategory(Category cat) const {
+void ProductManager::displayByCategory(Category cat, ostream &out) const {
     int catIndex=getCategoryIndex(cat);  // get category index
     bool found = false;
-    cout<<"Products in category: " << categoryToString(cat) << endl;
+    out<<"Products in category: " << categoryToString(cat) << '\n';
     // traverse all sections in the category
-    for (const auto& secMap:products[catIndex]) {
-        for (const auto& pair : secMap) {
-            const Product& p = pair.second;
-            cout << "ID: " << p.getProductID()
-                 << ", Name: " << p.getProductName()
-                 << ", Section: " << sectionToString(p.getSection())
-                 << ", Price: " << p.getPrice()
-                 << ", Total Stock: " << p.getTotalStock();
-            vector<int> stock=p.getSizeStock();
+    for (const auto& ids:sectionIndex[catIndex]) {
+        for (int id : ids) {
+            const Product& p = *findLive(id);
+            out << "ID: " << p.getProductID()
+                << ", Name: " << p.getProductName()
+                << ", Section: " << sectionToString(p.getSection())
+                << ", Price: " << p.getPrice()
+                << ", Total Stock: " << p.getTotalStock();
+            const SizeStock& stock=p.getSizeStock();
             // check if product has size attributes and display each size if so
             if (p.getHasSize()) {
-                cout<<", Stock for size XS: "<<stock[0]
-                    <<", S: "<<stock[1]
-                    <<", M: "<<stock[2]
-                    <<", L: "<<stock[3]
-                    <<", XL: "<<stock[4];
+                out<<", Stock for size XS: "<<stock[0]
+                   <<", S: "<<stock[1]
+                   <<", M: "<<stock[2]
+                   <<", L: "<<stock[3]
+                   <<", XL: "<<stock[4];
             }
-            cout<<endl;
+            out<<'\n';
             found = true;
         }
     }
     // output if no products found in the category
     if (!found) {
-        cout << "  (no products in this category)" << endl;
+        out << "  (no products in this category)\n";
     }
 }
 
 // Display all products
-void ProductManager::displayAllProducts() const {
+void ProductManager::displayAllProducts(ostream &out) const {
     bool found = false;
-    cout<<"All products in the system:"<<endl;
-    for (size_t catIdx = 0; catIdx < products.size(); ++catIdx) {
-        const auto& category = products[catIdx];
+    out<<"All products in the system:\n";
+    for (size_t catIdx = 0; catIdx < sectionIndex.size(); ++catIdx) {
+        const auto& category = sectionIndex[catIdx];
         Category cat = static_cast<Category>(catIdx);
         bool categoryPrinted = false;
         for (size_t secIdx = 0; secIdx < category.size(); ++secIdx) {
-            const auto& secMap = category[secIdx];
-            if (secMap.empty()) continue;
+            const auto& ids = category[secIdx];
+            if (ids.empty()) continue;
             Section sec;
             // determine logical Section based on category and section idx
             if (cat == Category::Kids) {
@@ -429,154 +463,357 @@ void ProductManager::displayAllProducts() const {
             }
             // print category header once
             if (!categoryPrinted) {
-                cout << "Category: " << categoryToString(cat) << endl;
+                out << "Category: " << categoryToString(cat) << '\n';
                 categoryPrinted = true;
             }
-            cout << "  Section: " << sectionToString(sec) << endl;
+            out << "  Section: " << sectionToString(sec) << '\n';
             // display all products in the section
-            for (const auto& pair : secMap) {
-                const Product& p = pair.second;
-                cout << "    ID: " << p.getProductID()
-                     << ", Name: " << p.getProductName()
-                     << ", Price: " << p.getPrice()
-                     << ", Total Stock: " << p.getTotalStock();
-                vector<int> stock=p.getSizeStock();
+            for (int id : ids) {
+                const Product& p = *findLive(id);
+                out << "    ID: " << p.getProductID()
+                    << ", Name: " << p.getProductName()
+                    << ", Price: " << p.getPrice()
+                    << ", Total Stock: " << p.getTotalStock();
+                const SizeStock& stock=p.getSizeStock();
                 if (p.getHasSize()) {
-                    cout<<", Stock for size XS: "<<stock[0]
-                        <<", S: "<<stock[1]
-                        <<", M: "<<stock[2]
-                        <<", L: "<<stock[3]
-                        <<", XL: "<<stock[4];
+                    out<<", Stock for size XS: "<<stock[0]
+                       <<", S: "<<stock[1]
+                       <<", M: "<<stock[2]
+                       <<", L: "<<stock[3]
+                       <<", XL: "<<stock[4];
                 }
-                cout<<endl;
+                out<<'\n';
                 found=true;
             }
         }
     }
     if (!found) {
-        cout << "No products available." << endl;
+        out << "No products available.\n";
     }
 }
 
-// Save all products to file: id,name,catIdx,secIdx,price,stock[6]
-bool ProductManager::saveToFile(const string &filename) const {
-    ofstream file(filename);
+// Console versions: render through one buffered sink, flushed once at the end
+void ProductManager::displaySingleProduct(int productID) const {
+    ConsoleSink sink;
+    displaySingleProduct(productID, sink.stream());
+}
+
+void ProductManager::displayBySection(Category cat, Section sec) const {
+    ConsoleSink sink;
+    displayBySection(cat, sec, sink.stream());
+}
+
+void ProductManager::displayByCategory(Category cat) const {
+    ConsoleSink sink;
+    displayByCategory(cat, sink.stream());
+}
+
+void ProductManager::displayAllProducts() const {
+    ConsoleSink sink;
+    displayAllProducts(sink.stream());
+}
+
+// Write one product record: id,name,catIdx,secIdx,price,stock[6]
+void ProductManager::writeRecord(ostream &out, const Product &p) const {
+    // get category and section index
+    Category cat = p.getCategory();
+    Section sec = p.getSection();
+    int catIdx = getCategoryIndex(cat);
+    int secIdx = getSectionIndex(cat, sec);
+    out << p.getProductID() << ","
+        << p.getProductName() << ","
+        << catIdx << ","
+        << secIdx << ","
+        << p.getPrice();
+    // write size stock
+    for (int stock : p.getSizeStock()) {
+        out << "," << stock;
+    }
+    out << '\n';
+}
+
+// Rewrite the whole base file (via a temp file) and drop the journal
+bool ProductManager::writeFullFile(const string &filename) {
+    string tmpName = filename + ".tmp";
+    ofstream file(tmpName);
     // check if file opened successfully
     if (!file.is_open()) {
         cout<<"Failed to open file for writing: "<<filename<<endl;
         return false;
     }
+    // changes made from here on (e.g. by a concurrent checkout) are journaled by the next save
+    {
+        lock_guard<mutex> guard(dirtyMutex);
+        dirtyIDs.clear();
+    }
     // write nextProductID first
-    file << nextProductID << endl;
-    // traverse to write each product record
-    for (const auto& category : products) {
-        for (const auto& secMap : category) {
-            for (const auto& pair : secMap) {
-                const Product& p = pair.second;
-                // get category and section index
-                Category cat = p.getCategory();
-                Section sec = p.getSection();
-                int catIdx = getCategoryIndex(cat);
-                int secIdx = getSectionIndex(cat, sec);
-                file << p.getProductID() << ","
-                     << p.getProductName() << ","
-                     << catIdx << ","
-                     << secIdx << ","
-                     << p.getPrice();
-                // write size stock
-                for (int stock : p.getSizeStock()) {
-                    file << "," << stock;
-                }
-                file << endl;
-            }
+    file << nextProductID << '\n';
+    // write each product record in ID order
+    for (const Product* p : getProductPage(0, productCount)) writeRecord(file, *p);
+    file.close();
+    if (!file) {
+        cout<<"Failed to write file: "<<filename<<endl;
+        return false;
+    }
+    // replace the base file, then discard the journal (replaying it over the new base is harmless)
+    remove(filename.c_str());
+    if (rename(tmpName.c_str(), filename.c_str()) != 0) {
+        cout<<"Failed to replace file: "<<filename<<endl;
+        return false;
+    }
+    remove((filename + ".journal").c_str());
+    persistedFile = filename;
+    persistedNextID = nextProductID;
+    journalRecords = 0;
+    return true;
+}
+
+// Save products to file.
+// If the file is the one this catalog was loaded from/saved to, only the changed products are
+// appended to "<file>.journal" (one record per product, "D,id" for removals, "N,next" for the
+// ID counter), so the cost is proportional to the change, not the catalog size.
+// The journal is folded into a fresh base file once it outgrows the catalog.
+bool ProductManager::saveToFile(const string &filename) {
+    if (filename != persistedFile) {
+        if (!writeFullFile(filename)) return false;
+        cout << "Products saved successfully to " << filename << endl;
+        return true;
+    }
+    unordered_set<int> changed;
+    {
+        lock_guard<mutex> guard(dirtyMutex);
+        changed.swap(dirtyIDs);
+    }
+    if (!changed.empty() || nextProductID != persistedNextID) {
+        ofstream journal(filename + ".journal", ios::app);
+        if (!journal.is_open()) {
+            cout<<"Failed to open file for writing: "<<filename<<".journal"<<endl;
+            for (int id : changed) markDirty(id);  // keep them for the next attempt
+            return false;
+        }
+        for (int id : changed) {
+            if (const Product* p = findLive(id)) writeRecord(journal, *p);
+            else journal << "D," << id << '\n';    // product was removed
+        }
+        if (nextProductID != persistedNextID) journal << "N," << nextProductID << '\n';
+        journal.close();
+        if (!journal) {
+            cout<<"Failed to write file: "<<filename<<".journal"<<endl;
+            for (int id : changed) markDirty(id);
+            return false;
+        }
+        journalRecords += changed.size() + (nextProductID != persistedNextID ? 1 : 0);
+        persistedNextID = nextProductID;
+        // compaction threshold grows with the catalog, so compaction stays amortized O(1) per change
+        if (journalRecords > 1024 && journalRecords > productCount) {
+            if (!writeFullFile(filename)) return false;
         }
     }
-    file.close();
     cout << "Products saved successfully to " << filename << endl;
     return true;
 }
 
-// Load all products from file
+void ProductManager::markDirty(int productID) {
+    lock_guard<mutex> guard(dirtyMutex);
+    dirtyIDs.insert(productID);
+}
+
+// Take stock for a checkout line. The counters themselves are atomic, so many checkouts can
+// reserve from the same catalog at once without a lock.
+bool ProductManager::reserveStock(int productID, const SizeStock &qty) {
+    Product* p = findLive(productID);
+    return p && p->reserveStock(qty);
+}
+
+void ProductManager::releaseStock(int productID, const SizeStock &qty) {
+    Product* p = findLive(productID);
+    if (p) p->releaseStock(qty);
+}
+
+// Fold the journal into a fresh base file
+bool ProductManager::compact(const string &filename) {
+    return writeFullFile(filename);
+}
+
+// Put a product into its table slot, its section list and the name index.
+// The table grows up to twice the catalog size (at least 1024 slots); an ID beyond that is kept
+// in sparseProducts instead, so a stray huge ID in a file cannot make the table enormous.
+void ProductManager::storeProduct(const Product &p) {
+    int id = p.getProductID();
+    size_t denseLimit = max<size_t>(1024, 2 * productCount);
+    if (static_cast<size_t>(id) < products.size()) {
+        products[id] = p;
+    } else if (static_cast<size_t>(id) < denseLimit) {
+        products.resize(id + 1);
+        products[id] = p;
+    } else {
+        sparseProducts.insert_or_assign(id, p);
+    }
+    auto &ids = sectionIndex[getCategoryIndex(p.getCategory())][getSectionIndex(p.getCategory(), p.getSection())];
+    // IDs normally arrive in increasing order, so this is an append
+    if (ids.empty() || ids.back() < id) ids.push_back(id);
+    else ids.insert(lower_bound(ids.begin(), ids.end(), id), id);
+    setNameOwner(p.getNameID(), id);
+    ++productCount;
+    ++catalogVersion;
+}
+
+// Remove a product from all containers without any output
+void ProductManager::eraseProduct(int productID) {
+    const Product* p = findLive(productID);
+    if (!p) return;
+    auto &ids = sectionIndex[getCategoryIndex(p->getCategory())][getSectionIndex(p->getCategory(), p->getSection())];
+    auto it = lower_bound(ids.begin(), ids.end(), productID);
+    if (it != ids.end() && *it == productID) ids.erase(it);
+    if (productOfName[p->getNameID()] == productID) productOfName[p->getNameID()] = 0;
+    if (static_cast<size_t>(productID) < products.size() && p == &products[productID]) {
+        products[productID] = Product();    // slot becomes empty
+    } else {
+        sparseProducts.erase(productID);
+    }
+    --productCount;
+    ++catalogVersion;
+}
+
+// Drop every product and all index entries
+void ProductManager::clearCatalog() {
+    products.clear();   // clear existing products
+    products.resize(1); // slot 0 unused
+    sparseProducts.clear();
+    productCount = 0;
+    ++catalogVersion;
+    // clear section lists of the 4 categories x 3 sections
+    for (auto& cat : sectionIndex) {
+        for (auto& ids : cat) ids.clear();
+    }
+    productOfName.clear();
+    {
+        lock_guard<mutex> guard(dirtyMutex);
+        dirtyIDs.clear();
+    }
+}
+
+void ProductManager::resetCatalog(int nextID, size_t expectedProducts, const string &persistedAs) {
+    clearCatalog();
+    nextProductID = max(nextID, 1);
+    // the table never grows past twice the catalog (see storeProduct), whatever nextID says
+    products.reserve(min(static_cast<size_t>(nextProductID), max<size_t>(1024, 2 * expectedProducts) + 1));
+    NameTable::reserve(NameTable::size() + expectedProducts);
+    productOfName.reserve(NameTable::size() + expectedProducts);
+    persistedFile = persistedAs;
+    persistedNextID = nextProductID;
+    journalRecords = 0;
+}
+
+// Store a product from a trusted source (snapshot); replaces any product with the same ID
+void ProductManager::restoreProduct(const Product &p) {
+    int id = p.getProductID();
+    if (id <= 0) return;
+    eraseProduct(id);
+    storeProduct(p);
+    if (id >= nextProductID) nextProductID = id + 1;
+}
+
+// Parse one record line and insert it, replacing any product with the same ID
+bool ProductManager::applyRecord(string_view line) {
+    // split by comma in place: id,name,catIdx,secIdx,price,XS,S,M,L,XL,None (extra fields ignored)
+    string_view tokens[RECORD_FIELDS + 1];
+    size_t count = splitFields(line, ',', tokens, RECORD_FIELDS + 1);
+    // check if the format is valid
+    if (count < RECORD_FIELDS) return false;
+    // record each data
+    int id, catIdx, secIdx;
+    double price;
+    if (!parseField(tokens[0], id) || !parseField(tokens[2], catIdx) || !parseField(tokens[3], secIdx) ||
+        !parseField(tokens[4], price)) {
+        return false;
+    }
+    // INT_MAX is refused: no ID could follow it
+    if (id <= 0 || id == numeric_limits<int>::max() || catIdx < 0 || catIdx >= 4) return false;
+    Category cat = static_cast<Category>(catIdx);
+    // determine Section based on category and secIdx
+    Section sec;
+    if (cat == Category::Kids) {
+        if (secIdx == 0) sec = Section::Boys;
+        else if (secIdx == 1) sec = Section::Girls;
+        else sec = Section::Other;
+    } else if (cat == Category::Other) {
+        // Other 分类统一视为 Other section
+        sec = Section::Other;
+    } else {
+        // Men / Women
+        if (secIdx == 0) sec = Section::Eastern;
+        else if (secIdx == 1) sec = Section::Western;
+        else sec = Section::Other;
+    }
+    // read size stock
+    SizeStock sizeStock{};
+    for (size_t i = 5; i < RECORD_FIELDS; ++i) {
+        if (!parseField(tokens[i], sizeStock[i - 5])) return false;
+    }
+    // create Product and insert into products (a journal record replaces the older version)
+    eraseProduct(id);
+    storeProduct(Product(id, tokens[1], cat, sec, sizeStock, price));
+    if (id >= nextProductID) nextProductID = id + 1;
+    return true;
+}
+
+// Load all products from file, then replay its journal (if any)
 bool ProductManager::loadFromFile(const string &filename) {
-    ifstream file(filename);
+    MappedFile file;    // whole file, parsed in place
     // check if file opened successfully
-    if (!file.is_open()) {
+    if (!file.open(filename)) {
         cout<<"Failed to open file for reading: "<<filename<<endl;
         return false;
     }
-    file>>nextProductID;    // read nextProductID first
-    file.ignore(numeric_limits<streamsize>::max(), '\n'); // clear newline
-    products.clear();   // clear existing products
-    products.resize(4); // 4 categories
-    // resize each category to 3 sections
-    for (auto& cat : products) {
-        cat.resize(3);
-    }
-    // clear two maps
-    map.clear();
-    nameMap.clear();
-    string line;
+    clearCatalog();
+    LineReader lines(file.view());
+    string_view line;
+    size_t malformed = 0;
+    // read nextProductID first
+    nextProductID = 1;
+    if (lines.next(line) && (!parseField(line, nextProductID) || nextProductID < 1)) {
+        reportMalformed(filename, lines.lineNumber(), line, malformed);
+        nextProductID = 1;
+    }
+    // size the tables once; IDs are below nextProductID and a record takes at least ~20 bytes
+    size_t expected = min(static_cast<size_t>(nextProductID), file.size() / 20 + 1);
+    products.reserve(expected + 1);
+    NameTable::reserve(NameTable::size() + expected);
+    productOfName.reserve(NameTable::size() + expected);
     // read each product record line by line
-    while (getline(file, line)) {
+    while (lines.next(line)) {
         if (line.empty()) continue;     // skip empty lines
-        size_t pos = 0;
-        vector<string> tokens;  // to hold split fields
-        string tmp = line;
-        // split by comma
-        while ((pos = tmp.find(',')) != string::npos) {
-            tokens.push_back(tmp.substr(0, pos));
-            tmp.erase(0, pos + 1);
-        }
-        tokens.push_back(tmp);
-        // check if the format is valid
-        if (tokens.size() < 11) {
-            cout << "Invalid product record (too few fields), skip line: " << line << endl;
-            continue;
-        }
-        // record each data
-        int id = stoi(tokens[0]);
-        string name = tokens[1];
-        int catIdx = stoi(tokens[2]);
-        int secIdx = stoi(tokens[3]);
-        double price = stod(tokens[4]);
-        if (catIdx < 0 || catIdx >= 4) {
-            cout << "Invalid category index in file, skip product ID: " << id << endl;
-            continue;
-        }
-        Category cat = static_cast<Category>(catIdx);
-        // determine Section based on category and secIdx
-        Section sec;
-        if (cat == Category::Kids) {
-            if (secIdx == 0) sec = Section::Boys;
-            else if (secIdx == 1) sec = Section::Girls;
-            else sec = Section::Other;
-        } else if (cat == Category::Other) {
-            // Other 分类统一视为 Other section
-            sec = Section::Other;
-        } else {
-            // Men / Women
-            if (secIdx == 0) sec = Section::Eastern;
-            else if (secIdx == 1) sec = Section::Western;
-            else sec = Section::Other;
-        }
-        // read size stock
-        vector<int> sizeStock;
-        for (size_t i = 5; i < 11 && i < tokens.size(); ++i) {
-            sizeStock.push_back(stoi(tokens[i]));
-        }
-        // ensure sizeStock has 6 elements
-        if (sizeStock.size() < 6) {
-            sizeStock.resize(6, 0);
-        }
-        // create Product and insert into products
-        Product p(id, name, cat, sec, sizeStock, price);
-        int realCatIdx = getCategoryIndex(cat);
-        int realSecIdx = getSectionIndex(cat, sec);
-        products[realCatIdx][realSecIdx][id] = p;
-        map[id] = realCatIdx;
-        nameMap[name]=id;
+        if (!applyRecord(line)) reportMalformed(filename, lines.lineNumber(), line, malformed);
     }
     file.close();
+    // replay changes saved after the base file was written
+    journalRecords = 0;
+    string journalName = filename + ".journal";
+    if (file.open(journalName)) {
+        LineReader journal(file.view());
+        while (journal.next(line)) {
+            if (line.empty()) continue;
+            ++journalRecords;
+            int value = 0;
+            bool ok;
+            if (line.substr(0, 2) == "D,") {
+                ok = parseField(line.substr(2), value);
+                if (ok) eraseProduct(value);
+            } else if (line.substr(0, 2) == "N,") {
+                ok = parseField(line.substr(2), value);
+                if (ok) nextProductID = max(nextProductID, value);
+            } else {
+                ok = applyRecord(line);
+            }
+            if (!ok) reportMalformed(journalName, journal.lineNumber(), line, malformed);
+        }
+    }
+    if (malformed > MAX_REPORTED_LINES) {
+        cout << malformed << " invalid product records skipped in " << filename << endl;
+    }
+    persistedFile = filename;
+    persistedNextID = nextProductID;
     cout << "Products loaded successfully from " << filename << endl;
     return true;
 }
@@ -6,29 +6,106 @@
 #define ASSIGNMENT2_PRODUCTMANAGER_H
 
 #include "Product.h"
-#include <unordered_map>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 using namespace std;
 
+// Outcome of ProductManager::addProduct
+enum class ProductStatus {
+    Success,
+    DuplicateName,      // another product already uses this name (update it instead)
+    InvalidName,        // empty name, or one containing a ',' (the file separator)
+    InvalidSection,     // section does not belong to the category
+    InvalidPrice,       // negative price
+    InvalidStock        // negative stock
+};
+
+static string productStatusToString(ProductStatus status) {
+    switch (status) {
+        case ProductStatus::Success: return "Success";
+        case ProductStatus::DuplicateName: return "A product with this name already exists";
+        case ProductStatus::InvalidName: return "Invalid product name";
+        case ProductStatus::InvalidSection: return "Invalid section for this category";
+        case ProductStatus::InvalidPrice: return "Price must not be negative";
+        case ProductStatus::InvalidStock: return "Stock must not be negative";
+    }
+    return "Unknown";
+}
+
 // Manages all products in the system
 class ProductManager {
 private:
     int nextProductID;  // next available product ID for new products
 
-    // products[categoryIndex][sectionIndex][productID] = Product
+    // products[productID] = Product. IDs are handed out sequentially, so the table is dense and
+    // a lookup by ID is one array access. Unused/removed slots hold a default Product (productID 0).
+    vector<Product> products;
+    // Products whose ID lies far past the dense table (only possible in edited files): growing
+    // the table up to such an ID would take gigabytes. Ordered by ID, for paging and saving.
+    map<int, Product> sparseProducts;
+    // sectionIndex[categoryIndex][sectionIndex] = productIDs in that section, sorted by ID
     // categoryIndex: 0..3 for Men/Women/Kids/Other
     // sectionIndex: 0..2 mapped by getSectionIndex for each category
-    vector<vector<unordered_map<int, Product>>> products;
-    unordered_map<int,int> map; // Maps productID to its category index.
-    unordered_map<string,int> nameMap;  // Maps unique product name to productID for name search and duplicate check
+    vector<vector<vector<int>>> sectionIndex;
+    size_t productCount;    // number of live products
+    // Maps unique product name to productID for name search and duplicate check.
+    // Names are already interned (NameTable), so this is indexed by name ID: productOfName[nameID]
+    // = productID, 0 if no product here uses that name. No second hash table, no key copies.
+    vector<int> productOfName;
+    // Incremental persistence: the product file is a base snapshot plus a journal
+    // ("<file>.journal") of changed records appended since the last full write.
+    unordered_set<int> dirtyIDs;    // productIDs changed (or removed) since the last save
+    mutex dirtyMutex;   // guards dirtyIDs; checkouts on several threads mark products dirty
+    string persistedFile;   // product file the base snapshot + journal belong to ("" if none)
+    int persistedNextID;    // nextProductID as recorded in base/journal
+    size_t journalRecords;  // records currently in the journal, used to trigger compaction
+    // Changes whenever a product is added, removed or repriced (prices cached elsewhere, e.g. cart
+    // totals, are stale then). The high 32 bits are unique per manager, so versions of two
+    // managers never match.
+    uint64_t catalogVersion;
     int getCategoryIndex(Category cat) const;   // Convert Category enum to container index
     int getSectionIndex(Category cat, Section sec) const;   // Convert (Category, Section) pair to the internal section index [0..2]
+    void writeRecord(ostream &out, const Product &p) const; // Write one product as a file record line
+    bool applyRecord(string_view line);   // Parse one product record line in place and insert/replace it (false if malformed)
+    // Live product with this ID (dense table, then the sparse IDs), nullptr if none
+    const Product* findLive(int productID) const {
+        if (productID > 0 && productID < static_cast<int>(products.size())
+            && products[productID].getProductID() == productID) {
+            return &products[productID];
+        }
+        if (sparseProducts.empty()) return nullptr;
+        auto it = sparseProducts.find(productID);
+        return it == sparseProducts.end() ? nullptr : &it->second;
+    }
+    Product* findLive(int productID) {
+        return const_cast<Product*>(static_cast<const ProductManager*>(this)->findLive(productID));
+    }
+    bool isLive(int productID) const { return findLive(productID) != nullptr; }
+    int findByName(const string &name) const;   // productID with this name, 0 if none
+    void setNameOwner(uint32_t nameID, int productID);  // productOfName[nameID] = productID (grows)
+    void storeProduct(const Product &p);    // Put a product into its slot (or the sparse map), section list and name index
+    void eraseProduct(int productID);   // Drop a product from all containers (no output)
+    bool writeFullFile(const string &filename); // Rewrite base file and discard the journal
+    void clearCatalog();    // Drop every product, section list, name entry and dirty mark
 public:
     ProductManager();   // Default constructor:Initialize empty manager with 4 categories and 3 sections per category
     int getProductID(const string &name);   // Get productID by product name, or -1 if not found
-    int addProduct(const string &name, Category cat, Section sec, double price);    // Add a new product with user-interaction for size stock input inside function
+    // Add a new product with the given stock, no console I/O. Sized products use XS-XL (None is
+    // set to 0), size-less ones only None. Category Other always gets section Other.
+    // On success *newID (if given) receives the new productID.
+    ProductStatus addProduct(const string &name, Category cat, Section sec, double price,
+                             bool hasSize, const SizeStock &stock, int *newID = nullptr);
+    ProductStatus checkNewProduct(const string &name, Category cat, Section sec) const;    // addProduct's name/section checks, nothing added
     Product* getProduct(int productID);
     const Product* getProduct(int productID) const;
+    size_t getProductCount() const { return productCount; }    // number of products in the catalog
+    uint64_t getCatalogVersion() const { return catalogVersion; }  // see catalogVersion; stock changes keep it
     bool removeProduct(int productID);  // Remove product by ID.
     // Function overload
     bool updateProduct(int productID, Size size, int newStock); // Update stock for a specific size of a product
@@ -36,14 +113,43 @@ public:
     bool updateProduct(int productID, const string &newName);   // Update name of a product
     bool updateProduct(int productID, Category newCat, Section newSec); // Update category and section of a product
 
-    // Display product information
+    // productIDs in a section, sorted by ID; empty if the category has no such section. No output.
+    const vector<int>& getSectionProductIDs(Category cat, Section sec) const;
+    // Pages in ID order: up to limit products with ID > afterID (0 = first page) in the whole
+    // catalog, one category or one section. Pass the last ID of a page to get the next one.
+    // O(log n + limit) (the catalog walk also steps over removed IDs). Pointers are valid until
+    // products are added or removed. No output.
+    vector<const Product*> getProductPage(int afterID, size_t limit) const;
+    vector<const Product*> getProductPage(Category cat, int afterID, size_t limit) const;
+    vector<const Product*> getProductPage(Category cat, Section sec, int afterID, size_t limit) const;
+
+    // Display product information on the console
     void displaySingleProduct(int productID) const;     // Display a single product
     void displayBySection(Category cat, Section sec) const;     // Display all products in a given section
     void displayByCategory(Category cat) const; // Display all products in a given category
     void displayAllProducts() const;     // Display all products
+    // Same listings written to out ('\n' line ends, no flushing; e.g. an OutputSink's stream)
+    void displaySingleProduct(int productID, ostream &out) const;
+    void displayBySection(Category cat, Section sec, ostream &out) const;
+    void displayByCategory(Category cat, ostream &out) const;
+    void displayAllProducts(ostream &out) const;
 
-    bool saveToFile(const string &filename) const;  // Save all products to file
-    bool loadFromFile(const string &filename);  // Load products from file
+    // Record that a product changed outside updateProduct() (e.g. stock deducted through Product*)
+    void markDirty(int productID);
+    // Take qty of a product's stock (every size or none) / give it back. Not marked dirty: the
+    // caller marks what it commits. Safe to call from several threads while no product is added
+    // or removed.
+    bool reserveStock(int productID, const SizeStock &qty);
+    void releaseStock(int productID, const SizeStock &qty);
+    bool saveToFile(const string &filename);    // Save changed products (journal) or all products to file
+    bool compact(const string &filename);   // Fold the journal into a fresh base file
+    bool loadFromFile(const string &filename);  // Load products (base file + journal) from file, mmap + in-place parsing
+    int getNextProductID() const { return nextProductID; }  // products have IDs below this
+    // Bulk replacement (snapshot loading): resetCatalog() drops every product, then restoreProduct()
+    // stores each record as is (ID kept, no checks, no output). persistedAs is the product file the
+    // restored catalog matches ("" if none, so the next save writes the whole file).
+    void resetCatalog(int nextID, size_t expectedProducts, const string &persistedAs);
+    void restoreProduct(const Product &p);
 };
 
 
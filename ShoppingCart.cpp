@@ -6,194 +6,155 @@
 
 #include <fstream>
 #include <iostream>
-#include <numeric>
-#include <limits>
 #include <algorithm>
+#include <cstring>
 using namespace std;
 
-// read size from user input and check if it is valid
-Size ShoppingCart::inputSize() {
-    // run infinite loop until valid input is received
-    while (true) {
-        cout<<"Please enter size (0: XS, 1: S, 2: M, 3: L, 4: XL): ";
-        int idx;
-        if (!(cin >> idx)) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');     // clear invalid input
-            cout << "Invalid input, should between 0-4." << endl;
-            continue;
-        }
-        // check if index is within valid range
-        if (idx < 0 || idx > 4) {
-            cout << "Invalid input, should between 0-4." << endl;
-            continue;
-        }
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');
-        return static_cast<Size>(idx);
-    }
+// -------------------- CartLines --------------------
+CartLines::CartLines(const CartLines &other) : count(0), capacity(INLINE_LINES) {
+    *this=other;
 }
 
-// read quantity from user input and check if it is valid
-int ShoppingCart::inputQuantity() {
-    // run infinite loop until valid input is received
-    while (true) {
-        cout<<"Please enter quantity: ";
-        int quantity;
-        if (!(cin >> quantity)) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');    // clear invalid input
-            cout << "Invalid input, should be a positive integer." << endl;
-            continue;
-        }
-        // check if quantity is positive
-        if (quantity <= 0) {
-            cout << "Quantity must be positive." << endl;
-            continue;
-        }
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');
-        return quantity;
-    }
+CartLines::CartLines(CartLines &&other) noexcept : count(0), capacity(INLINE_LINES) {
+    *this=std::move(other);
 }
 
-// check if the productID(product exists) and quantity are valid
-bool ShoppingCart::isValid(int productID, Size size,int quantity, const ProductManager &pm) {
-    // check if quantity is positive
-    if (quantity<=0) {
-        cout<<"Quantity must be positive."<<endl;
-        return false;
-    }
-    const Product* p=pm.getProduct(productID);  // get all products from ProductManager
-    // check if product exists
-    if (p==nullptr) {
-        cout<<"Product ID "<<productID<<" not found."<<endl;
-        return false;
+CartLines &CartLines::operator=(const CartLines &other) {
+    if (this==&other) return *this;
+    if (other.count>capacity) {
+        heap.reset(new CartLine[other.count]);
+        capacity=other.count;
     }
-    bool hasSize = p->getHasSize(); // check whether product has size attributes
-    int sizeIdx=static_cast<int>(size);
-    const vector<int>& stock=p->getSizeStock();     // get size stock vector
-    // check if size is valid based on hasSize flag
-    if (!hasSize) {
-        // size-less product: only None slot is valid
-        int noneStock = stock[static_cast<int>(Size::None)];    // get None stock
-        if (size != Size::None) {
-            cout << "Invalid size: this product has no size, only None is allowed." << endl;
-            return false;
-        }
-        if (quantity>noneStock) {
-            cout<<"Insufficient stock. Available: "<<noneStock<<endl;
-            return false;
-        }
-        return true;
-    }
-    // sized product: use XS-XL only, None not allowed
-    if (size == Size::None) {
-        cout << "Invalid size: this product uses sizes XS-XL, not None." << endl;
-        return false;
-    }
-    if (sizeIdx<0||sizeIdx>=static_cast<int>(stock.size())-1) {
-        cout<<"Invalid size."<<endl;
-        return false;
+    memcpy(data(),other.data(),other.count*sizeof(CartLine));
+    count=other.count;
+    return *this;
+}
+
+CartLines &CartLines::operator=(CartLines &&other) noexcept {
+    if (this==&other) return *this;
+    if (other.heap) {
+        // take the heap array over
+        heap=std::move(other.heap);
+        capacity=other.capacity;
+    } else {
+        heap.reset();
+        capacity=INLINE_LINES;
+        memcpy(inlineLines,other.inlineLines,other.count*sizeof(CartLine));
     }
-    if (quantity>stock[sizeIdx]) {
-        cout<<"Insufficient stock for size "<<sizeToString(size)<<". Available: "<<stock[sizeIdx]<<endl;
-        return false;
+    count=other.count;
+    other.count=0;
+    other.capacity=INLINE_LINES;
+    return *this;
+}
+
+// index of the first line with productID >= the given one
+size_t CartLines::lowerBound(int productID) const {
+    const CartLine* lines=data();
+    return lower_bound(lines,lines+count,productID,
+                       [](const CartLine& line,int id){ return line.productID<id; })-lines;
+}
+
+const CartLine *CartLines::find(int productID) const {
+    size_t i=lowerBound(productID);
+    return (i<count&&data()[i].productID==productID) ? data()+i : nullptr;
+}
+
+CartLine &CartLines::insert(int productID) {
+    size_t i=lowerBound(productID);
+    if (i<count&&data()[i].productID==productID) return data()[i];
+    if (count==capacity) {
+        // grow: leave the inline lines for a typical cart's worth, or double the heap array
+        size_t grown=heap ? capacity*2 : FIRST_HEAP_LINES;
+        unique_ptr<CartLine[]> bigger(new CartLine[grown]);
+        memcpy(bigger.get(),data(),count*sizeof(CartLine));
+        heap=std::move(bigger);
+        capacity=grown;
     }
+    CartLine* lines=data();
+    memmove(lines+i+1,lines+i,(count-i)*sizeof(CartLine));
+    lines[i].productID=productID;
+    lines[i].qty.fill(0);
+    ++count;
+    return lines[i];
+}
+
+bool CartLines::erase(int productID) {
+    size_t i=lowerBound(productID);
+    CartLine* lines=data();
+    if (i>=count||lines[i].productID!=productID) return false;
+    memmove(lines+i,lines+i+1,(count-i-1)*sizeof(CartLine));
+    --count;
     return true;
 }
 
-// add item to cart
-void ShoppingCart::addItem(int productID, const ProductManager &pm) {
-    const Product* p=pm.getProduct(productID);
+// check if the productID(product exists), size and quantity are valid
+CartStatus ShoppingCart::validate(int productID, Size size,int quantity, const ProductManager &pm) {
+    // check if quantity is positive
+    if (quantity<=0) return CartStatus::InvalidQuantity;
+    const Product* p=pm.getProduct(productID);  // get product from ProductManager
     // check if product exists
-    if (p==nullptr) {
-        cout<<"Product ID "<<productID<<" not found."<<endl;
-        return;
-    }
-    const vector<int>& stock=p->getSizeStock();
+    if (p==nullptr) return CartStatus::ProductNotFound;
     // check if product is out of stock
-    if (p->getTotalStock()==0) {
-        cout<<"Product ID "<<productID<<"Product name:"<<p->getProductName()<<" is out of stock."<<endl;
-        return;
-    }
-    Size size;
-    int quantity=inputQuantity();   // input quantity from user
-    // determine size based on whether product has size attributes
-    if (p->getHasSize()) {
-        size=inputSize();
-    }else {
-        size=Size::None;
-    }
-    if (!isValid(productID,size,quantity,pm)) return;   // check if the product id, size and quantity are valid
-    auto& vec=items[productID];
-    if (vec.size()<6) vec.resize(6,0); // ensure vector has 6 elements
-    vec[static_cast<int>(size)]+=quantity;  // add quantity to the specified size
-    // output new item info in cart
-    cout<<"Add successfully to cart, Product ID: "<<productID
-        <<", Name: "<<p->getProductName()
-        <<", Size: "<<sizeToString(size)
-        <<", Quantity: "<<quantity<<endl;
+    if (p->getTotalStock()==0) return CartStatus::OutOfStock;
+    int sizeIdx=static_cast<int>(size);
+    if (sizeIdx<0||sizeIdx>=6) return CartStatus::InvalidSize;
+    // size-less product: only None slot is valid; sized product: use XS-XL only, None not allowed
+    if (p->getHasSize() == (size == Size::None)) return CartStatus::InvalidSize;
+    if (quantity>p->getStock(size)) return CartStatus::InsufficientStock;
+    return CartStatus::Success;
 }
 
+// -------------------- ShoppingCart --------------------
+// add quantity of one size to the cart
+CartStatus ShoppingCart::addItem(int productID, Size size, int quantity, const ProductManager &pm) {
+    CartStatus status=validate(productID,size,quantity,pm);    // check if the product id, size and quantity are valid
+    if (status!=CartStatus::Success) return status;
+    items.insert(productID).qty[static_cast<int>(size)]+=quantity;  // add quantity to the specified size
+    if (totalCurrent(pm)) cachedTotal+=pm.getProduct(productID)->getPrice()*quantity;
+    return CartStatus::Success;
+}
 
-// update item quantity in cart
-void ShoppingCart::updateItem(int productID, const ProductManager &pm) {
-    auto it=items.find(productID);
+// set the quantity of one size of a product already in the cart
+CartStatus ShoppingCart::updateItem(int productID, Size size, int quantity, const ProductManager &pm) {
     // check if item exists in cart
-    if (it==items.end()) {
-        cout<<"Item not found in cart."<<endl;
-        return;
-    }
-    const Product* p=pm.getProduct(productID);
-    // check if product exists
-   if (p==nullptr) {
-       cout<<"Product ID "<<productID<<" not found."<<endl;
-       return;
-   }
-   const vector<int>& stock=p->getSizeStock();
-    // check if product is out of stock
-    if (p->getTotalStock()==0) {
-        cout<<"Product ID "<<productID<<"Product name:"<<p->getProductName()<<" is out of stock."<<endl;
-        return;
-    }
-    Size size;
-    int quantity=inputQuantity();   // input new quantity from user
-    // determine size based on whether product has size attributes
-    if (p->getHasSize()) {
-        size=inputSize();
-    }else {
-        size=Size::None;
-    }
-    // check if the product id, size and quantity are valid
-    if (!isValid(productID,size,quantity,pm)) return;
-    items[productID][static_cast<int>(size)]=quantity;  // update new quantity in cart
-    // output info
-    cout<<"Update successfully in cart, Product ID: "<<productID
-        <<", Name: "<<p->getProductName()
-        <<", Size: "<<sizeToString(size)
-        <<", New Quantity: "<<quantity<<endl;
+    CartLine* line=items.find(productID);
+    if (line==nullptr) return CartStatus::NotInCart;
+    CartStatus status=validate(productID,size,quantity,pm);
+    if (status!=CartStatus::Success) return status;
+    int& slot=line->qty[static_cast<int>(size)];
+    if (totalCurrent(pm)) cachedTotal+=pm.getProduct(productID)->getPrice()*(quantity-slot);
+    slot=quantity;  // update new quantity in cart
+    return CartStatus::Success;
 }
 
-
 // remove item from cart if it exists
-void ShoppingCart::removeItem(int productID) {
-    auto it=items.find(productID);
-    // check if item exists in cart
-    if (it==items.end()) {
-        cout<<"No such item in cart, product ID:"<<productID<<endl;
-        return;
-    }
+CartStatus ShoppingCart::removeItem(int productID) {
     // erase all sizes for the product
-    items.erase(it);
-    cout<<"Item removed from cart, product ID:"<<productID<<endl;
+    if (!items.erase(productID)) return CartStatus::NotInCart;
+    dropTotal();
+    return CartStatus::Success;
+}
+
+// set a line directly; a product whose sizes are all 0 leaves the cart
+void ShoppingCart::setQuantity(int productID, Size size, int quantity) {
+    dropTotal();
+    CartLine* line=items.find(productID);
+    if (line==nullptr) {
+        if (quantity<=0) return;
+        line=&items.insert(productID);
+    }
+    line->qty[static_cast<int>(size)]=max(quantity,0);
+    if (StockVec(line->qty).positiveMask()==0) items.erase(productID);
 }
 
 // calculate total price of items in cart
 double ShoppingCart::calculateTotal(const ProductManager &pm) const {
+    if (totalCurrent(pm)) return cachedTotal;
     double total=0.0;
-    for (const auto& pair:items) {
-        // get productID and stock vector
-        int productID=pair.first;
-        const vector<int>& stock=pair.second;
+    for (const CartLine& line:items) {
+        // get productID and quantities
+        int productID=line.productID;
+        const SizeStock& stock=line.qty;
         const Product* p=pm.getProduct(productID);
         // check if product exists
         if (p==nullptr) {
@@ -201,9 +162,13 @@ double ShoppingCart::calculateTotal(const ProductManager &pm) const {
             continue;
         }
         double price=p->getPrice(); // get unit price
-        int quantity=accumulate(stock.begin(),stock.end(),0); // sum up quantities(stock vector) across all sizes
+        int quantity=StockVec(stock).sum(); // sum up quantities across all sizes
         total+=price*quantity;  // update total price
     }
+    // remember it until the cart or the catalog changes
+    pricedBy=&pm;
+    pricedVersion=pm.getCatalogVersion();
+    cachedTotal=total;
     return total;
 }
 
@@ -216,9 +181,9 @@ void ShoppingCart::displayCart(const ProductManager &pm) const {
     }
     // traverse to display each item
     cout<<"Items in your shopping cart:"<<endl;
-    for (const auto& pair:items) {
-        int productID=pair.first;
-        const vector<int>& stock=pair.second;
+    for (const CartLine& line:items) {
+        int productID=line.productID;
+        const SizeStock& stock=line.qty;
         const Product* p=pm.getProduct(productID);
         // check if product exists
         if (p==nullptr) {
@@ -244,6 +209,7 @@ void ShoppingCart::displayCart(const ProductManager &pm) const {
 // clear all items in cart
 void ShoppingCart::clearCart() {
     items.clear();
+    cachedTotal=0.0;    // an empty cart costs 0 at any prices
 }
 
 // save cart items to file
@@ -256,15 +222,10 @@ bool ShoppingCart::saveToFile(const string &filename) const {
     }
     // format: productID q0 q1 q2 q3 q4 q5
     file<<items.size()<<endl; // first line is the number of items
-    for (const auto& pair : items) {
-        int productID = pair.first;
-        const vector<int>& vec = pair.second;
-        file << productID;
+    for (const CartLine& line : items) {
+        file << line.productID;
         // write quantities for all 6 sizes
-        for (int i = 0; i < 6; ++i) {
-            int q = (i < static_cast<int>(vec.size())) ? vec[i] : 0;
-            file << ' ' << q;
-        }
+        for (int q : line.qty) file << ' ' << q;
         file << endl;
     }
     file.close();
@@ -280,6 +241,7 @@ bool ShoppingCart::loadFromFile(const string &filename) {
         return false;
     }
     clearCart();    // clear existing items
+    dropTotal();
     size_t count;
     file>>count;
     for (size_t i = 0; i < count; ++i) {
@@ -288,15 +250,15 @@ bool ShoppingCart::loadFromFile(const string &filename) {
             cout << "read productID failed" << endl;
             return false;
         }
-        vector<int> vec(6, 0);
+        SizeStock qty{};
         // read quantities for all 6 sizes
         for (int j = 0; j < 6; ++j) {
-            if (!(file >> vec[j])) {
+            if (!(file >> qty[j])) {
                 cout << "read quantity failed" << endl;
                 return false;
             }
         }
-        items[productID] = vec; // store in items map
+        items.insert(productID).qty = qty; // store the line
     }
     return true;
 }
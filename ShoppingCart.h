@@ -5,28 +5,108 @@
 #ifndef ASSIGNMENT2_SHOPPINGCART_H
 #define ASSIGNMENT2_SHOPPINGCART_H
 #include "ProductManager.h"
-#include <unordered_map>
-#include <vector>
+#include <cstddef>
+#include <memory>
 #include <string>
 using namespace std;
 
+// Outcome of a cart operation
+enum class CartStatus {
+    Success,
+    ProductNotFound,    // no such product in the catalog
+    OutOfStock,         // product has no stock left at all
+    InvalidQuantity,    // quantity must be positive
+    InvalidSize,        // sized products take XS-XL, size-less ones only None
+    InsufficientStock,  // more than the available stock for that size
+    NotInCart           // update/remove of a product that is not in the cart
+};
+
+static string cartStatusToString(CartStatus status) {
+    switch (status) {
+        case CartStatus::Success: return "Success";
+        case CartStatus::ProductNotFound: return "Product not found";
+        case CartStatus::OutOfStock: return "Product is out of stock";
+        case CartStatus::InvalidQuantity: return "Quantity must be positive";
+        case CartStatus::InvalidSize: return "Invalid size for this product";
+        case CartStatus::InsufficientStock: return "Insufficient stock for this size";
+        case CartStatus::NotInCart: return "Item not found in cart";
+    }
+    return "Unknown";
+}
+
+// One cart line: a product and its quantity per size (indexed by Size)
+struct CartLine {
+    int productID;
+    SizeStock qty;
+};
+
+// Cart lines sorted by productID in one flat array. The first INLINE_LINES lines live inside
+// the object, so carts of that size never allocate. The inline part is kept small on purpose:
+// each inline line adds 28 bytes to every cart, full or empty (20 inline lines would make a
+// ShoppingCart 608 bytes instead of 160). A larger cart moves once to a heap array of
+// FIRST_HEAP_LINES, enough for a typical cart (fewer than 20 lines): it allocates once, and its
+// operations are allocation-free after that. Past that the array doubles. Iteration is in
+// productID order.
+class CartLines {
+private:
+    static const size_t INLINE_LINES = 4;
+    static const size_t FIRST_HEAP_LINES = 20;
+
+    CartLine inlineLines[INLINE_LINES];
+    unique_ptr<CartLine[]> heap;    // null while the lines fit inline
+    size_t count;
+    size_t capacity;
+
+    CartLine* data() { return heap ? heap.get() : inlineLines; }
+    const CartLine* data() const { return heap ? heap.get() : inlineLines; }
+    size_t lowerBound(int productID) const;
+
+public:
+    CartLines() : count(0), capacity(INLINE_LINES) {}
+    CartLines(const CartLines& other);
+    CartLines(CartLines&& other) noexcept;
+    CartLines& operator=(const CartLines& other);
+    CartLines& operator=(CartLines&& other) noexcept;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const CartLine* begin() const { return data(); }
+    const CartLine* end() const { return data() + count; }
+    const CartLine* find(int productID) const;     // nullptr if not in the cart
+    CartLine* find(int productID) { return const_cast<CartLine*>(static_cast<const CartLines&>(*this).find(productID)); }
+    bool contains(int productID) const { return find(productID) != nullptr; }
+
+    CartLine& insert(int productID);    // the product's line, added with all quantities 0 if missing
+    bool erase(int productID);          // false if not in the cart
+    void clear() { count = 0; }         // keeps a heap array for reuse
+};
+
 // user's shopping cart: stores selected products and quantities per size.
 class ShoppingCart {
 private:
-    unordered_map<int,vector<int> > items; // items[productID][sizeIndex], quantity per size
-    static Size inputSize(); // read size from user input
-    static int inputQuantity(); // read quantity from user input
-    bool isValid(int productID, Size size, int quantity, const ProductManager &pm); // check if parameters are valid
+    CartLines items; // one line per product, quantity per size
+    // Cached total price: valid while pricedBy is the manager asked last and its catalog version
+    // is still pricedVersion. addItem/updateItem keep it current, clearCart sets it to 0;
+    // edits without a ProductManager (remove, setQuantity, load) drop it.
+    mutable const ProductManager* pricedBy;
+    mutable uint64_t pricedVersion;
+    mutable double cachedTotal;
+    static CartStatus validate(int productID, Size size, int quantity, const ProductManager &pm); // check if parameters are valid
+    bool totalCurrent(const ProductManager &pm) const { return pricedBy==&pm && pricedVersion==pm.getCatalogVersion(); }
+    void dropTotal() { pricedBy=nullptr; }
 
 public:
-    void addItem(int productID, const ProductManager& pm);  // Add an item to the cart
-    void updateItem(int productID, const ProductManager& pm);   // update item quantity in cart
-    void removeItem(int productID);     // remove item from cart
-    double calculateTotal(const ProductManager& pm) const;      // calculate total price of items in cart
+    ShoppingCart() : pricedBy(nullptr), pricedVersion(0), cachedTotal(0.0) {}
+    // Cart operations, no console I/O
+    CartStatus addItem(int productID, Size size, int quantity, const ProductManager& pm);  // add quantity of one size
+    CartStatus updateItem(int productID, Size size, int quantity, const ProductManager& pm);   // set quantity of one size (product must be in the cart)
+    CartStatus removeItem(int productID);     // remove item (all sizes) from cart
+    void setQuantity(int productID, Size size, int quantity);  // set a line without stock checks, 0 drops it (used by shortage handling)
+    double calculateTotal(const ProductManager& pm) const;      // calculate total price of items in cart (O(1) while cached)
     void displayCart(const ProductManager& pm) const;   // display all items in cart
     void clearCart();   // remove all items from the cart
-    // Expose internal items map (read-only) for other components (e.g. transaction).
-    const unordered_map<int,vector<int>>& getItems() const { return items; }
+    // Expose internal items (read-only, in productID order) for other components (e.g. transaction).
+    const CartLines& getItems() const { return items; }
     bool saveToFile(const string &filename) const;  // save cart to file
     bool loadFromFile(const string &filename);  // load cart from file
     static string getShoppingCartFileName(int userID) {return "cart_" + to_string(userID) + ".txt"; }   // Generate cart filename based on userID
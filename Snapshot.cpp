@@ -0,0 +1,443 @@
+#include "Snapshot.h"
+#include "FileIO.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace std;
+
+// ==================== File layout ====================
+
+namespace {
+    const char MAGIC[8] = {'S', 'H', 'O', 'P', 'S', 'N', 'A', 'P'};
+    const uint32_t BYTE_ORDER_MARK = 0x01020304u;   // reads differently on a host of the other byte order
+    const size_t SECTION_ALIGN = 64;
+
+    enum Section_ { StringsSection, ProductsSection, UsersSection, TransactionsSection, ItemsSection,
+                    AmountOrderSection, SECTION_COUNT };
+    enum Stamp_ { ProductFileStamp, ProductJournalStamp, UsersFileStamp, TransactionFileStamp, STAMP_COUNT };
+
+    // bytes at offset in the string section
+    struct StrRef {
+        uint64_t offset;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    // size and modification time of a text file; bytes = -1 if it did not exist
+    struct FileStamp {
+        int64_t bytes;
+        int64_t mtimeNs;
+        bool operator==(const FileStamp& o) const { return bytes == o.bytes && mtimeNs == o.mtimeNs; }
+    };
+
+    struct SectionEntry {
+        uint64_t offset;    // from the start of the file, SECTION_ALIGN aligned
+        uint64_t bytes;
+        uint64_t count;     // records (bytes for the string section)
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t fileBytes;
+        int64_t createdEpoch;
+        int32_t nextProductID, nextUserID, nextTransactionID, reserved;
+        FileStamp stamps[STAMP_COUNT];
+        SectionEntry sections[SECTION_COUNT];
+    };
+
+    struct ProductRecord {
+        int32_t id;
+        uint8_t category, section, hasSize, reserved;
+        double price;
+        int32_t stock[6];
+        StrRef name;
+    };
+
+    struct UserRecord {
+        int32_t id;
+        int32_t level;
+        double totalSpent;
+        uint8_t isAdmin, reserved[7];
+        StrRef username, password;
+    };
+
+    struct TransactionRecord {
+        int32_t id, userID;
+        double rawTotal, discountRate, finalTotal;
+        int64_t epoch;
+        int32_t userLevel;
+        uint32_t itemCount;
+        uint64_t firstItem;     // index of its first record in the item section
+    };
+
+    struct ItemRecord {
+        int32_t productID;
+        uint8_t category, section, reserved[2];
+        double unitPrice;
+        int32_t quantities[6];
+        double subtotal;
+        StrRef name;
+    };
+
+    static_assert(sizeof(Header) == 256 && sizeof(ProductRecord) == 56 && sizeof(UserRecord) == 56 &&
+                  sizeof(TransactionRecord) == 56 && sizeof(ItemRecord) == 64,
+                  "snapshot records must keep their size (bump Snapshot::VERSION when changing them)");
+    static_assert(is_trivially_copyable<Header>::value && is_trivially_copyable<ItemRecord>::value,
+                  "snapshot records are written and read as raw bytes");
+
+    FileStamp stampOf(const string& path) {
+        error_code ec;
+        uintmax_t bytes = filesystem::file_size(path, ec);
+        if (ec) return FileStamp{-1, 0};
+        auto mtime = filesystem::last_write_time(path, ec);
+        int64_t ns = ec ? 0 : chrono::duration_cast<chrono::nanoseconds>(mtime.time_since_epoch()).count();
+        return FileStamp{static_cast<int64_t>(bytes), ns};
+    }
+
+    void stampSources(const SnapshotSources& sources, FileStamp (&out)[STAMP_COUNT]) {
+        out[ProductFileStamp] = stampOf(sources.productFile);
+        out[ProductJournalStamp] = stampOf(sources.productFile + ".journal");
+        out[UsersFileStamp] = stampOf(sources.usersFile);
+        out[TransactionFileStamp] = stampOf(sources.transactionFile);
+    }
+
+    // ==================== Writing ====================
+
+    // String bytes for the string section; equal strings are stored once. Keys view the
+    // caller's strings, which must stay alive (and unchanged) until the pool is written.
+    class StringPool {
+    private:
+        string bytes;
+        unordered_map<string_view, StrRef> seen;
+    public:
+        StrRef add(string_view s) {
+            auto it = seen.find(s);
+            if (it != seen.end()) return it->second;
+            StrRef ref{bytes.size(), static_cast<uint32_t>(s.size()), 0};
+            bytes.append(s.data(), s.size());
+            seen.emplace(s, ref);
+            return ref;
+        }
+        const string& data() const { return bytes; }
+    };
+
+    // Buffered sequential writer that tracks the offset and the first error
+    class SnapshotFile {
+    private:
+        FILE* f;
+        uint64_t offset;
+        bool ok;
+    public:
+        explicit SnapshotFile(const string& path) : f(fopen(path.c_str(), "wb")), offset(0), ok(f != nullptr) {
+            if (f) setvbuf(f, nullptr, _IOFBF, 8 << 20);
+        }
+        ~SnapshotFile() { close(); }
+        bool good() const { return ok; }
+        uint64_t position() const { return offset; }
+        void put(const void* data, size_t len) {
+            if (ok && len > 0 && fwrite(data, 1, len, f) != len) ok = false;
+            offset += len;
+        }
+        template <typename T>
+        void put(const T& record) { put(&record, sizeof(T)); }
+        void alignTo(size_t align) {
+            static const char zeros[SECTION_ALIGN] = {};
+            size_t pad = (align - offset % align) % align;
+            put(zeros, pad);
+        }
+        // start a section at the next aligned offset
+        void begin(SectionEntry& section) {
+            alignTo(SECTION_ALIGN);
+            section.offset = offset;
+        }
+        void end(SectionEntry& section, uint64_t count) {
+            section.bytes = offset - section.offset;
+            section.count = count;
+        }
+        void rewriteAt(uint64_t at, const void* data, size_t len) {
+            if (ok && (fflush(f) != 0 || fseek(f, static_cast<long>(at), SEEK_SET) != 0 ||
+                       fwrite(data, 1, len, f) != len)) {
+                ok = false;
+            }
+        }
+        bool close() {
+            if (f && fclose(f) != 0) ok = false;
+            f = nullptr;
+            return ok;
+        }
+    };
+
+    // ==================== Reading ====================
+
+    // Typed view of one section; false if its size does not match count records of T
+    template <typename T>
+    bool sectionView(const Header& h, const char* base, int id, const T*& records, size_t& count) {
+        const SectionEntry& s = h.sections[id];
+        if (s.offset % SECTION_ALIGN != 0 || s.offset > h.fileBytes || s.bytes > h.fileBytes - s.offset ||
+            s.bytes != s.count * sizeof(T)) {
+            return false;
+        }
+        records = reinterpret_cast<const T*>(base + s.offset);
+        count = static_cast<size_t>(s.count);
+        return true;
+    }
+
+    bool validCategorySection(uint8_t cat, uint8_t sec) {
+        if (cat > static_cast<uint8_t>(Category::Other) || sec > static_cast<uint8_t>(Section::Other)) return false;
+        Category c = static_cast<Category>(cat);
+        Section s = static_cast<Section>(sec);
+        if (c == Category::Other) return s == Section::Other;
+        if (c == Category::Kids) return s == Section::Boys || s == Section::Girls || s == Section::Other;
+        return s == Section::Eastern || s == Section::Western || s == Section::Other;
+    }
+
+    SnapshotStatus readHeader(const MappedFile& file, Header& h) {
+        if (file.size() < sizeof(Header)) return SnapshotStatus::BadFormat;
+        memcpy(&h, file.data(), sizeof(Header));
+        if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) return SnapshotStatus::BadFormat;
+        if (h.version != Snapshot::VERSION || h.byteOrder != BYTE_ORDER_MARK) return SnapshotStatus::VersionMismatch;
+        if (h.fileBytes != file.size()) return SnapshotStatus::BadFormat;   // truncated or appended to
+        return SnapshotStatus::Success;
+    }
+}
+
+// ==================== Snapshot ====================
+
+SnapshotStatus Snapshot::write(const string& path, const ProductManager& pm, const UserList& users,
+                               int nextUserID, const TransactionStore& store, const SnapshotSources& sources) {
+    if (!store.isLoaded()) return SnapshotStatus::WriteFailed;     // would record an empty history
+    Header h{};
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.byteOrder = BYTE_ORDER_MARK;
+    h.createdEpoch = Transaction::currentEpoch();
+    h.nextProductID = pm.getNextProductID();
+    h.nextUserID = nextUserID;
+    stampSources(sources, h.stamps);
+
+    string tmpName = path + ".tmp";
+    SnapshotFile out(tmpName);
+    if (!out.good()) return SnapshotStatus::WriteFailed;
+    out.put(h);     // placeholder, rewritten with the section table at the end
+    StringPool strings;
+
+    SectionEntry& products = h.sections[ProductsSection];
+    out.begin(products);
+    uint64_t productCount = 0;
+    // every product in ID order (walking 1..nextProductID would crawl after a stray huge ID)
+    for (const Product* p : pm.getProductPage(0, pm.getProductCount())) {
+        ProductRecord r{};
+        r.id = p->getProductID();
+        r.category = static_cast<uint8_t>(p->getCategory());
+        r.section = static_cast<uint8_t>(p->getSection());
+        r.hasSize = p->getHasSize() ? 1 : 0;
+        r.price = p->getPrice();
+        SizeStock stock = p->getSizeStock();
+        copy(stock.begin(), stock.end(), r.stock);
+        r.name = strings.add(p->getProductName());
+        out.put(r);
+        ++productCount;
+    }
+    out.end(products, productCount);
+
+    SectionEntry& userSection = h.sections[UsersSection];
+    out.begin(userSection);
+    for (const User& u : users) {
+        UserRecord r{};
+        r.id = u.userID;
+        r.level = u.level;
+        r.totalSpent = u.totalSpent;
+        r.isAdmin = u.isAdmin ? 1 : 0;
+        r.username = strings.add(u.username);
+        r.password = strings.add(u.password);
+        out.put(r);
+    }
+    out.end(userSection, users.size());
+
+    {
+        TransactionStore::ReadGuard guard(store);
+        const deque<Transaction>& txs = store.all();
+
+        SectionEntry& txSection = h.sections[TransactionsSection];
+        out.begin(txSection);
+        uint64_t itemCount = 0;
+        for (const Transaction& tx : txs) {
+            TransactionRecord r{};
+            r.id = tx.getTransactionID();
+            r.userID = tx.getUserID();
+            r.rawTotal = tx.getRawTotal();
+            r.discountRate = tx.getDiscountRate();
+            r.finalTotal = tx.getFinalTotal();
+            r.epoch = tx.getEpoch();
+            r.userLevel = tx.getUserLevel();
+            r.itemCount = static_cast<uint32_t>(tx.getItems().size());
+            r.firstItem = itemCount;
+            itemCount += r.itemCount;
+            out.put(r);
+        }
+        out.end(txSection, txs.size());
+
+        SectionEntry& itemSection = h.sections[ItemsSection];
+        out.begin(itemSection);
+        for (const Transaction& tx : txs) {
+            for (const TransactionItem& item : tx.getItems()) {
+                ItemRecord r{};
+                r.productID = item.productID;
+                r.category = static_cast<uint8_t>(item.category);
+                r.section = static_cast<uint8_t>(item.section);
+                r.unitPrice = item.unitPrice;
+                for (size_t i = 0; i < 6 && i < item.quantities.size(); ++i) r.quantities[i] = item.quantities[i];
+                r.subtotal = item.subtotal;
+                r.name = strings.add(item.productName);
+                out.put(r);
+            }
+        }
+        out.end(itemSection, itemCount);
+
+        vector<uint32_t> order = store.amountOrder();
+        SectionEntry& orderSection = h.sections[AmountOrderSection];
+        out.begin(orderSection);
+        out.put(order.data(), order.size() * sizeof(uint32_t));
+        out.end(orderSection, order.size());
+
+        SectionEntry& stringSection = h.sections[StringsSection];
+        out.begin(stringSection);
+        out.put(strings.data().data(), strings.data().size());
+        out.end(stringSection, strings.data().size());
+    }
+
+    // read after the records: a checkout in between only makes it skip an ID
+    h.nextTransactionID = store.getNextTransactionID();
+    h.fileBytes = out.position();
+    out.rewriteAt(0, &h, sizeof(h));
+    if (!out.close()) {
+        remove(tmpName.c_str());
+        return SnapshotStatus::WriteFailed;
+    }
+    remove(path.c_str());
+    if (rename(tmpName.c_str(), path.c_str()) != 0) return SnapshotStatus::WriteFailed;
+    return SnapshotStatus::Success;
+}
+
+SnapshotStatus Snapshot::load(const string& path, ProductManager& pm, UserList& users, int& nextUserID,
+                              TransactionStore& store, const SnapshotSources* sources) {
+    MappedFile file;
+    if (!file.open(path)) return SnapshotStatus::NotFound;
+    Header h;
+    SnapshotStatus status = readHeader(file, h);
+    if (status != SnapshotStatus::Success) return status;
+    if (sources) {
+        FileStamp now[STAMP_COUNT];
+        stampSources(*sources, now);
+        for (int i = 0; i < STAMP_COUNT; ++i) {
+            if (!(now[i] == h.stamps[i])) return SnapshotStatus::Stale;
+        }
+    }
+
+    const char* base = file.data();
+    const char* stringBytes;
+    const ProductRecord* productRecs;
+    const UserRecord* userRecs;
+    const TransactionRecord* txRecs;
+    const ItemRecord* itemRecs;
+    const uint32_t* orderRecs;
+    size_t stringCount, productCount, userCount, txCount, itemCount, orderCount;
+    if (!sectionView(h, base, StringsSection, stringBytes, stringCount) ||
+        !sectionView(h, base, ProductsSection, productRecs, productCount) ||
+        !sectionView(h, base, UsersSection, userRecs, userCount) ||
+        !sectionView(h, base, TransactionsSection, txRecs, txCount) ||
+        !sectionView(h, base, ItemsSection, itemRecs, itemCount) ||
+        !sectionView(h, base, AmountOrderSection, orderRecs, orderCount)) {
+        return SnapshotStatus::BadFormat;
+    }
+
+    // check everything before replacing anything
+    auto validRef = [&](const StrRef& r) { return r.offset <= stringCount && r.length <= stringCount - r.offset; };
+    auto text = [&](const StrRef& r) { return string_view(stringBytes + r.offset, r.length); };
+    for (size_t i = 0; i < productCount; ++i) {
+        const ProductRecord& r = productRecs[i];
+        if (r.id <= 0 || !validCategorySection(r.category, r.section) || !validRef(r.name)) return SnapshotStatus::BadFormat;
+    }
+    for (size_t i = 0; i < userCount; ++i) {
+        if (userRecs[i].id <= 0 || !validRef(userRecs[i].username) || !validRef(userRecs[i].password)) {
+            return SnapshotStatus::BadFormat;
+        }
+    }
+    uint64_t nextItem = 0;
+    for (size_t i = 0; i < txCount; ++i) {
+        if (txRecs[i].firstItem != nextItem || txRecs[i].itemCount > itemCount - nextItem) return SnapshotStatus::BadFormat;
+        nextItem += txRecs[i].itemCount;
+    }
+    if (nextItem != itemCount) return SnapshotStatus::BadFormat;
+    for (size_t i = 0; i < itemCount; ++i) {
+        if (!validCategorySection(itemRecs[i].category, itemRecs[i].section) || !validRef(itemRecs[i].name)) {
+            return SnapshotStatus::BadFormat;
+        }
+    }
+
+    // catalog
+    pm.resetCatalog(h.nextProductID, productCount, sources ? sources->productFile : "");
+    for (size_t i = 0; i < productCount; ++i) {
+        const ProductRecord& r = productRecs[i];
+        SizeStock stock;
+        copy(r.stock, r.stock + 6, stock.begin());
+        Product p(r.id, text(r.name), static_cast<Category>(r.category), static_cast<Section>(r.section), stock, r.price);
+        p.setHasSize(r.hasSize != 0);
+        pm.restoreProduct(p);
+    }
+
+    // transactions
+    deque<Transaction> records;
+    for (size_t i = 0; i < txCount; ++i) {
+        const TransactionRecord& r = txRecs[i];
+        vector<TransactionItem> items;
+        items.reserve(r.itemCount);
+        for (const ItemRecord* it = itemRecs + r.firstItem; it != itemRecs + r.firstItem + r.itemCount; ++it) {
+            items.emplace_back(it->productID, string(text(it->name)), static_cast<Category>(it->category),
+                               static_cast<Section>(it->section), it->unitPrice,
+                               vector<int>(it->quantities, it->quantities + 6));
+            items.back().subtotal = it->subtotal;
+        }
+        records.emplace_back(r.id, r.userID, std::move(items), r.rawTotal, r.discountRate, r.finalTotal,
+                             r.epoch, r.userLevel);
+    }
+    vector<uint32_t> order(orderRecs, orderRecs + orderCount);
+    store.adopt(std::move(records), h.nextTransactionID, &order);
+
+    // users after the transactions: a User's TransactionManager loads the shared store if it is
+    // not loaded yet, which would parse the text file this snapshot stands in for
+    users.clear();
+    users.reserveIndex(userCount);
+    for (size_t i = 0; i < userCount; ++i) {
+        const UserRecord& r = userRecs[i];
+        users.add(User(r.id, string(text(r.username)), string(text(r.password)), r.level, r.isAdmin != 0, r.totalSpent));
+    }
+    nextUserID = h.nextUserID;
+    return SnapshotStatus::Success;
+}
+
+SnapshotStatus Snapshot::info(const string& path, SnapshotInfo& out) {
+    MappedFile file;
+    if (!file.open(path)) return SnapshotStatus::NotFound;
+    Header h;
+    SnapshotStatus status = readHeader(file, h);
+    if (status != SnapshotStatus::Success) return status;
+    out.version = h.version;
+    out.createdEpoch = h.createdEpoch;
+    out.fileBytes = h.fileBytes;
+    out.products = h.sections[ProductsSection].count;
+    out.users = h.sections[UsersSection].count;
+    out.transactions = h.sections[TransactionsSection].count;
+    out.items = h.sections[ItemsSection].count;
+    out.nextProductID = h.nextProductID;
+    out.nextUserID = h.nextUserID;
+    out.nextTransactionID = h.nextTransactionID;
+    return SnapshotStatus::Success;
+}
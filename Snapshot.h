@@ -0,0 +1,90 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+
+#include "ProductManager.h"
+#include "TransactionStore.h"
+#include "User.h"
+
+using namespace std;
+
+// ==================== Snapshot ====================
+// Binary checkpoint of the whole system state: catalog, users, transactions (with the amount
+// order of the transaction index) and the three ID counters, in one versioned file.
+//
+// Layout: a fixed header (magic, version, byte order, counters, the section table and a
+// stamp of every text file the snapshot was taken from), then one section per table of
+// fixed-size little-endian records, then a pool of string bytes the records point into.
+// Loading maps the file and builds the objects straight from those records: no text is
+// split or converted, and the amount index is rebuilt without sorting. The objects are built
+// rather than read in place from the mapping because the catalog and the store mutate them
+// (atomic stock counters, appended records) and hand out pointers to them; most of the load
+// time is the transaction indexes, which the store would have to build either way.
+//
+// The text files stay the primary storage (checkouts keep appending to TransactionRecord.txt);
+// a snapshot only speeds up startup while they are unchanged. load() with sources given
+// refuses a snapshot whose stamps (size + modification time) no longer match the files.
+
+enum class SnapshotStatus {
+    Success,
+    NotFound,           // no snapshot file
+    BadFormat,          // not a snapshot, truncated, or inconsistent
+    VersionMismatch,    // written by another snapshot version (or byte order)
+    Stale,              // the text files changed since the snapshot was taken
+    WriteFailed
+};
+
+static string snapshotStatusToString(SnapshotStatus status) {
+    switch (status) {
+        case SnapshotStatus::Success: return "Success";
+        case SnapshotStatus::NotFound: return "Snapshot file not found";
+        case SnapshotStatus::BadFormat: return "Not a valid snapshot file";
+        case SnapshotStatus::VersionMismatch: return "Snapshot was written by an incompatible version";
+        case SnapshotStatus::Stale: return "Data files changed since the snapshot was taken";
+        case SnapshotStatus::WriteFailed: return "Snapshot could not be written";
+    }
+    return "Unknown";
+}
+
+// The text files a snapshot stands for
+struct SnapshotSources {
+    string productFile = "products.txt";    // its ".journal" is stamped too
+    string usersFile = User::usersFileName();
+    string transactionFile = "TransactionRecord.txt";
+};
+
+// Summary from the snapshot header
+struct SnapshotInfo {
+    uint32_t version = 0;
+    int64_t createdEpoch = 0;   // local clock time, as Transaction epochs
+    uint64_t fileBytes = 0;
+    uint64_t products = 0, users = 0, transactions = 0, items = 0;
+    int nextProductID = 1, nextUserID = 1, nextTransactionID = 1;
+};
+
+class Snapshot {
+public:
+    static const uint32_t VERSION = 1;
+    static string defaultFileName() { return "shop.snapshot"; }
+
+    // Write the current state to path (through a temp file, so an old snapshot is replaced
+    // only by a complete one). The text files in sources are stamped as they are now, so save
+    // them first, and load the store (WriteFailed if it is not loaded). No console output.
+    static SnapshotStatus write(const string& path, const ProductManager& pm, const UserList& users,
+                                int nextUserID, const TransactionStore& store,
+                                const SnapshotSources& sources = SnapshotSources());
+
+    // Replace pm, users / nextUserID and the store's records with the snapshot. With sources,
+    // a snapshot whose stamps do not match those files is Stale and nothing is loaded; without,
+    // any valid snapshot is loaded (export tools). The file is checked completely before
+    // anything is replaced. No console output.
+    static SnapshotStatus load(const string& path, ProductManager& pm, UserList& users, int& nextUserID,
+                               TransactionStore& store, const SnapshotSources* sources = nullptr);
+
+    // Read only the header
+    static SnapshotStatus info(const string& path, SnapshotInfo& out);
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,129 @@
+#ifndef STOCKVEC_H
+#define STOCKVEC_H
+
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE2__) && !defined(SHOP_SCALAR_STOCK)
+#include <emmintrin.h>
+#define SHOP_SIMD_STOCK 1
+#endif
+
+using namespace std;
+
+// ==================== StockVec ====================
+// Six per-size counters (XS..XL, None: a SizeStock, a cart line, an order line) as one 8-lane
+// int32 vector; lanes 6 and 7 are always 0. Compares return a bit mask with bit i set for
+// size index i, so "any size short?" is one test and the short sizes are the set bits.
+// StockVec is SimdStockVec on SSE2 targets (every x86-64 compiler) and ScalarStockVec
+// elsewhere or when built with SHOP_SCALAR_STOCK; both give identical results.
+
+// Portable version: plain loops over the six used lanes (lanes 6 and 7 stay 0)
+class ScalarStockVec {
+private:
+    int32_t v[8];
+
+public:
+    ScalarStockVec() : v{} {}
+    explicit ScalarStockVec(const array<int, 6>& s) : v{s[0], s[1], s[2], s[3], s[4], s[5], 0, 0} {}
+    ScalarStockVec(int xs, int s, int m, int l, int xl, int none) : v{xs, s, m, l, xl, none, 0, 0} {}
+
+    array<int, 6> toArray() const { return {v[0], v[1], v[2], v[3], v[4], v[5]}; }
+    int lane(int i) const { return v[i]; }
+
+    ScalarStockVec operator+(const ScalarStockVec& o) const {
+        ScalarStockVec r;
+        for (int i = 0; i < 6; ++i) r.v[i] = v[i] + o.v[i];
+        return r;
+    }
+    ScalarStockVec operator-(const ScalarStockVec& o) const {
+        ScalarStockVec r;
+        for (int i = 0; i < 6; ++i) r.v[i] = v[i] - o.v[i];
+        return r;
+    }
+    // negative lanes become 0
+    ScalarStockVec clampNegative() const {
+        ScalarStockVec r;
+        for (int i = 0; i < 6; ++i) r.v[i] = v[i] > 0 ? v[i] : 0;
+        return r;
+    }
+    // lanes whose value is greater than o's
+    unsigned greaterThan(const ScalarStockVec& o) const {
+        unsigned mask = 0;
+        for (int i = 0; i < 6; ++i) mask |= (v[i] > o.v[i] ? 1u : 0u) << i;
+        return mask;
+    }
+    unsigned positiveMask() const { return greaterThan(ScalarStockVec()); }
+    // how much of each size is missing when this is wanted and have is available (0 if enough)
+    ScalarStockVec shortage(const ScalarStockVec& have) const { return (*this - have).clampNegative(); }
+    int sum() const {
+        int total = 0;
+        for (int i = 0; i < 6; ++i) total += v[i];
+        return total;
+    }
+};
+
+#ifdef SHOP_SIMD_STOCK
+// SSE2 version: lanes 0-3 and 4-7 in two 128-bit registers
+class SimdStockVec {
+private:
+    __m128i lo;
+    __m128i hi;
+
+    SimdStockVec(__m128i l, __m128i h) : lo(l), hi(h) {}
+    static unsigned mask4(__m128i cmp) { return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(cmp))); }
+
+public:
+    SimdStockVec() : lo(_mm_setzero_si128()), hi(_mm_setzero_si128()) {}
+    // 16 + 8 bytes: lanes 6 and 7 are zeroed by the 64-bit load
+    explicit SimdStockVec(const array<int, 6>& s)
+        : lo(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()))),
+          hi(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s.data() + 4))) {}
+    // from values in registers (e.g. just loaded one by one: storing them to an array first
+    // and loading that as a vector would stall on store forwarding)
+    SimdStockVec(int xs, int s, int m, int l, int xl, int none)
+        : lo(_mm_setr_epi32(xs, s, m, l)), hi(_mm_setr_epi32(xl, none, 0, 0)) {}
+
+    array<int, 6> toArray() const {
+        array<int, 6> s;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(s.data()), lo);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(s.data() + 4), hi);
+        return s;
+    }
+    int lane(int i) const {
+        alignas(16) int32_t out[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(out), lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(out + 4), hi);
+        return out[i];
+    }
+
+    SimdStockVec operator+(const SimdStockVec& o) const {
+        return SimdStockVec(_mm_add_epi32(lo, o.lo), _mm_add_epi32(hi, o.hi));
+    }
+    SimdStockVec operator-(const SimdStockVec& o) const {
+        return SimdStockVec(_mm_sub_epi32(lo, o.lo), _mm_sub_epi32(hi, o.hi));
+    }
+    // negative lanes become 0 (SSE2 has no 32-bit max: keep lanes that compare > 0)
+    SimdStockVec clampNegative() const {
+        __m128i zero = _mm_setzero_si128();
+        return SimdStockVec(_mm_and_si128(lo, _mm_cmpgt_epi32(lo, zero)), _mm_and_si128(hi, _mm_cmpgt_epi32(hi, zero)));
+    }
+    unsigned greaterThan(const SimdStockVec& o) const {
+        return mask4(_mm_cmpgt_epi32(lo, o.lo)) | (mask4(_mm_cmpgt_epi32(hi, o.hi)) << 4);
+    }
+    unsigned positiveMask() const { return greaterThan(SimdStockVec()); }
+    SimdStockVec shortage(const SimdStockVec& have) const { return (*this - have).clampNegative(); }
+    int sum() const {
+        __m128i s = _mm_add_epi32(lo, hi);
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(s);
+    }
+};
+
+using StockVec = SimdStockVec;
+#else
+using StockVec = ScalarStockVec;
+#endif
+
+#endif // STOCKVEC_H
@@ -1,11 +1,14 @@
 #include "Transaction.h"
+#include "TransactionStore.h"
+#include "FileIO.h"
+#include "OutputSink.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <numeric>
-#include <limits>
 #include <algorithm>
+#include <cmath>
 
 using namespace std;
 
@@ -17,6 +20,13 @@ TransactionItem::TransactionItem()
     quantities.resize(6, 0);
 }
 
+TransactionItem::TransactionItem(int id, const string& name, Category cat, Section sec,
+                                 double price, const SizeStock& qty)
+    : productID(id), productName(name), category(cat), section(sec),
+      unitPrice(price), quantities(qty.begin(), qty.end()) {
+    subtotal = unitPrice * StockVec(qty).sum();
+}
+
 TransactionItem::TransactionItem(int id, const string& name, Category cat, Section sec,
                                  double price, const vector<int>& qtys)
     : productID(id), productName(name), category(cat), section(sec),
@@ -30,60 +40,162 @@ TransactionItem::TransactionItem(int id, const string& name, Category cat, Secti
 
 Transaction::Transaction()
     : transactionID(0), userID(0), rawTotal(0.0),
-      discountRate(1.0), finalTotal(0.0), timestamp(""), userLevel(1) {}
+      discountRate(1.0), finalTotal(0.0), epoch(0), userLevel(1) {}
 
-Transaction::Transaction(int txID, int uID, const vector<TransactionItem>& itms,
+Transaction::Transaction(int txID, int uID, vector<TransactionItem> itms,
                          double raw, double rate, double final_,
                          const string& time, int level)
-    : transactionID(txID), userID(uID), items(itms), rawTotal(raw),
-      discountRate(rate), finalTotal(final_), timestamp(time), userLevel(level) {}
+    : transactionID(txID), userID(uID), items(std::move(itms)), rawTotal(raw),
+      discountRate(rate), finalTotal(final_), epoch(0), userLevel(level) {
+    parseTimestamp(time, epoch);
+}
 
-void Transaction::displayInvoice() const {
-    cout << "\n";
-    cout << "================================================================" << endl;
-    cout << "                    TRANSACTION INVOICE                         " << endl;
-    cout << "================================================================" << endl;
-    cout << "  Transaction ID: " << transactionID
-         << "          User ID: " << userID << endl;
-    cout << "  Date/Time: " << timestamp << endl;
-    cout << "  Customer Level: " << userLevel << endl;
-    cout << "----------------------------------------------------------------" << endl;
-    cout << "                      ITEMS PURCHASED                           " << endl;
-    cout << "----------------------------------------------------------------" << endl;
+Transaction::Transaction(int txID, int uID, vector<TransactionItem> itms,
+                         double raw, double rate, double final_, int64_t time, int level)
+    : transactionID(txID), userID(uID), items(std::move(itms)), rawTotal(raw),
+      discountRate(rate), finalTotal(final_), epoch(time), userLevel(level) {}
+
+// Days since 1970-01-01 for a proleptic Gregorian date, and back (H. Hinnant's algorithms)
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+static void civilFromDays(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+// Parse `width` digits at text[pos]
+static bool digitsAt(string_view text, size_t pos, size_t width, int& out) {
+    if (pos + width > text.size()) return false;
+    out = 0;
+    for (size_t i = pos; i < pos + width; ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        out = out * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+bool Transaction::parseTimestamp(string_view text, int64_t& epochOut, bool roundUp) {
+    int y, mo, d, h = roundUp ? 23 : 0, mi = roundUp ? 59 : 0, sec = roundUp ? 59 : 0;
+    if (!digitsAt(text, 0, 4, y) || text.size() < 10 || text[4] != '-' || text[7] != '-' ||
+        !digitsAt(text, 5, 2, mo) || !digitsAt(text, 8, 2, d)) {
+        return false;
+    }
+    if (text.size() > 10) {
+        // " HH:MM" or " HH:MM:SS"
+        if (text[10] != ' ' || text.size() < 16 || text[13] != ':' ||
+            !digitsAt(text, 11, 2, h) || !digitsAt(text, 14, 2, mi)) {
+            return false;
+        }
+        if (text.size() > 16) {
+            if (text.size() != 19 || text[16] != ':' || !digitsAt(text, 17, 2, sec)) return false;
+        } else {
+            sec = roundUp ? 59 : 0;
+        }
+    }
+    if (mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || sec > 60) return false;
+    epochOut = epochOf(y, mo, d, h, mi, sec);
+    return true;
+}
+
+int64_t Transaction::epochOf(int year, int month, int day, int hour, int minute, int second) {
+    return daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 +
+           hour * 3600 + minute * 60 + second;
+}
+
+int64_t Transaction::currentEpoch() {
+    time_t now = time(nullptr);
+    tm ltm{};
+    // reentrant version: checkouts on several threads stamp their records at once
+#ifdef _WIN32
+    localtime_s(&ltm, &now);
+#else
+    localtime_r(&now, &ltm);
+#endif
+    // the local wall-clock reading, on the same scale parseTimestamp uses
+    return epochOf(1900 + ltm.tm_year, 1 + ltm.tm_mon, ltm.tm_mday, ltm.tm_hour, ltm.tm_min, ltm.tm_sec);
+}
+
+string Transaction::formatTimestamp(int64_t epochValue) {
+    int64_t days = epochValue / 86400;
+    int64_t secs = epochValue % 86400;
+    if (secs < 0) {
+        secs += 86400;
+        --days;
+    }
+    int64_t y;
+    unsigned m, d;
+    civilFromDays(days, y, m, d);
+    char buf[64];   // room for any year an int64 epoch can hold
+    snprintf(buf, sizeof(buf), "%04lld-%02u-%02u %02d:%02d:%02d", static_cast<long long>(y), m, d,
+             static_cast<int>(secs / 3600), static_cast<int>(secs / 60 % 60), static_cast<int>(secs % 60));
+    return buf;
+}
+
+void Transaction::displayInvoice(ostream& out) const {
+    out << "\n";
+    out << "================================================================\n";
+    out << "                    TRANSACTION INVOICE                         \n";
+    out << "================================================================\n";
+    out << "  Transaction ID: " << transactionID
+        << "          User ID: " << userID << '\n';
+    out << "  Date/Time: " << getTimestamp() << '\n';
+    out << "  Customer Level: " << userLevel << '\n';
+    out << "----------------------------------------------------------------\n";
+    out << "                      ITEMS PURCHASED                           \n";
+    out << "----------------------------------------------------------------\n";
 
     int itemNum = 1;
     for (const auto& item : items) {
-        cout << "  Item #" << itemNum++ << endl;
-        cout << "  Product ID: " << item.productID << endl;
-        cout << "  Name: " << item.productName << endl;
-        cout << "  Category: " << categoryToString(item.category)
-             << " | Section: " << sectionToString(item.section) << endl;
-        cout << "  Unit Price: $" << fixed << setprecision(2) << item.unitPrice << endl;
-        cout << "  Quantities: ";
+        out << "  Item #" << itemNum++ << '\n';
+        out << "  Product ID: " << item.productID << '\n';
+        out << "  Name: " << item.productName << '\n';
+        out << "  Category: " << categoryToString(item.category)
+            << " | Section: " << sectionToString(item.section) << '\n';
+        out << "  Unit Price: $" << fixed << setprecision(2) << item.unitPrice << '\n';
+        out << "  Quantities: ";
 
         bool first = true;
         for (int i = 0; i < 6; ++i) {
             if (item.quantities[i] > 0) {
-                if (!first) cout << ", ";
-                cout << sizeToString(static_cast<Size>(i)) << "=" << item.quantities[i];
+                if (!first) out << ", ";
+                out << sizeToString(static_cast<Size>(i)) << "=" << item.quantities[i];
                 first = false;
             }
         }
-        cout << endl;
-        cout << "  Subtotal: $" << fixed << setprecision(2) << item.subtotal << endl;
-        cout << "  --------------------------------------------------------------" << endl;
+        out << '\n';
+        out << "  Subtotal: $" << fixed << setprecision(2) << item.subtotal << '\n';
+        out << "  --------------------------------------------------------------\n";
     }
 
-    cout << "----------------------------------------------------------------" << endl;
-    cout << "                       PAYMENT SUMMARY                          " << endl;
-    cout << "----------------------------------------------------------------" << endl;
-    cout << "  Raw Total:       $" << fixed << setprecision(2) << rawTotal << endl;
-    cout << "  Discount Rate:    " << fixed << setprecision(0) << (discountRate * 100) << "%" << endl;
-    cout << "  Discount Amount: $" << fixed << setprecision(2) << (rawTotal - finalTotal) << endl;
-    cout << "  =============================================================" << endl;
-    cout << "  FINAL TOTAL:     $" << fixed << setprecision(2) << finalTotal << endl;
-    cout << "================================================================" << endl;
-    cout << "\n";
+    out << "----------------------------------------------------------------\n";
+    out << "                       PAYMENT SUMMARY                          \n";
+    out << "----------------------------------------------------------------\n";
+    out << "  Raw Total:       $" << fixed << setprecision(2) << rawTotal << '\n';
+    out << "  Discount Rate:    " << fixed << setprecision(0) << (discountRate * 100) << "%\n";
+    out << "  Discount Amount: $" << fixed << setprecision(2) << (rawTotal - finalTotal) << '\n';
+    out << "  =============================================================\n";
+    out << "  FINAL TOTAL:     $" << fixed << setprecision(2) << finalTotal << '\n';
+    out << "================================================================\n";
+    out << "\n";
+}
+
+void Transaction::displayInvoice() const {
+    ConsoleSink sink;
+    displayInvoice(sink.stream());
 }
 
 string Transaction::serialize() const {
@@ -92,7 +204,7 @@ string Transaction::serialize() const {
     oss << "TX|" << transactionID << "|" << userID << "|"
         << fixed << setprecision(2) << rawTotal << "|"
         << discountRate << "|" << finalTotal << "|"
-        << timestamp << "|" << userLevel << "|" << items.size() << "\n";
+        << getTimestamp() << "|" << userLevel << "|" << items.size() << "\n";
 
     // ITEM|productID|productName|category|section|unitPrice|q0|q1|q2|q3|q4|q5|subtotal
     for (const auto& item : items) {
@@ -111,89 +223,73 @@ string Transaction::serialize() const {
 
 optional<Transaction> Transaction::deserialize(const vector<string>& lines) {
     if (lines.empty()) return nullopt;
+    vector<string_view> itemLines(lines.begin() + 1, lines.end());
+    return parse(lines[0], itemLines);
+}
 
-    istringstream iss(lines[0]);
-    string token;
-    vector<string> parts;
-    while (getline(iss, token, '|')) parts.push_back(token);
-
-    if (parts.size() != 9 || parts[0] != "TX") return nullopt;
-
-    try {
-        int txID = stoi(parts[1]);
-        int uID = stoi(parts[2]);
-        double raw = stod(parts[3]);
-        double rate = stod(parts[4]);
-        double final_ = stod(parts[5]);
-        string time = parts[6];
-        int level = stoi(parts[7]);
-        int itemCount = stoi(parts[8]);
-
-        vector<TransactionItem> items;
-
-        for (size_t i = 1; i < lines.size() && i <= static_cast<size_t>(itemCount); ++i) {
-            istringstream itemIss(lines[i]);
-            vector<string> itemParts;
-            string itemToken;
-            while (getline(itemIss, itemToken, '|')) itemParts.push_back(itemToken);
-
-            if (itemParts.size() != 13 || itemParts[0] != "ITEM") continue;
-
-            TransactionItem item;
-            item.productID = stoi(itemParts[1]);
-            item.productName = itemParts[2];
-            item.category = static_cast<Category>(stoi(itemParts[3]));
-            item.section = static_cast<Section>(stoi(itemParts[4]));
-            item.unitPrice = stod(itemParts[5]);
-
-            item.quantities.resize(6);
-            for (int j = 0; j < 6; ++j) item.quantities[j] = stoi(itemParts[6 + j]);
-            item.subtotal = stod(itemParts[12]);
-
-            items.push_back(item);
-        }
-
-        return Transaction(txID, uID, items, raw, rate, final_, time, level);
-    } catch (...) {
+optional<Transaction> Transaction::parse(string_view header, const vector<string_view>& itemLines) {
+    // TX|transactionID|userID|rawTotal|discountRate|finalTotal|timestamp|userLevel|itemCount
+    string_view parts[10];
+    if (splitFields(header, '|', parts, 10) != 9 || parts[0] != "TX") return nullopt;
+
+    Transaction tx;
+    int itemCount;
+    if (!parseField(parts[1], tx.transactionID) || !parseField(parts[2], tx.userID) ||
+        !parseField(parts[3], tx.rawTotal) || !parseField(parts[4], tx.discountRate) ||
+        !parseField(parts[5], tx.finalTotal) || !parseField(parts[7], tx.userLevel) ||
+        !parseField(parts[8], itemCount) || !parseTimestamp(parts[6], tx.epoch)) {
         return nullopt;
     }
+
+    // only the first itemCount lines belong to this record; lines of the wrong shape are skipped
+    size_t limit = min(itemLines.size(), static_cast<size_t>(max(itemCount, 0)));
+    tx.items.reserve(limit);
+    for (size_t i = 0; i < limit; ++i) {
+        // ITEM|productID|productName|category|section|unitPrice|q0|q1|q2|q3|q4|q5|subtotal
+        string_view f[14];
+        if (splitFields(itemLines[i], '|', f, 14) != 13 || f[0] != "ITEM") continue;
+
+        TransactionItem item;
+        int cat, sec;
+        if (!parseField(f[1], item.productID) || !parseField(f[3], cat) ||
+            !parseField(f[4], sec) || !parseField(f[5], item.unitPrice) ||
+            !parseField(f[12], item.subtotal)) {
+            return nullopt;
+        }
+        for (int j = 0; j < 6; ++j) {
+            if (!parseField(f[6 + j], item.quantities[j])) return nullopt;
+        }
+        item.productName.assign(f[2]);
+        item.category = static_cast<Category>(cat);
+        item.section = static_cast<Section>(sec);
+        tx.items.push_back(std::move(item));
+    }
+    return tx;
 }
 
 // ==================== TransactionManager ====================
 
 TransactionManager::TransactionManager()
-    : userID(0), nextTransactionID(1) {}
+    : userID(0), store(&TransactionStore::instance()) {}
 
 TransactionManager::TransactionManager(int uID)
-    : userID(uID), nextTransactionID(1) {
-    loadFromFile();
+    : userID(uID), store(&TransactionStore::instance()) {
+    store->ensureLoaded();
+}
+
+TransactionManager::TransactionManager(int uID, TransactionStore& txStore)
+    : userID(uID), store(&txStore) {
+    store->ensureLoaded();
 }
 
 void TransactionManager::setUserID(int uID) {
+    // records are shared; switching user only changes the filter
     userID = uID;
-    // keep global nextTransactionID from file
-    transactions.clear();
-    loadFromFile();
+    store->ensureLoaded();
 }
 
-// Requirement: all records in one file
-string TransactionManager::getFileName() const {
-    return "TransactionRecord.txt";
-}
-
-string TransactionManager::getCurrentTimestamp() {
-    time_t now = time(nullptr);
-    tm* ltm = localtime(&now);
-
-    ostringstream oss;
-    oss << (1900 + ltm->tm_year) << "-"
-        << setfill('0') << setw(2) << (1 + ltm->tm_mon) << "-"
-        << setfill('0') << setw(2) << ltm->tm_mday << " "
-        << setfill('0') << setw(2) << ltm->tm_hour << ":"
-        << setfill('0') << setw(2) << ltm->tm_min << ":"
-        << setfill('0') << setw(2) << ltm->tm_sec;
-
-    return oss.str();
+const deque<Transaction>& TransactionManager::getAllTransactions() const {
+    return store->all();
 }
 
 // Requirement: Silver/Gold/Diamond (3 levels)
@@ -212,409 +308,374 @@ string TransactionManager::getLevelName(int level) {
 }
 
 bool TransactionManager::loadFromFile() {
-    transactions.clear();
-    nextTransactionID = 1;
-
-    ifstream fin(getFileName());
-    if (!fin.is_open()) {
-        return true; // first time
-    }
-
-    // First line: nextTransactionID (global)
-    string firstLine;
-    if (getline(fin, firstLine)) {
-        try {
-            nextTransactionID = stoi(firstLine);
-            if (nextTransactionID < 1) nextTransactionID = 1;
-        } catch (...) {
-            nextTransactionID = 1;
-        }
-    }
-
-    // Read all transaction records
-    string line;
-    vector<string> currentTxLines;
-
-    while (getline(fin, line)) {
-        if (line.empty()) continue;
-
-        if (line.rfind("TX|", 0) == 0) {
-            if (!currentTxLines.empty()) {
-                auto tx = Transaction::deserialize(currentTxLines);
-                if (tx.has_value()) transactions.push_back(*tx);
-                currentTxLines.clear();
-            }
-            currentTxLines.push_back(line);
-        } else if (line.rfind("ITEM|", 0) == 0) {
-            currentTxLines.push_back(line);
-        }
-    }
-
-    if (!currentTxLines.empty()) {
-        auto tx = Transaction::deserialize(currentTxLines);
-        if (tx.has_value()) transactions.push_back(*tx);
-    }
-
-    fin.close();
-    return true;
+    return store->reload();
 }
 
 bool TransactionManager::saveToFile() const {
-    ofstream fout(getFileName());
-    if (!fout.is_open()) {
-        cout << "Failed to open transaction file for writing: " << getFileName() << endl;
-        return false;
-    }
-
-    fout << nextTransactionID << "\n";
-    for (const auto& tx : transactions) fout << tx.serialize();
-
-    fout.close();
-    return true;
+    return store->save();
 }
 
-map<int, vector<pair<Size, int>>> TransactionManager::checkStock(
-    const ShoppingCart& cart, const ProductManager& pm) const {
+double TransactionManager::quote(const ShoppingCart& cart, const ProductManager& pm, int userLevel, bool isAdmin) {
+    return cart.calculateTotal(pm) * getDiscountRate(userLevel, isAdmin);
+}
 
-    map<int, vector<pair<Size, int>>> shortages;
+ShortageList TransactionManager::checkStock(const ShoppingCart& cart, const ProductManager& pm) const {
+    ShortageList shortages;
     const auto& cartItems = cart.getItems();
 
-    for (const auto& [productID, qtyVec] : cartItems) {
-        const Product* p = pm.getProduct(productID);
-        if (!p) {
-            vector<pair<Size, int>> itemShortages;
-            for (int i = 0; i < 6; ++i) {
-                int qty = (i < static_cast<int>(qtyVec.size())) ? qtyVec[i] : 0;
-                if (qty > 0) itemShortages.push_back({static_cast<Size>(i), qty});
-            }
-            if (!itemShortages.empty()) shortages[productID] = itemShortages;
-            continue;
-        }
+    for (const CartLine& line : cartItems) {
+        const Product* p = pm.getProduct(line.productID);
+        // all six sizes at once: the sizes wanted and the ones short of stock as bit masks;
+        // a product no longer in the catalog is short of everything wanted
+        StockVec want = StockVec(line.qty).clampNegative();
+        unsigned wanted = want.positiveMask();
+        StockVec missing = p ? want.shortage(p->getStockVec()) : want;
+        unsigned shortSizes = missing.positiveMask() & wanted;
+        if (shortSizes == 0) continue;
 
-        const auto& stock = p->getSizeStock();
         vector<pair<Size, int>> itemShortages;
-
         for (int i = 0; i < 6; ++i) {
-            int qty = (i < static_cast<int>(qtyVec.size())) ? qtyVec[i] : 0;
-            if (qty <= 0) continue;
-
-            int available = (i < static_cast<int>(stock.size())) ? stock[i] : 0;
-            if (qty > available) itemShortages.push_back({static_cast<Size>(i), qty - available});
+            if (shortSizes & (1u << i)) itemShortages.push_back({static_cast<Size>(i), missing.lane(i)});
         }
-
-        if (!itemShortages.empty()) shortages[productID] = itemShortages;
+        shortages[line.productID] = itemShortages;
     }
 
     return shortages;
 }
 
-bool TransactionManager::checkAndResolveStock(ShoppingCart& cart, ProductManager& pm) {
-    while (true) {
-        auto shortages = checkStock(cart, pm);
-
-        if (shortages.empty()) return true;
-
-        cout << "\n========== STOCK SHORTAGE ALERT ==========" << endl;
-        cout << "The following items have insufficient stock:" << endl;
-
-        for (const auto& [productID, itemShortages] : shortages) {
-            const Product* p = pm.getProduct(productID);
-            string productName = p ? p->getProductName() : "Unknown Product";
-
-            cout << "\nProduct ID: " << productID << " - " << productName << endl;
-
-            for (const auto& [size, shortage] : itemShortages) {
-                int available = 0;
-                if (p) {
-                    const auto& stock = p->getSizeStock();
-                    int idx = static_cast<int>(size);
-                    available = (idx < static_cast<int>(stock.size())) ? stock[idx] : 0;
+ShortageHandler TransactionManager::shortageHandler(ShortagePolicy policy, const ProductManager& pm) {
+    switch (policy) {
+        case ShortagePolicy::DropShort:
+            return [](ShoppingCart& cart, const ShortageList& shortages) {
+                for (const auto& [productID, itemShortages] : shortages) {
+                    for (const auto& [size, shortage] : itemShortages) cart.setQuantity(productID, size, 0);
                 }
-                cout << "  Size: " << sizeToString(size)
-                     << " - Short by: " << shortage
-                     << " (Available: " << available << ")" << endl;
-            }
-        }
-
-        cout << "\n============================================" << endl;
-        cout << "Please choose an option:" << endl;
-        cout << "1. Update item quantity" << endl;
-        cout << "2. Remove item from cart" << endl;
-        cout << "3. Cancel checkout" << endl;
-        cout << "Enter choice (1-3): ";
-
-        int choice;
-        if (!(cin >> choice)) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            cout << "Invalid input." << endl;
-            continue;
-        }
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');
-
-        switch (choice) {
-            case 1: {
-                cout << "Enter Product ID to update: ";
-                int updateID;
-                if (!(cin >> updateID)) {
-                    cin.clear();
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                    cout << "Invalid Product ID." << endl;
-                    continue;
+                return true;
+            };
+        case ShortagePolicy::TrimToStock:
+            return [&pm](ShoppingCart& cart, const ShortageList& shortages) {
+                for (const auto& [productID, itemShortages] : shortages) {
+                    const Product* p = pm.getProduct(productID);
+                    for (const auto& [size, shortage] : itemShortages) {
+                        cart.setQuantity(productID, size, p ? max(p->getStock(size), 0) : 0);
+                    }
                 }
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-
-                cart.updateItem(updateID, pm);
-                break;
-            }
-            case 2: {
-                cout << "Enter Product ID to remove: ";
-                int removeID;
-                if (!(cin >> removeID)) {
-                    cin.clear();
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                    cout << "Invalid Product ID." << endl;
-                    continue;
-                }
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                return true;
+            };
+        case ShortagePolicy::Reject:
+            break;
+    }
+    return nullptr;
+}
 
-                cart.removeItem(removeID);
+CheckoutStatus TransactionManager::checkout(ShoppingCart& cart, ProductManager& pm, int userLevel,
+                                            bool isAdmin, ShortagePolicy policy, Transaction* receipt) {
+    return checkout(cart, pm, userLevel, isAdmin, shortageHandler(policy, pm), receipt);
+}
 
-                if (cart.getItems().empty()) {
-                    cout << "Cart is now empty. Checkout cancelled." << endl;
-                    return false;
-                }
-                break;
-            }
-            case 3:
-                cout << "Checkout cancelled." << endl;
-                return false;
-            default:
-                cout << "Invalid choice. Please try again." << endl;
+CheckoutStatus TransactionManager::checkout(ShoppingCart& cart, ProductManager& pm, int userLevel,
+                                            bool isAdmin, const ShortageHandler& onShortage,
+                                            Transaction* receipt) {
+    // The purchase is tried first; the per-line shortage list is only worked out when a line
+    // could not be served. Bounded, so a handler that changes nothing cannot spin.
+    const int MAX_ATTEMPTS = 8;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        if (cart.getItems().empty()) return CheckoutStatus::EmptyCart;
+
+        CheckoutStatus status = commitCheckout(cart, pm, userLevel, isAdmin, receipt);
+        if (status == CheckoutStatus::Success || status == CheckoutStatus::NotSaved) {
+            cart.clearCart();
+            return status;
         }
+        // a product missing from the catalog is reported as a shortage of the whole line
+        if (status != CheckoutStatus::OutOfStock && status != CheckoutStatus::ProductNotFound) return status;
+
+        ShortageList shortages = checkStock(cart, pm);
+        if (shortages.empty()) continue;    // another checkout gave stock back meanwhile
+        if (!onShortage || !onShortage(cart, shortages)) return CheckoutStatus::OutOfStock;
     }
+    return CheckoutStatus::OutOfStock;
 }
 
-bool TransactionManager::processTransaction(ShoppingCart& cart, ProductManager& pm,
-                                            int userLevel, bool isAdmin) {
+bool TransactionManager::processTransaction(ShoppingCart& cart, ProductManager& pm, int userLevel,
+                                            bool isAdmin, const ShortageHandler& onShortage,
+                                            Transaction* receipt) {
     if (cart.getItems().empty()) {
         cout << "Transaction failed: Cart is empty." << endl;
         return false;
     }
 
-    // Ensure we have latest global records + nextTransactionID
-    loadFromFile();
-
-    if (!checkAndResolveStock(cart, pm)) {
-        return false;
-    }
-
-    const auto& cartItems = cart.getItems();
-
-    vector<TransactionItem> txItems;
-    double rawTotal = 0.0;
-
-    for (const auto& [productID, qtyVec] : cartItems) {
-        const Product* p = pm.getProduct(productID);
-        if (!p) {
-            cout << "Transaction failed: Product not found, ID=" << productID << endl;
+    Transaction newTx;
+    switch (checkout(cart, pm, userLevel, isAdmin, onShortage, &newTx)) {
+        case CheckoutStatus::Success:
+            break;
+        case CheckoutStatus::NotSaved:
+            cout << "Warning: transaction record could not be saved." << endl;
+            break;
+        case CheckoutStatus::EmptyCart:
+            cout << "Cart is empty. Checkout cancelled." << endl;
             return false;
-        }
-
-        int totalQty = accumulate(qtyVec.begin(), qtyVec.end(), 0);
-        if (totalQty <= 0) continue;
+        case CheckoutStatus::InvalidUser:
+            cout << "Transaction failed: invalid userID context." << endl;
+            return false;
+        case CheckoutStatus::ProductNotFound:
+            cout << "Transaction failed: Product not found." << endl;
+            return false;
+        case CheckoutStatus::OutOfStock:
+            cout << "Checkout cancelled: not enough stock." << endl;
+            return false;
+    }
 
-        TransactionItem item(
-            productID,
-            p->getProductName(),
-            p->getCategory(),
-            p->getSection(),
-            p->getPrice(),
-            qtyVec
-        );
+    // Keep your existing behavior (journals only the products this checkout changed)
+    pm.saveToFile("products.txt");
 
-        txItems.push_back(item);
-        rawTotal += item.subtotal;
-    }
+    cout << "\n========== TRANSACTION SUCCESSFUL ==========" << endl;
+    newTx.displayInvoice();
+    if (receipt) *receipt = std::move(newTx);
 
-    if (txItems.empty()) {
-        cout << "Transaction failed: No valid items to purchase." << endl;
-        return false;
-    }
+    cout << "Thank you for your purchase!" << endl;
+    cout << "Your member level: " << getLevelName(userLevel) << endl;
 
-    double rate = getDiscountRate(userLevel, isAdmin);
-    double finalTotal = rawTotal * rate;
+    return true;
+}
 
-    // Deduct stock
-    for (const auto& [productID, qtyVec] : cartItems) {
-        Product* p = pm.getProduct(productID);
-        if (!p) continue;
+CheckoutStatus TransactionManager::commitCheckout(const ShoppingCart& cart, ProductManager& pm,
+                                                 int userLevel, bool isAdmin,
+                                                 Transaction* receipt) {
+    // IMPORTANT: record actual userID in TX (for global file filtering)
+    if (userID <= 0) return CheckoutStatus::InvalidUser;
 
-        for (int i = 0; i < 6; ++i) {
-            int qty = (i < static_cast<int>(qtyVec.size())) ? qtyVec[i] : 0;
-            if (qty <= 0) continue;
+    vector<TransactionItem> txItems;
+    txItems.reserve(cart.getItems().size());
+    double rawTotal = 0.0;
 
-            if (!p->updateStock(static_cast<Size>(i), -qty)) {
-                cout << "Transaction failed: Stock deduction error. ProductID="
-                     << productID << endl;
-                return false;
-            }
+    // give back the stock of the lines taken before a failing one
+    auto rollback = [&]() {
+        for (const TransactionItem& item : txItems) {
+            SizeStock qty;
+            copy_n(item.quantities.begin(), 6, qty.begin());
+            pm.releaseStock(item.productID, qty);
         }
-    }
+    };
 
-    string timestamp = getCurrentTimestamp();
+    // One pass: resolve each product once, take all six sizes of the line, add its receipt line
+    for (const CartLine& line : cart.getItems()) {
+        StockVec want = StockVec(line.qty).clampNegative();
+        if (want.positiveMask() == 0) continue;
+        SizeStock qty = want.toArray();
 
-    // IMPORTANT: record actual userID in TX (for global file filtering)
-    int realUserID = userID;
-    if (realUserID <= 0) {
-        cout << "Transaction failed: invalid userID context." << endl;
-        return false;
+        // const lookup: a missing product is reported through the status, not printed
+        const Product* p = static_cast<const ProductManager&>(pm).getProduct(line.productID);
+        if (!p) {
+            rollback();
+            return CheckoutStatus::ProductNotFound;
+        }
+        // compare-and-swap per size: fails instead of going negative if another
+        // checkout took the stock meanwhile
+        if (!pm.reserveStock(line.productID, qty)) {
+            rollback();
+            return CheckoutStatus::OutOfStock;
+        }
+        txItems.emplace_back(line.productID, p->getProductName(), p->getCategory(),
+                             p->getSection(), p->getPrice(), qty);
+        rawTotal += txItems.back().subtotal;
     }
 
-    Transaction newTx(nextTransactionID, realUserID, txItems, rawTotal,
-                      rate, finalTotal, timestamp, userLevel);
-
-    transactions.push_back(newTx);
-    nextTransactionID++;
+    if (txItems.empty()) return CheckoutStatus::EmptyCart;
+    // every line is taken: only now journal the changed stock (a rolled-back attempt changes nothing)
+    for (const TransactionItem& item : txItems) pm.markDirty(item.productID);
 
-    saveToFile();
+    double rate = getDiscountRate(userLevel, isAdmin);
+    Transaction newTx(0, userID, std::move(txItems), rawTotal, rate, rawTotal * rate,
+                      Transaction::currentEpoch(), userLevel);
 
-    // Keep your existing behavior
-    pm.saveToFile("products.txt");
+    // the store assigns the ID and appends only this record to TransactionRecord.txt
+    bool saved = store->appendNew(newTx);
+    if (receipt) *receipt = std::move(newTx);
+    return saved ? CheckoutStatus::Success : CheckoutStatus::NotSaved;
+}
 
-    cout << "\n========== TRANSACTION SUCCESSFUL ==========" << endl;
-    newTx.displayInvoice();
+// Visit the records this manager may see: the user's own list from the store's index,
+// or everything for the admin view. Caller holds a ReadGuard.
+template <typename Visit>
+void TransactionManager::forEachTx(Visit&& visit) const {
+    if (userID == -1) {
+        for (const auto& tx : store->all()) visit(tx);
+        return;
+    }
+    for (uint32_t pos : store->positionsOf(userID)) visit(store->at(pos));
+}
 
-    cart.clearCart();
+int TransactionManager::getTransactionCount() const {
+    return store->statsOf(userID).count;
+}
 
-    cout << "Thank you for your purchase!" << endl;
-    cout << "Your member level: " << getLevelName(userLevel) << endl;
+void TransactionManager::displayAllTransactions() const {
+    ConsoleSink sink;
+    displayAllTransactions(sink.stream());
+}
 
-    return true;
+void TransactionManager::displayTransactionSummary() const {
+    ConsoleSink sink;
+    displayTransactionSummary(sink.stream());
 }
 
-int TransactionManager::getTransactionCount() const {
-    int cnt = 0;
-    for (const auto& tx : transactions) if (allowTx(tx)) cnt++;
-    return cnt;
+void TransactionManager::displayTransaction(int transactionID) const {
+    ConsoleSink sink;
+    displayTransaction(transactionID, sink.stream());
 }
 
-void TransactionManager::displayAllTransactions() const {
+void TransactionManager::displayAllTransactions(ostream& out) const {
+    TransactionStore::ReadGuard guard(*store);
     int cnt = getTransactionCount();
     if (cnt == 0) {
-        if (userID == -1) cout << "\nNo transaction records found.\n";
-        else cout << "\nNo transaction records found for User ID: " << userID << endl;
+        if (userID == -1) out << "\nNo transaction records found.\n";
+        else out << "\nNo transaction records found for User ID: " << userID << '\n';
         return;
     }
 
-    cout << "\n================================================================" << endl;
+    out << "\n================================================================\n";
     if (userID == -1)
-        cout << "               ALL TRANSACTION RECORDS (ADMIN)                  " << endl;
+        out << "               ALL TRANSACTION RECORDS (ADMIN)                  \n";
     else
-        cout << "       ALL TRANSACTION RECORDS - User ID: " << userID << endl;
-    cout << "================================================================" << endl;
-
-    for (const auto& tx : transactions) {
-        if (!allowTx(tx)) continue;
-        tx.displayInvoice();
-        cout << endl;
-    }
-
-    cout << "================================================================" << endl;
-    cout << "                        STATISTICS                              " << endl;
-    cout << "================================================================" << endl;
-    cout << "  Total Transactions: " << getTransactionCount() << endl;
-    cout << "  Total Spent:        $" << fixed << setprecision(2) << getTotalSpent() << endl;
-    cout << "  Average per Order:  $" << fixed << setprecision(2) << getAverageSpent() << endl;
-    cout << "================================================================" << endl;
+        out << "       ALL TRANSACTION RECORDS - User ID: " << userID << '\n';
+    out << "================================================================\n";
+
+    forEachTx([&out](const Transaction& tx) {
+        tx.displayInvoice(out);
+        out << '\n';
+    });
+
+    out << "================================================================\n";
+    out << "                        STATISTICS                              \n";
+    out << "================================================================\n";
+    out << "  Total Transactions: " << getTransactionCount() << '\n';
+    out << "  Total Spent:        $" << fixed << setprecision(2) << getTotalSpent() << '\n';
+    out << "  Average per Order:  $" << fixed << setprecision(2) << getAverageSpent() << '\n';
+    out << "================================================================\n";
 }
 
-void TransactionManager::displayTransactionSummary() const {
+void TransactionManager::displayTransactionSummary(ostream& out) const {
+    TransactionStore::ReadGuard guard(*store);
     int cnt = getTransactionCount();
     if (cnt == 0) {
-        cout << "\nNo transaction records found." << endl;
+        out << "\nNo transaction records found.\n";
         return;
     }
 
     if (userID == -1)
-        cout << "\n======== TRANSACTION SUMMARY (ADMIN - ALL USERS) ========\n";
+        out << "\n======== TRANSACTION SUMMARY (ADMIN - ALL USERS) ========\n";
     else
-        cout << "\n======== TRANSACTION SUMMARY - User ID: " << userID << " ========\n";
-
-    cout << left << setw(8) << "TX ID"
-         << setw(8) << "UID"
-         << setw(22) << "Date/Time"
-         << setw(8) << "Items"
-         << setw(12) << "Raw Total"
-         << setw(10) << "Discount"
-         << setw(12) << "Final" << endl;
-    cout << string(80, '-') << endl;
-
-    for (const auto& tx : transactions) {
-        if (!allowTx(tx)) continue;
-        cout << left << setw(8) << tx.getTransactionID()
-             << setw(8) << tx.getUserID()
-             << setw(22) << tx.getTimestamp()
-             << setw(8) << tx.getItems().size()
-             << "$" << setw(11) << fixed << setprecision(2) << tx.getRawTotal()
-             << setw(10) << fixed << setprecision(0) << (tx.getDiscountRate() * 100) << "%"
-             << "$" << setw(11) << fixed << setprecision(2) << tx.getFinalTotal() << endl;
-    }
-
-    cout << string(80, '-') << endl;
-    cout << "Total Transactions: " << getTransactionCount()
-         << " | Total Spent: $" << fixed << setprecision(2) << getTotalSpent() << endl;
+        out << "\n======== TRANSACTION SUMMARY - User ID: " << userID << " ========\n";
+
+    out << left << setw(8) << "TX ID"
+        << setw(8) << "UID"
+        << setw(22) << "Date/Time"
+        << setw(8) << "Items"
+        << setw(12) << "Raw Total"
+        << setw(10) << "Discount"
+        << setw(12) << "Final" << '\n';
+    out << string(80, '-') << '\n';
+
+    forEachTx([&out](const Transaction& tx) {
+        out << left << setw(8) << tx.getTransactionID()
+            << setw(8) << tx.getUserID()
+            << setw(22) << tx.getTimestamp()
+            << setw(8) << tx.getItems().size()
+            << "$" << setw(11) << fixed << setprecision(2) << tx.getRawTotal()
+            << setw(10) << fixed << setprecision(0) << (tx.getDiscountRate() * 100) << "%"
+            << "$" << setw(11) << fixed << setprecision(2) << tx.getFinalTotal() << '\n';
+    });
+
+    out << string(80, '-') << '\n';
+    out << "Total Transactions: " << getTransactionCount()
+        << " | Total Spent: $" << fixed << setprecision(2) << getTotalSpent() << '\n';
 }
 
 const Transaction* TransactionManager::findTransaction(int transactionID) const {
-    for (const auto& tx : transactions) {
-        if (!allowTx(tx)) continue;
-        if (tx.getTransactionID() == transactionID) return &tx;
+    TransactionStore::ReadGuard guard(*store);
+    const Transaction* tx = store->findByID(transactionID);
+    if (!tx || allowTx(*tx)) return tx;
+    // the ID belongs to someone else; only a duplicated ID (edited file) can still match here
+    if (!store->hasDuplicateIDs()) return nullptr;
+    for (uint32_t pos : store->positionsOf(userID)) {
+        if (store->at(pos).getTransactionID() == transactionID) return &store->at(pos);
     }
     return nullptr;
 }
 
-void TransactionManager::displayTransaction(int transactionID) const {
+void TransactionManager::displayTransaction(int transactionID, ostream& out) const {
     const Transaction* tx = findTransaction(transactionID);
-    if (tx) tx->displayInvoice();
-    else cout << "Transaction ID " << transactionID << " not found." << endl;
+    if (tx) tx->displayInvoice(out);
+    else out << "Transaction ID " << transactionID << " not found.\n";
 }
 
 vector<const Transaction*> TransactionManager::findByDateRange(
     const string& startDate, const string& endDate) const {
+    int64_t from, to;
+    if (!Transaction::parseTimestamp(startDate, from) || !Transaction::parseTimestamp(endDate, to, true)) {
+        cout << "Invalid date. Please use YYYY-MM-DD or YYYY-MM-DD HH:MM[:SS]." << endl;
+        return {};
+    }
+    return findByTimeRange(from, to);
+}
+
+vector<const Transaction*> TransactionManager::findByTimeRange(int64_t fromEpoch, int64_t toEpoch) const {
+    return store->findByTime(fromEpoch, toEpoch, userID);  // -1 (admin) = every user
+}
+
+vector<const Transaction*> TransactionManager::getPage(int afterTxID, size_t limit) const {
+    return store->pageAfter(afterTxID, limit, userID);  // -1 (admin) = every user
+}
+
+vector<const Transaction*> TransactionManager::findByAmountRange(
+    double minAmount, double maxAmount) const {
+    TransactionStore::ReadGuard guard(*store);
 
     vector<const Transaction*> result;
-    for (const auto& tx : transactions) {
-        if (!allowTx(tx)) continue;
-        string txDate = tx.getTimestamp().substr(0, 10);
-        if (txDate >= startDate && txDate <= endDate) result.push_back(&tx);
+    for (uint32_t pos : store->amountIndexOf(userID).positionsInRange(minAmount, maxAmount)) {
+        result.push_back(&store->at(pos));
     }
     return result;
 }
 
-vector<const Transaction*> TransactionManager::findByAmountRange(
-    double minAmount, double maxAmount) const {
+int TransactionManager::countByAmountRange(double minAmount, double maxAmount) const {
+    TransactionStore::ReadGuard guard(*store);
+    return static_cast<int>(store->amountIndexOf(userID).countInRange(minAmount, maxAmount));
+}
+
+vector<const Transaction*> TransactionManager::getTopOrders(int n) const {
+    TransactionStore::ReadGuard guard(*store);
 
     vector<const Transaction*> result;
-    for (const auto& tx : transactions) {
-        if (!allowTx(tx)) continue;
-        double amount = tx.getFinalTotal();
-        if (amount >= minAmount && amount <= maxAmount) result.push_back(&tx);
+    if (n <= 0) return result;
+    for (uint32_t pos : store->amountIndexOf(userID).topPositions(static_cast<size_t>(n))) {
+        result.push_back(&store->at(pos));
     }
     return result;
 }
 
+double TransactionManager::getOrderPercentile(double percentile) const {
+    TransactionStore::ReadGuard guard(*store);
+    const AmountIndex& index = store->amountIndexOf(userID);
+    if (index.empty()) return 0.0;
+
+    // nearest rank: the smallest value with at least percentile% of the orders at or below it
+    percentile = max(0.0, min(100.0, percentile));
+    size_t count = index.size();
+    size_t rank = static_cast<size_t>(ceil(percentile / 100.0 * static_cast<double>(count)));
+    rank = max<size_t>(rank, 1);
+    return index.amountAt(min(rank, count) - 1);
+}
+
 double TransactionManager::getTotalSpent() const {
-    double total = 0.0;
-    for (const auto& tx : transactions) {
-        if (!allowTx(tx)) continue;
-        total += tx.getFinalTotal();
-    }
-    return total;
+    return store->statsOf(userID).total;
 }
 
 double TransactionManager::getAverageSpent() const {
-    int cnt = getTransactionCount();
-    if (cnt == 0) return 0.0;
-    return getTotalSpent() / static_cast<double>(cnt);
+    return store->statsOf(userID).average();
+}
+
+TransactionStats TransactionManager::getStats() const {
+    return store->statsOf(userID);
 }
@@ -1,10 +1,16 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include <iosfwd>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <deque>
 #include <map>
 #include <optional>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
 #include <ctime>
 
 #include "Product.h"
@@ -26,6 +32,8 @@ struct TransactionItem {
     TransactionItem();
     TransactionItem(int id, const string& name, Category cat, Section sec,
                     double price, const vector<int>& qtys);
+    TransactionItem(int id, const string& name, Category cat, Section sec,
+                    double price, const SizeStock& qty);
 };
 
 // Complete transaction record
@@ -37,14 +45,16 @@ private:
     double rawTotal;                // original total price
     double discountRate;            // discount rate (0.0-1.0)
     double finalTotal;              // final price after discount
-    string timestamp;               // transaction timestamp
+    int64_t epoch;                  // transaction time: seconds since 1970-01-01 00:00:00 (clock time as recorded, no time zone)
     int userLevel;                  // user level at time of transaction
 
 public:
     // Constructors
     Transaction();
-    Transaction(int txID, int uID, const vector<TransactionItem>& itms,
+    Transaction(int txID, int uID, vector<TransactionItem> itms,
                 double raw, double rate, double final_, const string& time, int level);
+    Transaction(int txID, int uID, vector<TransactionItem> itms,
+                double raw, double rate, double final_, int64_t time, int level);
 
     // Getters
     int getTransactionID() const { return transactionID; }
@@ -53,31 +63,93 @@ public:
     double getRawTotal() const { return rawTotal; }
     double getDiscountRate() const { return discountRate; }
     double getFinalTotal() const { return finalTotal; }
-    string getTimestamp() const { return timestamp; }
+    string getTimestamp() const { return formatTimestamp(epoch); }  // "YYYY-MM-DD HH:MM:SS"
+    int64_t getEpoch() const { return epoch; }
     int getUserLevel() const { return userLevel; }
 
-    // Display transaction details (invoice format)
+    // IDs are handed out by TransactionStore when the record is stored
+    void setTransactionID(int txID) { transactionID = txID; }
+
+    // Display transaction details (invoice format) on the console, or write them to out
     void displayInvoice() const;
+    void displayInvoice(ostream& out) const;
+
+    // "YYYY-MM-DD[ HH:MM[:SS]]" -> seconds since 1970-01-01 00:00:00. Missing time parts are 0,
+    // or their largest value when roundUp is set (so "2025-12-08" as an end bound covers the day).
+    // Returns false if text is not such a timestamp.
+    static bool parseTimestamp(string_view text, int64_t& epochOut, bool roundUp = false);
+    static string formatTimestamp(int64_t epochValue);
+    static int64_t epochOf(int year, int month, int day, int hour, int minute, int second);
+    static int64_t currentEpoch();  // local clock time now, on the epochOf scale
 
     // Serialization/deserialization (for file I/O)
     string serialize() const;
     static optional<Transaction> deserialize(const vector<string>& lines);
+    // Same as deserialize(), parsing a TX| line and the ITEM| lines after it in place
+    static optional<Transaction> parse(string_view header, const vector<string_view>& itemLines);
+};
+
+class TransactionStore;
+
+// Outcome of the non-interactive checkout (TransactionManager::commitCheckout)
+enum class CheckoutStatus {
+    Success,
+    EmptyCart,          // nothing to buy
+    InvalidUser,        // manager has no user context
+    ProductNotFound,    // a cart line refers to a missing product
+    OutOfStock,         // some size ran short; no stock was taken
+    NotSaved            // purchase done in memory, but the record could not be written
+};
+
+static string checkoutStatusToString(CheckoutStatus status) {
+    switch (status) {
+        case CheckoutStatus::Success: return "Success";
+        case CheckoutStatus::EmptyCart: return "No valid items to purchase";
+        case CheckoutStatus::InvalidUser: return "Invalid userID context";
+        case CheckoutStatus::ProductNotFound: return "Product not found";
+        case CheckoutStatus::OutOfStock: return "Not enough stock";
+        case CheckoutStatus::NotSaved: return "Transaction record could not be saved";
+    }
+    return "Unknown";
+}
+
+// Cart lines that cannot be served: productID -> (size, units missing)
+using ShortageList = map<int, vector<pair<Size, int>>>;
+
+// Called by TransactionManager::checkout when the cart asks for more than is in stock.
+// It may change the cart (the stock check is then repeated) or return false to give up.
+using ShortageHandler = function<bool(ShoppingCart& cart, const ShortageList& shortages)>;
+
+// Built-in shortage handlers (TransactionManager::shortageHandler)
+enum class ShortagePolicy {
+    Reject,         // give up: checkout returns OutOfStock, cart unchanged
+    DropShort,      // remove the short lines (product + size), buy the rest
+    TrimToStock     // lower short lines to what is available, buy that
 };
 
-// Transaction manager (handles all transactions; userID used for filtering/display)
+// Running totals over a set of transactions (one user, or all of them)
+struct TransactionStats {
+    int count = 0;
+    double total = 0.0;         // sum of final totals
+    double minAmount = 0.0;     // smallest / largest final total (0 if count == 0)
+    double maxAmount = 0.0;
+
+    void add(double amount) {
+        minAmount = count == 0 ? amount : min(minAmount, amount);
+        maxAmount = count == 0 ? amount : max(maxAmount, amount);
+        total += amount;
+        ++count;
+    }
+    double average() const { return count == 0 ? 0.0 : total / count; }
+};
+
+// Transaction manager: a lightweight view over the shared TransactionStore
 // userID >= 1 : user view (filter own records)
 // userID == -1: admin view (no filter)
 class TransactionManager {
 private:
     int userID;                         // current user context (or -1 for admin)
-    int nextTransactionID;              // next transaction ID (global)
-    vector<Transaction> transactions;   // all loaded transaction records
-
-    // Global transaction record file name (requirement)
-    string getFileName() const;
-
-    // Get current timestamp string
-    static string getCurrentTimestamp();
+    TransactionStore* store;            // shared records (not owned)
 
     // Get discount rate based on user level (Silver/Gold/Diamond only)
     static double getDiscountRate(int level, bool isAdmin);
@@ -89,55 +161,99 @@ private:
         return (userID == -1) || (tx.getUserID() == userID);
     }
 
+    // Call visit(tx) for each visible record via the store's per-user index (O(own history))
+    template <typename Visit>
+    void forEachTx(Visit&& visit) const;
+
 public:
-    // Constructors
+    // Constructors (bind to TransactionStore::instance() unless a store is given)
     TransactionManager();
     explicit TransactionManager(int uID);
+    TransactionManager(int uID, TransactionStore& txStore);
 
     // Set user ID context
     void setUserID(int uID);
     int getUserID() const { return userID; }
 
-    // File I/O
+    // File I/O (reload / rewrite the shared store)
     bool loadFromFile();
     bool saveToFile() const;
 
     // Check if stock is sufficient, return shortage info
     // Returns: map<productID, vector<pair<size, shortage>>>
-    map<int, vector<pair<Size, int>>> checkStock(const ShoppingCart& cart,
-                                                 const ProductManager& pm) const;
+    ShortageList checkStock(const ShoppingCart& cart, const ProductManager& pm) const;
+
+    // What checking out the cart would cost at this level (discount applied), at current prices.
+    // O(1) while the cart's cached total is current. No stock check, no output.
+    static double quote(const ShoppingCart& cart, const ProductManager& pm, int userLevel, bool isAdmin);
 
-    // Check and resolve stock issues (interactive)
-    // Returns true if checkout can proceed, false if user cancels
-    bool checkAndResolveStock(ShoppingCart& cart, ProductManager& pm);
+    // Handler implementing one of the built-in shortage policies
+    static ShortageHandler shortageHandler(ShortagePolicy policy, const ProductManager& pm);
 
-    // Process transaction (checkout)
-    bool processTransaction(ShoppingCart& cart, ProductManager& pm,
-                            int userLevel, bool isAdmin);
+    // Checkout without any console I/O: the purchase is committed as in commitCheckout. If a line
+    // cannot be served, the shortages (checkStock) go to onShortage (empty handler = Reject) and
+    // the purchase is tried again with the adjusted cart.
+    // On Success / NotSaved the cart is cleared and receipt (optional) gets the stored record.
+    CheckoutStatus checkout(ShoppingCart& cart, ProductManager& pm, int userLevel, bool isAdmin,
+                            const ShortageHandler& onShortage, Transaction* receipt = nullptr);
+    CheckoutStatus checkout(ShoppingCart& cart, ProductManager& pm, int userLevel, bool isAdmin,
+                            ShortagePolicy policy, Transaction* receipt = nullptr);
 
-    // Display (filtered by userID unless admin)
+    // Process transaction (checkout) and report it on the console: status messages, invoice,
+    // product file update. Returns true if the purchase went through.
+    bool processTransaction(ShoppingCart& cart, ProductManager& pm, int userLevel, bool isAdmin,
+                            const ShortageHandler& onShortage, Transaction* receipt = nullptr);
+
+    // Checkout without any console I/O; the cart is left unchanged. One pass over the cart
+    // resolves each product once, reserves its sizes and builds the receipt line.
+    // Stock for every line is reserved atomically (all lines or none), so many threads can
+    // check out against the same ProductManager and store without overselling, as long as
+    // products are not added or removed meanwhile. receipt (optional) gets the stored record.
+    CheckoutStatus commitCheckout(const ShoppingCart& cart, ProductManager& pm,
+                                  int userLevel, bool isAdmin, Transaction* receipt = nullptr);
+
+    // Display (filtered by userID unless admin). The console versions render through one
+    // buffered sink; the ostream versions write to out ('\n' line ends, no flushing).
     void displayAllTransactions() const;
     void displayTransactionSummary() const;
+    void displayAllTransactions(ostream& out) const;
+    void displayTransactionSummary(ostream& out) const;
 
     // Find (filtered by userID unless admin)
     const Transaction* findTransaction(int transactionID) const;
     void displayTransaction(int transactionID) const;
+    void displayTransaction(int transactionID, ostream& out) const;
 
-    // Find transactions by date range (filtered by userID unless admin)
+    // Find transactions by date range (filtered by userID unless admin), oldest first.
+    // Bounds are "YYYY-MM-DD" (whole days, inclusive) or "YYYY-MM-DD HH:MM[:SS]".
     vector<const Transaction*> findByDateRange(const string& startDate,
                                                const string& endDate) const;
+    // Same with epoch bounds (inclusive); binary search on the store's time index
+    vector<const Transaction*> findByTimeRange(int64_t fromEpoch, int64_t toEpoch) const;
+
+    // Next page of up to limit transactions after the one with ID afterTxID (0 = first page),
+    // filtered by userID unless admin, in the stable order records were stored in; pass the
+    // last ID of a page to get the next one. O(log n + limit), however long the history is.
+    vector<const Transaction*> getPage(int afterTxID, size_t limit) const;
 
-    // Find transactions by amount range (filtered by userID unless admin)
+    // Find transactions by amount range (filtered by userID unless admin), smallest amount first
     vector<const Transaction*> findByAmountRange(double minAmount,
                                                  double maxAmount) const;
+    // Number of orders with minAmount <= final total <= maxAmount, without listing them
+    int countByAmountRange(double minAmount, double maxAmount) const;
+    // The n largest orders, largest first
+    vector<const Transaction*> getTopOrders(int n) const;
+    // Order value at the given percentile (0-100, nearest rank: 50 = median); 0 if no orders
+    double getOrderPercentile(double percentile) const;
 
-    // Stats (filtered by userID unless admin)
+    // Stats (filtered by userID unless admin); kept up to date by the store, O(1)
     int getTransactionCount() const;
     double getTotalSpent() const;
     double getAverageSpent() const;
+    TransactionStats getStats() const;
 
     // Get all transactions (read-only; NOTE: contains all loaded txs)
-    const vector<Transaction>& getAllTransactions() const { return transactions; }
+    const deque<Transaction>& getAllTransactions() const;
 };
 
 #endif // TRANSACTION_H
\ No newline at end of file
@@ -0,0 +1,800 @@
+#include "TransactionStore.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+TransactionStore::TransactionStore(string file)
+    : fileName(std::move(file)), loaded(false), nextTransactionID(1),
+      timeSortPending(false), duplicateIDs(false), skippedRecords(0), loadThreads(0), appendSeq(0),
+      logMode(LogMode::Append), durability(Durability::None), groupCommitMicros(0),
+      headerID(1), pendingNextID(1), enqueuedTicket(0), durableTicket(0),
+      logDamaged(false), flushing(false), loggedSeq(0) {}
+
+TransactionStore& TransactionStore::instance() {
+    static TransactionStore store;
+    return store;
+}
+
+// ==================== ReadGuard ====================
+
+namespace {
+    thread_local const TransactionStore* readLockedStore = nullptr;
+}
+
+TransactionStore::ReadGuard::ReadGuard(const TransactionStore& txStore)
+    : store(&txStore), previous(readLockedStore), owns(readLockedStore != &txStore) {
+    if (owns) {
+        store->stateMutex.lock_shared();
+        readLockedStore = store;
+    }
+}
+
+TransactionStore::ReadGuard::~ReadGuard() {
+    if (owns) {
+        readLockedStore = previous;
+        store->stateMutex.unlock_shared();
+    }
+}
+
+// ==================== TransactionStore ====================
+
+bool TransactionStore::ensureLoaded() {
+    if (loaded) return true;
+    return reload();
+}
+
+// Parse the TX|/ITEM| blocks in text into out, in file order. text starts at a TX| line
+// (or at the first record); ITEM| lines before the first TX| are ignored.
+static void parseRecords(string_view text, vector<Transaction>& out, size_t& skipped) {
+    LineReader lines(text);
+    string_view line, header;
+    vector<string_view> itemLines;
+    bool inTx = false;
+
+    auto finish = [&]() {
+        if (inTx) {
+            auto tx = Transaction::parse(header, itemLines);
+            if (tx.has_value()) out.push_back(std::move(*tx));
+            else ++skipped;
+        }
+        itemLines.clear();
+    };
+
+    while (lines.next(line)) {
+        if (line.empty()) continue;
+
+        if (line.substr(0, 3) == "TX|") {
+            finish();
+            header = line;
+            inTx = true;
+        } else if (line.substr(0, 5) == "ITEM|") {
+            if (inTx) itemLines.push_back(line);
+        }
+    }
+    finish();
+}
+
+// Split text into about `parts` pieces that each start at a TX| line
+static vector<string_view> splitAtRecords(string_view text, int parts) {
+    vector<string_view> chunks;
+    size_t begin = 0;
+    for (int k = 1; k < parts; ++k) {
+        size_t target = text.size() / parts * k;
+        if (target <= begin) continue;
+        size_t pos = text.find("\nTX|", target);
+        if (pos == string_view::npos) break;
+        chunks.push_back(text.substr(begin, pos + 1 - begin));
+        begin = pos + 1;
+    }
+    chunks.push_back(text.substr(begin));
+    return chunks;
+}
+
+bool TransactionStore::reload() {
+    unique_lock<shared_mutex> state(stateMutex);
+    {
+        lock_guard<mutex> log(logMutex);
+        logFile.close();
+    }
+    transactions.clear();
+    clearIndexesLocked();
+    nextTransactionID = 1;
+    skippedRecords = 0;
+    loaded = true;
+
+    bool fixedHeader = false;
+    string records;     // the file's records as written, kept for the header upgrade below
+    {
+        MappedFile file;    // parsed in place, no per-line copies
+        if (!file.open(fileName)) {
+            headerID = pendingNextID = 1;
+            return true; // first time
+        }
+        string_view text = file.view();
+
+        // First line: nextTransactionID (global)
+        size_t newline = text.find('\n');
+        string_view firstLine = text.substr(0, newline);
+        if (!firstLine.empty() && firstLine.back() == '\r') firstLine.remove_suffix(1);
+        if (!text.empty()) {
+            fixedHeader = firstLine.size() == HEADER_WIDTH &&
+                          all_of(firstLine.begin(), firstLine.end(), ::isdigit);
+            if (!parseField(firstLine, nextTransactionID) || nextTransactionID < 1) {
+                nextTransactionID = 1;
+            }
+        }
+        string_view body = newline == string_view::npos ? string_view() : text.substr(newline + 1);
+
+        // Read all transaction records; big files are split at TX| lines and parsed in parallel
+        int threads = loadThreads > 0 ? loadThreads : static_cast<int>(thread::hardware_concurrency());
+        if (body.size() < PARALLEL_LOAD_MIN_BYTES) threads = 1;
+        vector<string_view> chunks = splitAtRecords(body, max(threads, 1));
+        vector<vector<Transaction>> parsed(chunks.size());
+        vector<size_t> skipped(chunks.size(), 0);
+        vector<thread> workers;
+        for (size_t k = 1; k < chunks.size(); ++k) {
+            workers.emplace_back(parseRecords, chunks[k], ref(parsed[k]), ref(skipped[k]));
+        }
+        parseRecords(chunks[0], parsed[0], skipped[0]);
+        for (auto& w : workers) w.join();
+
+        for (auto& part : parsed) {
+            for (auto& tx : part) transactions.push_back(std::move(tx));
+        }
+        for (size_t n : skipped) skippedRecords += n;
+        if (!fixedHeader) records.assign(body.data(), body.size());
+    }
+    if (skippedRecords > 0) {
+        cout << "Skipped " << skippedRecords << " unreadable transaction record(s) in " << fileName
+             << "; they are kept in the file" << endl;
+    }
+
+    indexAllLocked();
+
+    // one-time upgrade of files written with a variable-width header
+    if (!fixedHeader) return upgradeHeaderLocked(records);
+    return true;
+}
+
+// Caller holds stateMutex exclusively. Only the header line is replaced: the records are
+// written back byte for byte, including any the loader skipped as malformed.
+bool TransactionStore::upgradeHeaderLocked(const string& records) {
+    lock_guard<mutex> log(logMutex);
+    logFile.close();
+
+    ofstream fout(fileName, ios::binary);
+    if (!fout.is_open()) {
+        cout << "Failed to open transaction file for writing: " << fileName << endl;
+        return false;
+    }
+
+    char header[32];
+    snprintf(header, sizeof(header), "%0*d\n", HEADER_WIDTH, nextTransactionID);
+    fout << header;
+    fout.write(records.data(), static_cast<streamsize>(records.size()));
+    if (!records.empty() && records.back() != '\n') fout << '\n';  // keep later appends on their own line
+
+    fout.close();
+    if (!fout) {
+        cout << "Failed to write transaction file: " << fileName << endl;
+        return false;
+    }
+    headerID = pendingNextID = nextTransactionID;
+    logDamaged = false;     // records now end on a line boundary again
+    return true;
+}
+
+void TransactionStore::adopt(deque<Transaction> records, int nextID, const vector<uint32_t>* amountOrder) {
+    unique_lock<shared_mutex> state(stateMutex);
+    {
+        lock_guard<mutex> log(logMutex);
+        logFile.close();
+    }
+    transactions = std::move(records);
+    clearIndexesLocked();
+    nextTransactionID = max(nextID, 1);
+    loaded = true;
+    indexAllLocked(amountOrder);
+}
+
+// Caller holds stateMutex exclusively
+void TransactionStore::indexAllLocked(const vector<uint32_t>* amountOrder) {
+    // The header is written after the appended block, so after a crash it can lag
+    // behind the records; never hand out an ID that is already in the file.
+    posByID.reserve(transactions.size() + 1);
+    byTime.reserve(transactions.size());
+    for (size_t pos = 0; pos < transactions.size(); ++pos) {
+        nextTransactionID = max(nextTransactionID, transactions[pos].getTransactionID() + 1);
+        indexLocked(static_cast<uint32_t>(pos), true);
+    }
+    sortTimeIndexLocked();
+    buildAmountIndexesLocked(amountOrder);
+    headerID = pendingNextID = nextTransactionID;
+}
+
+// ==================== AmountIndex ====================
+
+// Node priorities come from a hash of the node number, so the tree shape is reproducible
+static uint32_t treapPriority(uint32_t n) {
+    uint32_t h = n * 0x9E3779B9u + 0x7F4A7C15u;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    return h ^ (h >> 16);
+}
+
+void AmountIndex::clear() {
+    nodes.clear();
+    root = NIL;
+}
+
+// less = entries ordered before (amount, pos), rest = the others
+void AmountIndex::split(uint32_t t, double amount, uint32_t pos, uint32_t& less, uint32_t& rest) {
+    if (t == NIL) {
+        less = rest = NIL;
+        return;
+    }
+    if (!keyLess(amount, pos, nodes[t])) {
+        // node t sorts before the key (keys are unique): it and its left subtree go to `less`
+        split(nodes[t].right, amount, pos, nodes[t].right, rest);
+        less = t;
+    } else {
+        split(nodes[t].left, amount, pos, less, nodes[t].left);
+        rest = t;
+    }
+    update(t);
+}
+
+uint32_t AmountIndex::insertAt(uint32_t t, uint32_t n) {
+    if (t == NIL) return n;
+    if (nodes[n].priority > nodes[t].priority) {
+        split(t, nodes[n].amount, nodes[n].pos, nodes[n].left, nodes[n].right);
+        update(n);
+        return n;
+    }
+    if (keyLess(nodes[n].amount, nodes[n].pos, nodes[t])) {
+        uint32_t child = insertAt(nodes[t].left, n);
+        nodes[t].left = child;
+    } else {
+        uint32_t child = insertAt(nodes[t].right, n);
+        nodes[t].right = child;
+    }
+    ++nodes[t].size;
+    return t;
+}
+
+void AmountIndex::insert(double amount, uint32_t pos) {
+    uint32_t n = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(Node{amount, pos, treapPriority(n), NIL, NIL, 1});
+    root = insertAt(root, n);
+}
+
+uint32_t AmountIndex::computeSizes(uint32_t t) {
+    if (t == NIL) return 0;
+    nodes[t].size = 1 + computeSizes(nodes[t].left) + computeSizes(nodes[t].right);
+    return nodes[t].size;
+}
+
+void AmountIndex::assign(vector<pair<double, uint32_t>> entries) {
+    sort(entries.begin(), entries.end());
+    assignSorted(entries);
+}
+
+void AmountIndex::assignSorted(const vector<pair<double, uint32_t>>& entries) {
+    clear();
+    nodes.reserve(entries.size());
+
+    // Entries arrive in key order: build the treap left to right with a stack of the
+    // rightmost path (the usual linear-time Cartesian tree construction)
+    vector<uint32_t> path;
+    for (const auto& e : entries) {
+        uint32_t n = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{e.first, e.second, treapPriority(n), NIL, NIL, 1});
+        uint32_t last = NIL;
+        while (!path.empty() && nodes[path.back()].priority < nodes[n].priority) {
+            last = path.back();
+            path.pop_back();
+        }
+        nodes[n].left = last;
+        if (!path.empty()) nodes[path.back()].right = n;
+        path.push_back(n);
+    }
+    root = path.empty() ? NIL : path.front();
+    computeSizes(root);
+}
+
+size_t AmountIndex::countBelow(double limit, bool orEqual) const {
+    size_t count = 0;
+    uint32_t t = root;
+    while (t != NIL) {
+        const Node& n = nodes[t];
+        if (n.amount < limit || (orEqual && n.amount == limit)) {
+            count += sizeOf(n.left) + 1;
+            t = n.right;
+        } else {
+            t = n.left;
+        }
+    }
+    return count;
+}
+
+size_t AmountIndex::countInRange(double minAmount, double maxAmount) const {
+    if (minAmount > maxAmount) return 0;
+    return countBelow(maxAmount, true) - countBelow(minAmount);
+}
+
+double AmountIndex::amountAt(size_t k) const {
+    uint32_t t = root;
+    while (t != NIL) {
+        size_t leftSize = sizeOf(nodes[t].left);
+        if (k < leftSize) {
+            t = nodes[t].left;
+        } else if (k == leftSize) {
+            return nodes[t].amount;
+        } else {
+            k -= leftSize + 1;
+            t = nodes[t].right;
+        }
+    }
+    return 0.0;
+}
+
+void AmountIndex::collect(uint32_t t, double minAmount, double maxAmount, vector<uint32_t>& out) const {
+    while (t != NIL) {
+        const Node& n = nodes[t];
+        if (n.amount < minAmount) {
+            t = n.right;
+        } else if (n.amount > maxAmount) {
+            t = n.left;
+        } else {
+            collect(n.left, minAmount, maxAmount, out);
+            out.push_back(n.pos);
+            t = n.right;
+        }
+    }
+}
+
+vector<uint32_t> AmountIndex::positionsInRange(double minAmount, double maxAmount) const {
+    vector<uint32_t> out;
+    if (minAmount > maxAmount) return out;
+    out.reserve(countInRange(minAmount, maxAmount));
+    collect(root, minAmount, maxAmount, out);
+    return out;
+}
+
+// Reverse in-order walk, stopping after n entries
+void AmountIndex::collectTop(uint32_t t, size_t n, vector<uint32_t>& out) const {
+    while (t != NIL && out.size() < n) {
+        collectTop(nodes[t].right, n, out);
+        if (out.size() >= n) return;
+        out.push_back(nodes[t].pos);
+        t = nodes[t].left;
+    }
+}
+
+vector<uint32_t> AmountIndex::topPositions(size_t n) const {
+    vector<uint32_t> out;
+    out.reserve(min(n, size()));
+    collectTop(root, n, out);
+    return out;
+}
+
+// ==================== Indexes ====================
+
+void TransactionStore::clearIndexesLocked() {
+    byUser.clear();
+    byTime.clear();
+    byAmount.clear();
+    totals = TransactionStats();
+    timeSortPending = false;
+    posByID.clear();
+    posBySparseID.clear();
+    duplicateIDs = false;
+}
+
+// Caller holds stateMutex exclusively
+void TransactionStore::indexLocked(uint32_t pos, bool bulk) {
+    const Transaction& tx = transactions[pos];
+    UserRecords& user = byUser[tx.getUserID()];
+    if (!user.positions.empty() && transactions[user.positions.back()].getEpoch() > tx.getEpoch()) {
+        user.timeOrdered = false;
+    }
+    user.positions.push_back(pos);
+    user.stats.add(tx.getFinalTotal());
+    totals.add(tx.getFinalTotal());
+
+    // Records nearly always arrive in time order, so this is a push_back. A clock that went
+    // backwards (or an edited file) puts the entry in place; reload() sorts once at the end.
+    pair<int64_t, uint32_t> entry(tx.getEpoch(), pos);
+    if (byTime.empty() || byTime.back() <= entry) {
+        byTime.push_back(entry);
+    } else if (!bulk) {
+        byTime.insert(upper_bound(byTime.begin(), byTime.end(), entry), entry);
+    } else {
+        byTime.push_back(entry);
+        timeSortPending = true;
+    }
+
+    if (!bulk) {
+        byAmount.insert(tx.getFinalTotal(), pos);
+        user.byAmount.insert(tx.getFinalTotal(), pos);
+    }
+
+    // IDs are handed out sequentially, so a plain array covers them; anything far past the
+    // number of records (only possible in edited files) goes to the hash map instead.
+    // The first record with a given ID wins, as with the old front-to-back search.
+    int id = tx.getTransactionID();
+    size_t denseLimit = max<size_t>(size_t(1) << 20, 2 * transactions.size());
+    if (id > 0 && static_cast<size_t>(id) < denseLimit) {
+        if (static_cast<size_t>(id) >= posByID.size()) posByID.resize(static_cast<size_t>(id) + 1, 0);
+        if (posByID[id] == 0) posByID[id] = pos + 1;
+        else duplicateIDs = true;
+    } else if (!posBySparseID.emplace(id, pos).second) {
+        duplicateIDs = true;
+    }
+}
+
+const Transaction* TransactionStore::findByID(int txID) const {
+    ReadGuard guard(*this);
+    uint32_t pos;
+    return positionOfLocked(txID, pos) ? &transactions[pos] : nullptr;
+}
+
+// Caller holds a ReadGuard
+bool TransactionStore::positionOfLocked(int txID, uint32_t& pos) const {
+    if (txID > 0 && static_cast<size_t>(txID) < posByID.size()) {
+        uint32_t slot = posByID[txID];
+        if (slot != 0) {
+            pos = slot - 1;
+            return true;
+        }
+    }
+    auto it = posBySparseID.find(txID);
+    if (it == posBySparseID.end()) return false;
+    pos = it->second;
+    return true;
+}
+
+// Caller holds stateMutex exclusively
+void TransactionStore::sortTimeIndexLocked() {
+    if (!timeSortPending) return;
+    sort(byTime.begin(), byTime.end());
+    timeSortPending = false;
+}
+
+vector<const Transaction*> TransactionStore::findByTime(int64_t fromEpoch, int64_t toEpoch, int userID) const {
+    ReadGuard guard(*this);
+    vector<const Transaction*> result;
+    if (fromEpoch > toEpoch) return result;
+
+    if (userID < 0) {
+        auto first = lower_bound(byTime.begin(), byTime.end(), make_pair(fromEpoch, uint32_t(0)));
+        auto last = upper_bound(first, byTime.end(), make_pair(toEpoch, UINT32_MAX));
+        result.reserve(static_cast<size_t>(last - first));
+        for (auto it = first; it != last; ++it) result.push_back(&transactions[it->second]);
+        return result;
+    }
+
+    auto user = byUser.find(userID);
+    if (user == byUser.end()) return result;
+    const vector<uint32_t>& positions = user->second.positions;
+    if (user->second.timeOrdered) {
+        auto first = lower_bound(positions.begin(), positions.end(), fromEpoch,
+                                 [&](uint32_t pos, int64_t t) { return transactions[pos].getEpoch() < t; });
+        auto last = upper_bound(first, positions.end(), toEpoch,
+                                [&](int64_t t, uint32_t pos) { return t < transactions[pos].getEpoch(); });
+        for (auto it = first; it != last; ++it) result.push_back(&transactions[*it]);
+    } else {
+        // this user's history has out-of-order timestamps: filter, then order by time
+        for (uint32_t pos : positions) {
+            int64_t t = transactions[pos].getEpoch();
+            if (t >= fromEpoch && t <= toEpoch) result.push_back(&transactions[pos]);
+        }
+        stable_sort(result.begin(), result.end(), [](const Transaction* a, const Transaction* b) {
+            return a->getEpoch() < b->getEpoch();
+        });
+    }
+    return result;
+}
+
+// Caller holds stateMutex exclusively
+void TransactionStore::buildAmountIndexesLocked(const vector<uint32_t>* amountOrder) {
+    // A given order is used only if it really is every position in strictly increasing
+    // (amount, position) order; that also rules out repeated or missing positions.
+    bool ordered = amountOrder && amountOrder->size() == transactions.size();
+    for (size_t i = 0; ordered && i < amountOrder->size(); ++i) {
+        uint32_t pos = (*amountOrder)[i];
+        if (pos >= transactions.size()) ordered = false;
+        else if (i > 0) {
+            uint32_t prev = (*amountOrder)[i - 1];
+            double a = transactions[prev].getFinalTotal(), b = transactions[pos].getFinalTotal();
+            ordered = a < b || (a == b && prev < pos);
+        }
+    }
+
+    vector<pair<double, uint32_t>> entries;
+    entries.reserve(transactions.size());
+    if (!ordered) {
+        for (size_t pos = 0; pos < transactions.size(); ++pos) {
+            entries.emplace_back(transactions[pos].getFinalTotal(), static_cast<uint32_t>(pos));
+        }
+        byAmount.assign(std::move(entries));
+        for (auto& user : byUser) {
+            vector<pair<double, uint32_t>> own;
+            own.reserve(user.second.positions.size());
+            for (uint32_t pos : user.second.positions) own.emplace_back(transactions[pos].getFinalTotal(), pos);
+            user.second.byAmount.assign(std::move(own));
+        }
+        return;
+    }
+
+    // every user's entries are the global order filtered by user, so no sorting at all
+    unordered_map<int, vector<pair<double, uint32_t>>> own;
+    own.reserve(byUser.size());
+    for (uint32_t pos : *amountOrder) {
+        const Transaction& tx = transactions[pos];
+        entries.emplace_back(tx.getFinalTotal(), pos);
+        own[tx.getUserID()].emplace_back(tx.getFinalTotal(), pos);
+    }
+    byAmount.assignSorted(entries);
+    for (auto& user : own) byUser[user.first].byAmount.assignSorted(user.second);
+}
+
+vector<uint32_t> TransactionStore::amountOrder() const {
+    ReadGuard guard(*this);
+    return byAmount.positionsInRange(-numeric_limits<double>::infinity(), numeric_limits<double>::infinity());
+}
+
+TransactionStats TransactionStore::statsOf(int userID) const {
+    ReadGuard guard(*this);
+    if (userID < 0) return totals;
+    auto it = byUser.find(userID);
+    return it == byUser.end() ? TransactionStats() : it->second.stats;
+}
+
+const AmountIndex& TransactionStore::amountIndexOf(int userID) const {
+    static const AmountIndex none;
+    ReadGuard guard(*this);
+    if (userID < 0) return byAmount;
+    auto it = byUser.find(userID);
+    return it == byUser.end() ? none : it->second.byAmount;
+}
+
+const vector<uint32_t>& TransactionStore::positionsOf(int userID) const {
+    static const vector<uint32_t> none;
+    ReadGuard guard(*this);
+    auto it = byUser.find(userID);
+    return it == byUser.end() ? none : it->second.positions;
+}
+
+vector<const Transaction*> TransactionStore::pageAfter(int afterID, size_t limit, int userID) const {
+    ReadGuard guard(*this);
+    vector<const Transaction*> page;
+    const vector<uint32_t>* own = nullptr;
+    if (userID >= 0) {
+        auto it = byUser.find(userID);
+        if (it == byUser.end()) return page;
+        own = &it->second.positions;
+    }
+    size_t count = own ? own->size() : transactions.size();
+    auto positionAt = [&](size_t i) { return own ? (*own)[i] : static_cast<uint32_t>(i); };
+
+    // index (into own, or into every record) of the first record to return
+    size_t first = 0;
+    uint32_t cursorPos;
+    if (afterID > 0 && positionOfLocked(afterID, cursorPos)) {
+        first = own ? static_cast<size_t>(upper_bound(own->begin(), own->end(), cursorPos) - own->begin())
+                    : cursorPos + 1;
+    } else if (afterID > 0) {
+        // the cursor record is gone (edited file): continue at the first larger ID, which the
+        // store hands out in append order
+        size_t hi = count;
+        while (first < hi) {
+            size_t mid = first + (hi - first) / 2;
+            if (transactions[positionAt(mid)].getTransactionID() <= afterID) first = mid + 1;
+            else hi = mid;
+        }
+    }
+
+    size_t last = first + min(limit, count - first);
+    page.reserve(last - first);
+    for (size_t i = first; i < last; ++i) page.push_back(&transactions[positionAt(i)]);
+    return page;
+}
+
+void TransactionStore::setLoadThreads(int threads) {
+    unique_lock<shared_mutex> state(stateMutex);
+    loadThreads = max(threads, 0);
+}
+
+bool TransactionStore::save() {
+    unique_lock<shared_mutex> state(stateMutex);
+    return saveLocked();
+}
+
+// caller holds stateMutex
+bool TransactionStore::saveLocked() {
+    if (skippedRecords > 0) {
+        // the file holds records that are not in memory; a rewrite would delete them
+        cout << "Not rewriting " << fileName << ": it holds " << skippedRecords
+             << " unreadable transaction record(s)" << endl;
+        return false;
+    }
+    lock_guard<mutex> log(logMutex);
+    logFile.close();
+
+    ofstream fout(fileName);
+    if (!fout.is_open()) {
+        cout << "Failed to open transaction file for writing: " << fileName << endl;
+        return false;
+    }
+
+    char header[32];
+    snprintf(header, sizeof(header), "%0*d\n", HEADER_WIDTH, nextTransactionID);
+    fout << header;
+    for (const auto& tx : transactions) fout << tx.serialize();
+
+    fout.close();
+    headerID = pendingNextID = nextTransactionID;
+    logDamaged = false;
+    return true;
+}
+
+void TransactionStore::setLogMode(LogMode mode) {
+    lock_guard<mutex> log(logMutex);
+    logMode = mode;
+}
+
+void TransactionStore::setDurability(Durability mode, int groupWindowMicros) {
+    lock_guard<mutex> log(logMutex);
+    durability = mode;
+    groupCommitMicros = max(0, groupWindowMicros);
+}
+
+// Open the record file for appending; a new/empty file gets its header first.
+// Caller holds logMutex or is the current group-commit leader.
+bool TransactionStore::openLog() {
+    if (logFile.isOpen()) return true;
+    if (!logFile.open(fileName)) {
+        cout << "Failed to open transaction file for appending: " << fileName << endl;
+        return false;
+    }
+    if (logFile.size() <= 0) {
+        char header[32];
+        int n = snprintf(header, sizeof(header), "%0*d\n", HEADER_WIDTH, headerID);
+        if (!logFile.append(header, static_cast<size_t>(n))) return false;
+    }
+    return true;
+}
+
+// Append data, then move the header forward. Caller holds logMutex or is the leader.
+// A failed write is cut off again, so later blocks do not follow a partial one; if that
+// fails too, appending stops until the file is rewritten (save()).
+bool TransactionStore::writeLog(const string& data, int nextID, bool doSync) {
+    if (logDamaged || !openLog()) return false;
+    long long before = logFile.size();
+    bool ok = before >= 0 && logFile.append(data.data(), data.size());
+    if (ok && nextID > headerID) {
+        char header[32];
+        snprintf(header, sizeof(header), "%0*d", HEADER_WIDTH, nextID);
+        ok = logFile.writeAt(0, header, HEADER_WIDTH);
+        if (ok) headerID = nextID;
+    }
+    ok = ok && (!doSync || logFile.sync());
+    if (!ok && (before < 0 || !logFile.truncate(before))) logDamaged = true;
+    return ok;
+}
+
+// Leader/follower group commit: the first thread to find no flush in progress
+// becomes leader, optionally waits groupCommitMicros for more blocks, then writes
+// and syncs everything queued so far in one go. Followers just wait for it.
+// lock holds logMutex.
+bool TransactionStore::groupCommit(const string& block, int nextID, unique_lock<mutex>& lock) {
+    pendingLog += block;
+    pendingNextID = max(pendingNextID, nextID);
+    uint64_t ticket = ++enqueuedTicket;
+
+    while (durableTicket < ticket) {
+        if (flushing) {
+            logCv.wait(lock);
+            continue;
+        }
+        flushing = true;
+        int windowMicros = groupCommitMicros;   // read under the lock (setDurability may change it)
+        if (windowMicros > 0) {
+            lock.unlock();
+            this_thread::sleep_for(chrono::microseconds(windowMicros));
+            lock.lock();
+        }
+        string batch;
+        batch.swap(pendingLog);
+        uint64_t first = durableTicket + 1;
+        uint64_t last = enqueuedTicket;
+        int batchNextID = pendingNextID;
+
+        lock.unlock();
+        bool ok = writeLog(batch, batchNextID, true);
+        lock.lock();
+
+        if (!ok) failedBatches.emplace_back(first, last);
+        durableTicket = last;
+        flushing = false;
+        logCv.notify_all();
+    }
+    // every batch's outcome is kept, so a follower woken after later batches failed too still
+    // finds its own
+    for (const auto& range : failedBatches) {
+        if (ticket >= range.first && ticket <= range.second) return false;
+    }
+    return true;
+}
+
+int TransactionStore::getNextTransactionID() const {
+    ReadGuard guard(*this);
+    return nextTransactionID;
+}
+
+bool TransactionStore::append(const Transaction& tx) {
+    int nextID;
+    uint64_t seq;
+    {
+        unique_lock<shared_mutex> state(stateMutex);
+        transactions.push_back(tx);
+        indexLocked(static_cast<uint32_t>(transactions.size() - 1));
+        if (tx.getTransactionID() >= nextTransactionID) {
+            nextTransactionID = tx.getTransactionID() + 1;
+        }
+        nextID = nextTransactionID;
+        if (logMode == LogMode::Rewrite && skippedRecords == 0) return saveLocked();
+        seq = ++appendSeq;
+    }
+    return persist(tx, nextID, seq);
+}
+
+bool TransactionStore::appendNew(Transaction& tx) {
+    int nextID;
+    uint64_t seq;
+    {
+        unique_lock<shared_mutex> state(stateMutex);
+        tx.setTransactionID(nextTransactionID++);
+        transactions.push_back(tx);
+        indexLocked(static_cast<uint32_t>(transactions.size() - 1));
+        nextID = nextTransactionID;
+        if (logMode == LogMode::Rewrite && skippedRecords == 0) return saveLocked();
+        seq = ++appendSeq;
+    }
+    return persist(tx, nextID, seq);
+}
+
+// Write one appended record to the log (outside stateMutex, so readers are not blocked by I/O).
+// seq numbers the appends in ID order; each block waits for the one before it, so the file
+// stays in ID order (reload and pageAfter search it by ID) whatever order the threads get here.
+bool TransactionStore::persist(const Transaction& tx, int nextID, uint64_t seq) {
+    string block = tx.serialize();
+    unique_lock<mutex> log(logMutex);
+    logCv.wait(log, [&] { return loggedSeq + 1 == seq; });
+    bool ok;
+    if (durability == Durability::GroupCommit) {
+        // queued in order; the leader may write it after this thread lets the next block in
+        loggedSeq = seq;
+        logCv.notify_all();
+        ok = groupCommit(block, nextID, log);
+    } else {
+        ok = writeLog(block, nextID, durability == Durability::Fsync);
+        loggedSeq = seq;
+        logCv.notify_all();
+    }
+    log.unlock();
+    if (!ok) cout << "Failed to append transaction to " << fileName << endl;
+    return ok;
+}
@@ -0,0 +1,236 @@
+#ifndef TRANSACTIONSTORE_H
+#define TRANSACTIONSTORE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FileIO.h"
+#include "Transaction.h"
+
+using namespace std;
+
+// How a new transaction reaches TransactionRecord.txt
+enum class LogMode {
+    Rewrite,    // rewrite the whole file (legacy behaviour, O(history) per checkout)
+    Append      // append only the new TX|/ITEM| block and patch the header in place
+};
+
+// When appended records are forced to disk (Append mode only)
+enum class Durability {
+    None,       // leave it to the OS page cache
+    Fsync,      // fsync after every checkout
+    GroupCommit // checkouts arriving together share one write + fsync
+};
+
+// Transactions ordered by final amount: a treap (randomized balanced tree) with subtree
+// sizes, so ranges, ranks and the k-th smallest amount take O(log n).
+// Holds positions into TransactionStore::all(); entries are ordered by (amount, position).
+class AmountIndex {
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+    struct Node {
+        double amount;
+        uint32_t pos;
+        uint32_t priority;      // heap order: a parent's priority is >= its children's
+        uint32_t left, right;
+        uint32_t size;          // nodes in this subtree
+    };
+    vector<Node> nodes;
+    uint32_t root;
+
+    static bool keyLess(double amount, uint32_t pos, const Node& n) {
+        return amount < n.amount || (amount == n.amount && pos < n.pos);
+    }
+    uint32_t sizeOf(uint32_t t) const { return t == NIL ? 0 : nodes[t].size; }
+    void update(uint32_t t) { nodes[t].size = 1 + sizeOf(nodes[t].left) + sizeOf(nodes[t].right); }
+    void split(uint32_t t, double amount, uint32_t pos, uint32_t& less, uint32_t& rest);
+    uint32_t insertAt(uint32_t t, uint32_t n);
+    uint32_t computeSizes(uint32_t t);
+    void collect(uint32_t t, double minAmount, double maxAmount, vector<uint32_t>& out) const;
+    void collectTop(uint32_t t, size_t n, vector<uint32_t>& out) const;
+
+public:
+    AmountIndex() : root(NIL) {}
+
+    void clear();
+    void insert(double amount, uint32_t pos);
+    // Replace the contents with these entries (O(n log n) sort + O(n) build)
+    void assign(vector<pair<double, uint32_t>> entries);
+    // Same for entries already in (amount, position) order: O(n)
+    void assignSorted(const vector<pair<double, uint32_t>>& entries);
+
+    size_t size() const { return sizeOf(root); }
+    bool empty() const { return root == NIL; }
+    // Entries with amount < limit (orEqual: <= limit)
+    size_t countBelow(double limit, bool orEqual = false) const;
+    // Entries with minAmount <= amount <= maxAmount, without listing them
+    size_t countInRange(double minAmount, double maxAmount) const;
+    // Amount of the k-th smallest entry (0-based); k < size()
+    double amountAt(size_t k) const;
+    // Positions with minAmount <= amount <= maxAmount, smallest amount first
+    vector<uint32_t> positionsInRange(double minAmount, double maxAmount) const;
+    // Positions of the n largest amounts, largest first
+    vector<uint32_t> topPositions(size_t n) const;
+};
+
+// Process-wide transaction store.
+// TransactionRecord.txt is parsed once and shared by every TransactionManager;
+// a manager is only a (userID, store) pair that filters this data on demand.
+//
+// Threads may append and read at the same time: readers hold a ReadGuard while they walk
+// the records, appends take the lock exclusively for the in-memory insert only. Records are
+// kept in a deque, so a pointer to a record stays valid while later records are appended.
+//
+// File layout: first line is nextTransactionID written as a fixed-width
+// (10 digit) number so it can be overwritten in place, followed by the
+// TX|/ITEM| blocks in commit order.
+class TransactionStore {
+private:
+    static const int HEADER_WIDTH = 10;
+    static const size_t PARALLEL_LOAD_MIN_BYTES = 4 << 20;  // smaller files are parsed on one thread
+
+    string fileName;                    // global transaction record file
+    atomic<bool> loaded;                // whether the file has been read
+    int nextTransactionID;              // next transaction ID (global)
+    deque<Transaction> transactions;    // all transaction records, in file order
+    mutable shared_mutex stateMutex;    // guards transactions / nextTransactionID / indexes
+
+    // ---- indexes over transactions (rebuilt by reload, extended by every append) ----
+    struct UserRecords {
+        vector<uint32_t> positions;     // this user's records (positions in transactions), append order
+        bool timeOrdered = true;        // positions are also in timestamp order (normal case)
+        AmountIndex byAmount;
+        TransactionStats stats;
+    };
+    unordered_map<int, UserRecords> byUser;
+    vector<pair<int64_t, uint32_t>> byTime;  // (epoch, position) of every record, sorted
+    bool timeSortPending;               // byTime got an out-of-order entry during a bulk reload()
+    AmountIndex byAmount;               // every record by final amount
+    TransactionStats totals;            // over every record
+    vector<uint32_t> posByID;           // posByID[txID] = position + 1, 0 = none (IDs are dense)
+    unordered_map<int, uint32_t> posBySparseID;  // IDs far beyond the dense range (hand-edited files)
+    bool duplicateIDs;                  // some ID occurs twice (only possible in edited files)
+    size_t skippedRecords;              // records reload() could not parse; the file keeps them
+    int loadThreads;                    // parser threads for reload(), 0 = one per core
+    uint64_t appendSeq;                 // records handed to persist(), numbered in ID order
+
+    // ---- log writer state (guarded by logMutex) ----
+    atomic<LogMode> logMode;            // set under logMutex, read by appends without it
+    atomic<Durability> durability;      // likewise
+    int groupCommitMicros;              // how long a group-commit leader waits for followers
+    AppendFile logFile;
+    int headerID;                       // nextTransactionID currently in the file header
+    int pendingNextID;                  // header value for the next group commit
+    mutex logMutex;
+    condition_variable logCv;
+    string pendingLog;                  // blocks waiting for the next group commit
+    uint64_t enqueuedTicket;            // last block added to pendingLog
+    uint64_t durableTicket;             // last block written (and synced)
+    vector<pair<uint64_t, uint64_t>> failedBatches;  // ticket ranges of every failed batch (failures are rare)
+    bool logDamaged;                    // a failed write could not be undone: no appends until the file is rewritten
+    bool flushing;                      // a leader is writing a batch
+    uint64_t loggedSeq;                 // last appendSeq written or queued; blocks go in this order
+
+    bool saveLocked();
+    bool upgradeHeaderLocked(const string& records);
+    bool openLog();
+    bool writeLog(const string& data, int nextID, bool doSync);
+    bool groupCommit(const string& block, int nextID, unique_lock<mutex>& lock);
+    bool persist(const Transaction& tx, int nextID, uint64_t seq);
+    void clearIndexesLocked();
+    // add transactions[pos] to every index; bulk = part of reload(), which sorts byTime once at the end
+    void indexLocked(uint32_t pos, bool bulk = false);
+    void sortTimeIndexLocked();
+    // after a bulk load; amountOrder (if valid) lists every position by (amount, position) and saves the sorts
+    void buildAmountIndexesLocked(const vector<uint32_t>* amountOrder = nullptr);
+    // index every record of a bulk load, nextTransactionID moves past the highest ID
+    void indexAllLocked(const vector<uint32_t>* amountOrder = nullptr);
+    bool positionOfLocked(int txID, uint32_t& pos) const;    // position of the first record with this ID
+
+public:
+    explicit TransactionStore(string file = "TransactionRecord.txt");
+    TransactionStore(const TransactionStore&) = delete;
+    TransactionStore& operator=(const TransactionStore&) = delete;
+
+    // The single store used by the application
+    static TransactionStore& instance();
+
+    // Shared lock on the records for as long as the guard lives. Nesting on one thread is
+    // fine (only the outermost guard locks), so query functions can call each other.
+    class ReadGuard {
+    private:
+        const TransactionStore* store;
+        const TransactionStore* previous;   // store read-locked by the enclosing guard, if any
+        bool owns;
+    public:
+        explicit ReadGuard(const TransactionStore& txStore);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    const string& getFileName() const { return fileName; }
+    bool isLoaded() const { return loaded; }
+
+    // Load the file on first use only (cheap after that)
+    bool ensureLoaded();
+    // Drop the in-memory copy and read the file again.
+    // A file with an old variable-width header is rewritten once in the new layout.
+    bool reload();
+    // Rewrite the whole file from memory. Refused (false) while the file holds records
+    // reload() could not parse, as the rewrite would delete them.
+    bool save();
+    // Replace the in-memory records with an already decoded set (e.g. from a snapshot) and
+    // index them; amountOrder (optional) is amountOrder() of the same records. The file is
+    // not touched: appends continue it, so it must already hold exactly these records.
+    void adopt(deque<Transaction> records, int nextID, const vector<uint32_t>* amountOrder = nullptr);
+    // Every position ordered by (final amount, position)
+    vector<uint32_t> amountOrder() const;
+    // Parse the file on up to n threads (split at TX| lines); 0 = one per core (default), 1 = sequential
+    void setLoadThreads(int threads);
+
+    // Persistence policy for append(). Rewrite falls back to appending while the file holds
+    // unparsed records (see save()).
+    void setLogMode(LogMode mode);
+    LogMode getLogMode() const { return logMode; }
+    void setDurability(Durability mode, int groupWindowMicros = 0);
+    Durability getDurability() const { return durability; }
+
+    int getNextTransactionID() const;
+    // Add a new record and persist it according to the log mode;
+    // nextTransactionID moves past its ID. Returns false if the write failed.
+    bool append(const Transaction& tx);
+    // Same, but the record gets the next free ID (assigned under the lock, so concurrent
+    // checkouts never share an ID). tx is updated with the ID it was stored under.
+    bool appendNew(Transaction& tx);
+
+    // All records; hold a ReadGuard while using it if other threads may append
+    const deque<Transaction>& all() const { return transactions; }
+    const Transaction& at(uint32_t pos) const { return transactions[pos]; }
+
+    // Index lookups (hold a ReadGuard while using the results if other threads may append)
+    const Transaction* findByID(int txID) const;             // O(1), nullptr if absent
+    const vector<uint32_t>& positionsOf(int userID) const;  // a user's records, append order
+    bool hasDuplicateIDs() const { return duplicateIDs; }   // findByID returns the first one
+    size_t getSkippedRecords() const { return skippedRecords; }  // unparsed records left in the file
+    // Records with fromEpoch <= timestamp <= toEpoch, oldest first (ties in append order);
+    // userID < 0 = every user. Binary search on the time index, O(log n + result).
+    vector<const Transaction*> findByTime(int64_t fromEpoch, int64_t toEpoch, int userID = -1) const;
+    // Page of up to limit records following the record with ID afterID (afterID <= 0: from the
+    // first record), in append order; userID < 0 = every user. The order is stable under
+    // appends, so the last ID of a page is the cursor for the next one. O(log n + limit).
+    vector<const Transaction*> pageAfter(int afterID, size_t limit, int userID = -1) const;
+    // Count / sum / min / max of a user's records, or of every record for userID < 0; O(1)
+    TransactionStats statsOf(int userID) const;
+    // Amount order of a user's records, or of every record for userID < 0
+    const AmountIndex& amountIndexOf(int userID) const;
+};
+
+#endif // TRANSACTIONSTORE_H
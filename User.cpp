@@ -1,4 +1,5 @@
 #include "User.h"
+#include "CartStore.h"
 #include <algorithm>
 
 // Initialize static member
@@ -28,9 +29,27 @@ bool User::isPasswordValid(const string& pwd) {
     return true;
 }
 
-bool User::usernameExists(const vector<User>& users, const string& username) {
-    for (const auto& u : users) if (u.username == username) return true;
-    return false;
+// -------------------- UserList --------------------
+User& UserList::add(User u) {
+    users.push_back(std::move(u));
+    User& added = users.back();
+    byName.emplace(added.username, &added);
+    return added;
+}
+
+User* UserList::find(const string& username) {
+    auto it = byName.find(username);
+    return it == byName.end() ? nullptr : it->second;
+}
+
+const User* UserList::find(const string& username) const {
+    auto it = byName.find(username);
+    return it == byName.end() ? nullptr : it->second;
+}
+
+void UserList::clear() {
+    byName.clear();
+    users.clear();
 }
 
 // users file line format:
@@ -67,15 +86,15 @@ string User::toUserLine(const User& u) {
 }
 
 // -------------------- Load / Save all users --------------------
-void User::createDefaultAdmin(vector<User>& users, int& nextUserID) {
+void User::createDefaultAdmin(UserList& users, int& nextUserID) {
     // Ensure nextUserID starts from at least 2
     if (nextUserID <= 1) nextUserID = 2;
 
     // Create default admin with fixed credentials
-    users.emplace_back(1, "admin", "passwd123", 1, true, 0.0);
+    users.add(User(1, "admin", "passwd123", 1, true, 0.0));
     cout << "Default admin account created (username: admin, password: passwd123)" << endl;
 }
-bool User::loadAll(vector<User>& users, int& nextUserID, const string& filename) {
+bool User::loadAll(UserList& users, int& nextUserID, const string& filename) {
     ifstream fin(filename);
     users.clear();
     nextUserID = 1;
@@ -103,17 +122,12 @@ bool User::loadAll(vector<User>& users, int& nextUserID, const string& filename)
     while (getline(fin, line)) {
         if (line.empty()) continue;
         auto u = parseUserLine(line);
-        if (u.has_value()) users.push_back(*u);
+        if (u.has_value()) users.add(std::move(*u));
     }
 
     // Check if default admin exists, if not, add it
-    bool hasDefaultAdmin = false;
-    for (const auto& u : users) {
-        if (u.userID == 1 && u.username == "admin") {
-            hasDefaultAdmin = true;
-            break;
-        }
-    }
+    const User* admin = users.find("admin");
+    bool hasDefaultAdmin = admin && admin->userID == 1;
     if (!hasDefaultAdmin) {
         createDefaultAdmin(users, nextUserID);
     }
@@ -121,7 +135,7 @@ bool User::loadAll(vector<User>& users, int& nextUserID, const string& filename)
     return true;
 }
 
-bool User::saveAll(const vector<User>& users, int nextUserID, const string& filename) {
+bool User::saveAll(const UserList& users, int nextUserID, const string& filename) {
     ofstream fout(filename);
     if (!fout.is_open()) {
         cout << "Failed to open users file for writing: " << filename << endl;
@@ -146,7 +160,7 @@ bool User::requestAdminAccess(const string& username, const string& password) {
     return true;
 }
 
-bool User::approveAdminRequest(vector<User>& users, int& nextUserID, int requestIndex) {
+bool User::approveAdminRequest(UserList& users, int& nextUserID, int requestIndex) {
     if (requestIndex < 0 || requestIndex >= static_cast<int>(pendingAdmins.size())) {
         cout << "Invalid request index." << endl;
         return false;
@@ -157,7 +171,7 @@ bool User::approveAdminRequest(vector<User>& users, int& nextUserID, int request
     const string& password = request.second;
 
     // Check if username still available
-    if (usernameExists(users, username)) {
+    if (users.contains(username)) {
         cout << "Username '" << username << "' is no longer available." << endl;
         pendingAdmins.erase(pendingAdmins.begin() + requestIndex);
         return false;
@@ -165,7 +179,7 @@ bool User::approveAdminRequest(vector<User>& users, int& nextUserID, int request
 
     // Create admin user
     int id = nextUserID++;
-    users.emplace_back(id, username, password, 1, true, 0.0);
+    users.add(User(id, username, password, 1, true, 0.0));
     cout << "Admin request approved. New admin userID=" << id << endl;
 
     // Remove from pending list
@@ -197,7 +211,7 @@ void User::displayPendingRequests() {
     }
 }
 // -------------------- Register / Login --------------------
-bool User::registerUser(vector<User>& users, int& nextUserID,
+bool User::registerUser(UserList& users, int& nextUserID,
                         const string& username, const string& password,
                         bool isAdmin) {
     if (!isUsernameValid(username)) {
@@ -208,7 +222,7 @@ bool User::registerUser(vector<User>& users, int& nextUserID,
         cout << "Register failed: invalid password (min length 4)." << endl;
         return false;
     }
-    if (usernameExists(users, username)) {
+    if (users.contains(username)) {
         cout << "Register failed: username already exists." << endl;
         return false;
     }
@@ -219,26 +233,25 @@ bool User::registerUser(vector<User>& users, int& nextUserID,
     }
 
     int id = nextUserID++;
-    users.emplace_back(id, username, password, 1, false, 0.0);
+    users.add(User(id, username, password, 1, false, 0.0));
     cout << "Register success. userID=" << id << endl;
     return true;
 }
 
-User* User::login(vector<User>& users, const string& username, const string& password) {
-    for (auto& u : users) {
-        if (u.username == username && u.password == password) {
-            u.ensureTxmBound();
-            cout << "Login success. userID=" << u.userID
-                 << (u.isAdmin ? " (Admin)" : "") << endl;
-            return &u;
-        }
+User* User::login(UserList& users, const string& username, const string& password) {
+    User* u = users.find(username);
+    if (u && u->password == password) {
+        u->ensureTxmBound();
+        cout << "Login success. userID=" << u->userID
+             << (u->isAdmin ? " (Admin)" : "") << endl;
+        return u;
     }
     cout << "Login failed: wrong username or password." << endl;
     return nullptr;
 }
 
 // Forgot password (simple recovery)
-bool User::resetPassword(vector<User>& users,
+bool User::resetPassword(UserList& users,
                          const string& username,
                          const string& newPassword) {
     if (!isPasswordValid(newPassword)) {
@@ -252,18 +265,24 @@ bool User::resetPassword(vector<User>& users,
         return false;
     }
 
-    for (auto& u : users) {
-        if (u.username == username) {
-            u.password = newPassword;
-            cout << "Password reset success for username: " << username << endl;
-            return true;
-        }
+    if (User* u = users.find(username)) {
+        u->password = newPassword;
+        cout << "Password reset success for username: " << username << endl;
+        return true;
     }
     cout << "Reset failed: username not found." << endl;
     return false;
 }
 
-// -------------------- Cart file binding --------------------
+// -------------------- Cart binding --------------------
+void User::loadCart() {
+    CartStore::instance().load(userID, cart);
+}
+
+void User::saveCart() const {
+    CartStore::instance().save(userID, cart);
+}
+
 bool User::loadCartFromFile() {
     return cart.loadFromFile(cartFileName());
 }
@@ -292,7 +311,7 @@ void User::updateLevelBySpent() {
 }
 
 // -------------------- Checkout (via TransactionManager) --------------------
-bool User::checkout(ProductManager& pm) {
+bool User::checkout(ProductManager& pm, const ShortageHandler& onShortage) {
     if (isAdmin) {
         cout << "Admin account cannot checkout as a customer." << endl;
         return false;
@@ -304,21 +323,16 @@ bool User::checkout(ProductManager& pm) {
 
     ensureTxmBound();
 
-    // ensure latest tx records for this user (filtered total)
-    txm.loadFromFile();
-    double before = txm.getTotalSpent();
-
-    bool ok = txm.processTransaction(cart, pm, level, isAdmin);
+    Transaction receipt;
+    bool ok = txm.processTransaction(cart, pm, level, isAdmin, onShortage, &receipt);
 
     // cart may be cleared or modified; persist
-    saveCartToFile();
+    saveCart();
 
     if (!ok) return false;
 
-    // compute delta from tx records
-    double after = txm.getTotalSpent();
-    double delta = after - before;
-    if (delta < 0) delta = 0;
+    // the spend delta is simply what this order cost
+    double delta = receipt.getFinalTotal();
 
     totalSpent += delta;
     updateLevelBySpent();
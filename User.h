@@ -2,7 +2,10 @@
 #define ASSIGNMENT2_USER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <deque>
+#include <unordered_map>
 #include <optional>
 #include <iostream>
 #include <fstream>
@@ -14,6 +17,8 @@
 
 using namespace std;
 
+class UserList;
+
 class User {
 public:
     int userID = 0;
@@ -39,28 +44,31 @@ public:
 
     static string usersFileName() { return "users.txt"; }
 
-    static bool loadAll(vector<User>& users, int& nextUserID, const string& filename = usersFileName());
-    static bool saveAll(const vector<User>& users, int nextUserID, const string& filename = usersFileName());
-	static void createDefaultAdmin(vector<User>& users, int& nextUserID);
-    static bool registerUser(vector<User>& users, int& nextUserID,
+    static bool loadAll(UserList& users, int& nextUserID, const string& filename = usersFileName());
+    static bool saveAll(const UserList& users, int nextUserID, const string& filename = usersFileName());
+	static void createDefaultAdmin(UserList& users, int& nextUserID);
+    static bool registerUser(UserList& users, int& nextUserID,
                              const string& username, const string& password,
                              bool isAdmin = false);
 
-    static User* login(vector<User>& users, const string& username, const string& password);
+    static User* login(UserList& users, const string& username, const string& password);
 
     // Admin approval system
     static bool requestAdminAccess(const string& username, const string& password);
-    static bool approveAdminRequest(vector<User>& users, int& nextUserID, int requestIndex);
+    static bool approveAdminRequest(UserList& users, int& nextUserID, int requestIndex);
     static bool rejectAdminRequest(int requestIndex);
     static void displayPendingRequests();
     static bool hasPendingRequests() { return !pendingAdmins.empty(); }
 
     // Forgot password
-    static bool resetPassword(vector<User>& users,
+    static bool resetPassword(UserList& users,
                               const string& username,
                               const string& newPassword);
 
-    // cart file per user
+    // cart in the shared CartStore (CartStore::instance())
+    void loadCart();
+    void saveCart() const;
+    // legacy cart file per user (CartStore::migrateLegacyFiles imports these)
     string cartFileName() const { return ShoppingCart::getShoppingCartFileName(userID); }
     bool loadCartFromFile();
     bool saveCartToFile() const;
@@ -75,14 +83,19 @@ public:
     void updateLevelBySpent();
 
     // cart operations
-    void addToCart(int productID, const ProductManager& pm) { cart.addItem(productID, pm); }
-    void updateCartItem(int productID, const ProductManager& pm) { cart.updateItem(productID, pm); }
-    void removeFromCart(int productID) { cart.removeItem(productID); }
+    CartStatus addToCart(int productID, Size size, int quantity, const ProductManager& pm) {
+        return cart.addItem(productID, size, quantity, pm);
+    }
+    CartStatus updateCartItem(int productID, Size size, int quantity, const ProductManager& pm) {
+        return cart.updateItem(productID, size, quantity, pm);
+    }
+    CartStatus removeFromCart(int productID) { return cart.removeItem(productID); }
+    const ShoppingCart& getCart() const { return cart; }
     void showCart(const ProductManager& pm) const { cart.displayCart(pm); }
     void clearCart() { cart.clearCart(); }
 
-    // checkout via TransactionManager
-    bool checkout(ProductManager& pm);
+    // checkout via TransactionManager; stock shortages go to onShortage (empty = cancel)
+    bool checkout(ProductManager& pm, const ShortageHandler& onShortage = nullptr);
 
     // transaction displays (filtered)
     void displayTransactionSummary() { ensureTxmBound(); txm.displayTransactionSummary(); }
@@ -96,7 +109,6 @@ private:
     static optional<User> parseUserLine(const string& line);
     static string toUserLine(const User& u);
 
-    static bool usernameExists(const vector<User>& users, const string& username);
     static vector<string> split(const string& s, char delim);
 
     void ensureTxmBound() {
@@ -104,4 +116,38 @@ private:
     }
 };
 
+// ==================== UserList ====================
+// All accounts plus a username -> user hash index, so login / register / reset are O(1)
+// instead of a scan over every account. Users live in a deque, which never moves existing
+// elements, so the index and any User* handed out (e.g. by login) stay valid as users are
+// added. Index keys view each user's own username string (usernames never change).
+class UserList {
+private:
+    deque<User> users;
+    unordered_map<string_view, User*> byName;
+
+public:
+    UserList() = default;
+    UserList(const UserList&) = delete;     // the index points into this list
+    UserList& operator=(const UserList&) = delete;
+
+    // Add a user; the index keeps the first user with a given name
+    User& add(User u);
+    User* find(const string& username);
+    const User* find(const string& username) const;
+    bool contains(const string& username) const { return byName.count(username) != 0; }
+
+    User& operator[](size_t i) { return users[i]; }    // i-th user in load/registration order
+    const User& operator[](size_t i) const { return users[i]; }
+    size_t size() const { return users.size(); }
+    bool empty() const { return users.empty(); }
+    void clear();
+    void reserveIndex(size_t n) { byName.reserve(n); }
+
+    deque<User>::iterator begin() { return users.begin(); }
+    deque<User>::iterator end() { return users.end(); }
+    deque<User>::const_iterator begin() const { return users.begin(); }
+    deque<User>::const_iterator end() const { return users.end(); }
+};
+
 #endif // ASSIGNMENT2_USER_H
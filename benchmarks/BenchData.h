@@ -0,0 +1,145 @@
+#ifndef BENCHDATA_H
+#define BENCHDATA_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "../Transaction.h"
+
+using namespace std;
+
+// Writers for synthetic data files in the formats the application reads.
+
+// Zipf-distributed ranks 1..n (rank 1 most popular, P(k) ~ 1/k^s), O(1) memory and time
+// per draw: Hoermann & Derflinger's rejection-inversion method. Deterministic for a given rng.
+class ZipfSampler {
+private:
+    long n;
+    double s;
+    double hIntegralX1, hIntegralN, squeeze;
+
+    double h(double x) const { return exp(-s * log(x)); }
+    // log1p(x)/x and expm1(x)/x, accurate near 0
+    static double helper1(double x) { return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x)); }
+    static double helper2(double x) { return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x)); }
+    double hIntegral(double x) const {
+        double logX = log(x);
+        return helper2((1.0 - s) * logX) * logX;
+    }
+    double hIntegralInverse(double x) const {
+        double t = max(x * (1.0 - s), -1.0);
+        return exp(helper1(t) * x);
+    }
+
+public:
+    ZipfSampler(long count, double exponent) : n(max(count, 1L)), s(exponent) {
+        hIntegralX1 = hIntegral(1.5) - 1.0;
+        hIntegralN = hIntegral(static_cast<double>(n) + 0.5);
+        squeeze = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
+
+    template <typename Rng>
+    long operator()(Rng& rng) const {
+        uniform_real_distribution<double> unit(0.0, 1.0);
+        while (true) {
+            double u = hIntegralN + unit(rng) * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            long k = min(max(static_cast<long>(x + 0.5), 1L), n);
+            if (k - x <= squeeze || u >= hIntegral(k + 0.5) - h(static_cast<double>(k))) return k;
+        }
+    }
+};
+
+// products.txt: nextProductID, then id,name,catIdx,secIdx,price,XS,S,M,L,XL,None
+// Every third product is size-less (stock in the None slot only).
+static void writeProductsFile(long productCount, const char* path = "products.txt") {
+    FILE* f = fopen(path, "w");
+    setvbuf(f, nullptr, _IOFBF, 1 << 20);
+    fprintf(f, "%ld\n", productCount + 1);
+    for (long id = 1; id <= productCount; ++id) {
+        int cat = static_cast<int>(id % 4);
+        int sec = cat == 3 ? 2 : static_cast<int>((id / 4) % 3);
+        int price = 10 + static_cast<int>(id % 490);
+        if (id % 3 == 0) {
+            fprintf(f, "%ld,Product_%ld,%d,%d,%d,0,0,0,0,0,%ld\n", id, id, cat, sec, price, 50 + id % 100);
+        } else {
+            fprintf(f, "%ld,Product_%ld,%d,%d,%d,%ld,%ld,%ld,%ld,%ld,0\n", id, id, cat, sec, price,
+                    5 + id % 7, 10 + id % 11, 20 + id % 13, 10 + id % 9, 5 + id % 5);
+        }
+    }
+    fclose(f);
+}
+
+// cart_<userID>.txt style file with lineCount lines over products 1..productCount
+static void writeCartFile(const string& path, int lineCount, long productCount, int seed = 7) {
+    FILE* f = fopen(path.c_str(), "w");
+    mt19937 rng(seed);
+    uniform_int_distribution<long> productDist(1, productCount);
+    fprintf(f, "%d\n", lineCount);
+    for (int i = 0; i < lineCount; ++i) {
+        long id = productDist(rng);
+        // sized products buy one M, size-less ones one None
+        if (id % 3 == 0) fprintf(f, "%ld 0 0 0 0 0 1\n", id);
+        else fprintf(f, "%ld 0 0 1 0 0 0\n", id);
+    }
+    fclose(f);
+}
+
+// users.txt: nextUserID, then userID|username|password|level|isAdmin|totalSpent
+static void writeUsersFile(long userCount, const char* path = "users.txt") {
+    FILE* f = fopen(path, "w");
+    setvbuf(f, nullptr, _IOFBF, 1 << 20);
+    fprintf(f, "%ld\n", userCount + 1);
+    fprintf(f, "1|admin|passwd123|1|1|0.000000\n");
+    for (long id = 2; id <= userCount; ++id) {
+        fprintf(f, "%ld|user%ld|pass%ld|1|0|0.000000\n", id, id, id);
+    }
+    fclose(f);
+}
+
+// Build one single-item transaction for user uID
+static Transaction makeTransaction(int txID, int uID, int productID) {
+    int qty = 1 + productID % 3;
+    double price = 10.0 + productID % 90;
+    vector<int> qtys(6, 0);
+    qtys[1] = qty;
+    vector<TransactionItem> items;
+    items.emplace_back(productID, "Product_" + to_string(productID),
+                       Category::Men, Section::Eastern, price, qtys);
+    return Transaction(txID, uID, items, price * qty, 1.0, price * qty,
+                       "2025-12-08 10:00:00", 1);
+}
+
+// First and last timestamp of writeTransactionFile's history (five years, evenly spaced)
+static const char* const HISTORY_START = "2021-01-01 00:00:00";
+static const char* const HISTORY_END = "2025-12-31 23:59:59";
+
+// TransactionRecord.txt with txCount single-item transactions spread over users 2..userCount
+static void writeTransactionFile(long txCount, long userCount,
+                                 const char* path = "TransactionRecord.txt") {
+    FILE* f = fopen(path, "w");
+    setvbuf(f, nullptr, _IOFBF, 1 << 20);
+    fprintf(f, "%010ld\n", txCount + 1);
+    mt19937 rng(42);
+    uniform_int_distribution<long> userDist(2, userCount < 2 ? 2 : userCount);
+    uniform_int_distribution<int> productDist(1, 1000);
+    int64_t start = 0, end = 0;
+    Transaction::parseTimestamp(HISTORY_START, start);
+    Transaction::parseTimestamp(HISTORY_END, end);
+    double step = txCount > 0 ? static_cast<double>(end - start) / txCount : 0;
+    for (long id = 1; id <= txCount; ++id) {
+        int pid = productDist(rng);
+        int qty = 1 + pid % 3;
+        double price = 10.0 + pid % 90;
+        string when = Transaction::formatTimestamp(start + static_cast<int64_t>(step * (id - 1)));
+        fprintf(f, "TX|%ld|%ld|%.2f|1.00|%.2f|%s|1|1\n",
+                id, userDist(rng), price * qty, price * qty, when.c_str());
+        fprintf(f, "ITEM|%d|Product_%d|0|0|%.2f|0|%d|0|0|0|0|%.2f\n",
+                pid, pid, price, qty, price * qty);
+    }
+    fclose(f);
+}
+
+#endif // BENCHDATA_H
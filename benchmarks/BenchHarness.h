@@ -0,0 +1,154 @@
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+
+using namespace std;
+
+// Repetition harness for micro-benchmarks.
+//
+// For each benchmark the batch size (operations per sample) is doubled until one batch
+// takes at least minBatchMs, then warmupReps batches are run and thrown away, then reps
+// batches are timed. Samples outside Tukey's fences (Q1 - 1.5 IQR, Q3 + 1.5 IQR) are
+// rejected as outliers; the statistics are over the samples kept, in ns per operation.
+
+// Keep the compiler from dropping a computation whose result is otherwise unused
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+    string name;
+    long batch = 0;     // operations per sample
+    int samples = 0;    // timed samples
+    int rejected = 0;   // samples dropped as outliers
+    double medianNs = 0, meanNs = 0, minNs = 0, maxNs = 0, stddevNs = 0;
+};
+
+class BenchSuite {
+private:
+    int reps;
+    int warmupReps;
+    double minBatchMs;
+    string filter;      // run only benchmarks whose name contains this ("" = all)
+    vector<BenchResult> results;
+
+    // value at quantile q of sorted samples, linear interpolation
+    static double quantile(const vector<double>& sorted, double q) {
+        double pos = q * static_cast<double>(sorted.size() - 1);
+        size_t lo = static_cast<size_t>(pos);
+        size_t hi = min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - static_cast<double>(lo));
+    }
+
+    template <typename Op>
+    static double timeBatch(Op& op, long batch) {
+        Stopwatch sw;
+        for (long i = 0; i < batch; ++i) op();
+        return sw.elapsedMs();
+    }
+
+    static BenchResult summarize(const string& name, long batch, vector<double> nsPerOp) {
+        BenchResult r;
+        r.name = name;
+        r.batch = batch;
+        r.samples = static_cast<int>(nsPerOp.size());
+        sort(nsPerOp.begin(), nsPerOp.end());
+        double q1 = quantile(nsPerOp, 0.25), q3 = quantile(nsPerOp, 0.75);
+        double lowFence = q1 - 1.5 * (q3 - q1), highFence = q3 + 1.5 * (q3 - q1);
+        vector<double> kept;
+        for (double v : nsPerOp) {
+            if (v >= lowFence && v <= highFence) kept.push_back(v);
+        }
+        r.rejected = r.samples - static_cast<int>(kept.size());
+        r.medianNs = quantile(kept, 0.5);
+        r.minNs = kept.front();
+        r.maxNs = kept.back();
+        double sum = 0, sq = 0;
+        for (double v : kept) sum += v;
+        r.meanNs = sum / static_cast<double>(kept.size());
+        for (double v : kept) sq += (v - r.meanNs) * (v - r.meanNs);
+        r.stddevNs = kept.size() > 1 ? sqrt(sq / static_cast<double>(kept.size() - 1)) : 0;
+        return r;
+    }
+
+    static void jsonString(FILE* f, const string& s) {
+        fputc('"', f);
+        for (char c : s) {
+            if (c == '"' || c == '\\') fputc('\\', f);
+            fputc(c, f);
+        }
+        fputc('"', f);
+    }
+
+public:
+    explicit BenchSuite(int repetitions = 15, int warmup = 3, double minBatchMillis = 10, string nameFilter = "")
+        : reps(max(repetitions, 1)), warmupReps(max(warmup, 0)), minBatchMs(minBatchMillis),
+          filter(std::move(nameFilter)) {}
+
+    bool selected(const string& name) const { return filter.empty() || name.find(filter) != string::npos; }
+
+    // Time op() (one operation per call) and record the result under name
+    template <typename Op>
+    void run(const string& name, Op op) {
+        if (!selected(name)) return;
+        long batch = 1;
+        while (batch < (1L << 30) && timeBatch(op, batch) < minBatchMs) batch *= 2;
+        for (int i = 0; i < warmupReps; ++i) timeBatch(op, batch);
+        vector<double> nsPerOp;
+        nsPerOp.reserve(reps);
+        for (int i = 0; i < reps; ++i) nsPerOp.push_back(timeBatch(op, batch) * 1e6 / static_cast<double>(batch));
+        results.push_back(summarize(name, batch, std::move(nsPerOp)));
+        const BenchResult& r = results.back();
+        printf("%-40s %12.1f %12.1f %12.1f %10.1f %9ld %5d/%d\n", r.name.c_str(), r.medianNs, r.meanNs,
+               r.minNs, r.stddevNs, r.batch, r.rejected, r.samples);
+        fflush(stdout);
+    }
+
+    static void printHeader() {
+        printf("%-40s %12s %12s %12s %10s %9s %7s\n", "benchmark", "median_ns", "mean_ns", "min_ns",
+               "stddev_ns", "batch", "outliers");
+    }
+
+    const vector<BenchResult>& getResults() const { return results; }
+
+    // Write the results as JSON, one benchmark per line so runs diff cleanly.
+    // params are recorded as given (e.g. scale) to tell runs apart.
+    bool writeJson(const string& path, const vector<pair<string, long>>& params) const {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) {
+            cout << "Failed to open file for writing: " << path << endl;
+            return false;
+        }
+        fprintf(f, "{\n  \"params\": {");
+        for (size_t i = 0; i < params.size(); ++i) {
+            fprintf(f, "%s", i ? ", " : "");
+            jsonString(f, params[i].first);
+            fprintf(f, ": %ld", params[i].second);
+        }
+        fprintf(f, "%s\"reps\": %d, \"warmup\": %d, \"minBatchMs\": %g},\n  \"results\": [\n",
+                params.empty() ? "" : ", ", reps, warmupReps, minBatchMs);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            fprintf(f, "    {\"name\": ");
+            jsonString(f, r.name);
+            fprintf(f, ", \"median_ns\": %.2f, \"mean_ns\": %.2f, \"min_ns\": %.2f, \"max_ns\": %.2f, "
+                       "\"stddev_ns\": %.2f, \"batch\": %ld, \"samples\": %d, \"rejected\": %d}%s\n",
+                    r.medianNs, r.meanNs, r.minNs, r.maxNs, r.stddevNs, r.batch, r.samples, r.rejected,
+                    i + 1 < results.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+        bool ok = fclose(f) == 0;
+        if (!ok) cout << "Failed to write file: " << path << endl;
+        return ok;
+    }
+};
+
+#endif // BENCHHARNESS_H
@@ -0,0 +1,90 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// Small helpers shared by the benchmark programs.
+
+// Wall-clock stopwatch in milliseconds
+class Stopwatch {
+private:
+    chrono::steady_clock::time_point start;
+public:
+    Stopwatch() : start(chrono::steady_clock::now()) {}
+    void reset() { start = chrono::steady_clock::now(); }
+    double elapsedMs() const {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Read a "VmRSS:"/"VmHWM:" style field (kB) from /proc/self/status; -1 if unavailable
+static long procStatusKB(const string& field) {
+    ifstream fin("/proc/self/status");
+    string line;
+    while (getline(fin, line)) {
+        if (line.rfind(field, 0) == 0) {
+            istringstream iss(line.substr(field.size()));
+            long kb = -1;
+            iss >> kb;
+            return kb;
+        }
+    }
+    return -1;
+}
+static long currentRssKB() { return procStatusKB("VmRSS:"); }
+static long peakRssKB() { return procStatusKB("VmHWM:"); }
+
+// Create an empty scratch directory and make it the working directory,
+// so the data files the classes use ("products.txt", ...) land there.
+class ScratchDir {
+private:
+    filesystem::path oldDir;
+    filesystem::path dir;
+public:
+    explicit ScratchDir(const string& name)
+        : oldDir(filesystem::current_path()),
+          dir(filesystem::temp_directory_path() / name) {
+        filesystem::remove_all(dir);
+        filesystem::create_directories(dir);
+        filesystem::current_path(dir);
+    }
+    ~ScratchDir() {
+        filesystem::current_path(oldDir);
+        if (!getenv("BENCH_KEEP_DATA")) filesystem::remove_all(dir);
+    }
+    const filesystem::path& path() const { return dir; }
+};
+
+// Stream buffer that accepts and discards everything
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+// Redirect cout to a discarding buffer while in scope. Formatting still
+// happens, so rendering code is measured without terminal I/O.
+class QuietCout {
+private:
+    NullBuffer nullBuf;
+    streambuf* old;
+public:
+    QuietCout() : old(cout.rdbuf(&nullBuf)) {}
+    ~QuietCout() { cout.rdbuf(old); }
+};
+
+// Parse argv[i] as a count, or return the default
+static long argOr(int argc, char** argv, int i, long def) {
+    if (i < argc) return atol(argv[i]);
+    return def;
+}
+
+#endif // BENCHUTIL_H
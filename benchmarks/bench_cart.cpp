@@ -0,0 +1,152 @@
+// Cart operations and the resident memory of many carts.
+// usage: bench_cart [carts=1000000] [lines=3] [layout=flat|legacy]
+//
+// Operations: each round fills a new cart with `lines` lines, updates every line, prices the
+// cart, serializes it in the cart file format and removes the lines again. Timed for the flat
+// cart (ShoppingCart) and the previous layout (unordered_map<int, vector<int>>), with the heap
+// allocations per round (so per cart) counted, for `lines`, 8 and 20 lines (the last two are
+// past the inline capacity).
+// Memory: builds `carts` resident carts of `lines` lines in the chosen layout. Run the two
+// layouts as separate processes.
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <numeric>
+#include <unordered_map>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../ShoppingCart.h"
+
+// Count heap allocations made through operator new
+static size_t allocationCount = 0;
+void* operator new(size_t n) {
+    ++allocationCount;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// The cart as it was stored before: items[productID][sizeIndex]
+class LegacyCart {
+public:
+    unordered_map<int, vector<int>> items;
+
+    void setQuantity(int productID, Size size, int quantity) {
+        auto it = items.find(productID);
+        if (it == items.end()) {
+            if (quantity <= 0) return;
+            it = items.emplace(productID, vector<int>(6, 0)).first;
+        }
+        it->second[static_cast<int>(size)] = max(quantity, 0);
+        if (all_of(it->second.begin(), it->second.end(), [](int q) { return q == 0; })) items.erase(it);
+    }
+    void removeItem(int productID) { items.erase(productID); }
+    double calculateTotal(const ProductManager& pm) const {
+        double total = 0.0;
+        for (const auto& pair : items) {
+            const Product* p = pm.getProduct(pair.first);
+            if (p) total += p->getPrice() * accumulate(pair.second.begin(), pair.second.end(), 0);
+        }
+        return total;
+    }
+};
+
+static void appendInt(string& out, int value) {
+    char buf[16];
+    out.append(buf, to_chars(buf, buf + sizeof(buf), value).ptr);
+}
+
+// "productID q0 q1 q2 q3 q4 q5\n" per line, as ShoppingCart::saveToFile writes it
+template <typename Quantities>
+static void appendLine(string& out, int productID, const Quantities& qty) {
+    appendInt(out, productID);
+    for (int q : qty) {
+        out += ' ';
+        appendInt(out, q);
+    }
+    out += '\n';
+}
+static void serialize(const ShoppingCart& cart, string& out) {
+    for (const CartLine& line : cart.getItems()) appendLine(out, line.productID, line.qty);
+}
+static void serialize(const LegacyCart& cart, string& out) {
+    for (const auto& pair : cart.items) appendLine(out, pair.first, pair.second);
+}
+
+// Run `rounds` rounds of fill / update / total / serialize / remove, each on a new cart
+template <typename Cart>
+static void timeOps(const char* name, const ProductManager& pm, const vector<int>& ids, long rounds) {
+    string out;
+    out.reserve(1 << 12);
+    double sum = 0;
+    size_t allocsBefore = allocationCount;
+    Stopwatch sw;
+    for (long r = 0; r < rounds; ++r) {
+        Cart cart;
+        for (int id : ids) cart.setQuantity(id, Size::M, 1);
+        for (int id : ids) cart.setQuantity(id, Size::M, 2);
+        sum += cart.calculateTotal(pm);
+        out.clear();
+        serialize(cart, out);
+        sum += out.size();
+        for (int id : ids) cart.removeItem(id);
+    }
+    double ms = sw.elapsedMs();
+    printf("%-28s %8.0f ms %12.0f rounds/s %8.2f allocations/round   (checksum %.0f)\n", name, ms,
+           rounds / (ms / 1000.0), static_cast<double>(allocationCount - allocsBefore) / rounds, sum);
+}
+
+int main(int argc, char** argv) {
+    long cartCount = max(1L, argOr(argc, argv, 1, 1000000));
+    int lines = static_cast<int>(max(1L, argOr(argc, argv, 2, 3)));
+    bool legacy = argc > 3 && strcmp(argv[3], "legacy") == 0;
+    const long productCount = 100000;
+
+    ScratchDir scratch("shop_bench_cart");
+    writeProductsFile(productCount);
+    ProductManager pm;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+    }
+
+    // ops on carts of `lines` lines, and of 8 and 20 (past the inline capacity)
+    vector<int> sizes{lines};
+    for (int n : {8, 20}) {
+        if (n != lines) sizes.push_back(n);
+    }
+    for (int n : sizes) {
+        vector<int> ids;
+        for (int i = 0; i < n; ++i) ids.push_back(1 + (i * 7919) % static_cast<int>(productCount));
+        long rounds = 2000000 / n;
+        printf("%d-line cart:\n", n);
+        timeOps<ShoppingCart>("  ShoppingCart (flat)", pm, ids, rounds);
+        timeOps<LegacyCart>("  unordered_map (legacy)", pm, ids, rounds);
+    }
+
+    // resident carts
+    long before = currentRssKB();
+    Stopwatch sw;
+    if (legacy) {
+        vector<LegacyCart> carts(static_cast<size_t>(cartCount));
+        for (long c = 0; c < cartCount; ++c) {
+            for (int i = 0; i < lines; ++i) carts[c].setQuantity(1 + static_cast<int>((c * 31 + i * 7919) % productCount), Size::M, 1);
+        }
+        long after = currentRssKB();
+        printf("\n%ld legacy carts of %d lines: %.0f ms, %.1f MB, %.0f bytes/cart\n", cartCount, lines,
+               sw.elapsedMs(), (after - before) / 1024.0, (after - before) * 1024.0 / cartCount);
+    } else {
+        vector<ShoppingCart> carts(static_cast<size_t>(cartCount));
+        for (long c = 0; c < cartCount; ++c) {
+            for (int i = 0; i < lines; ++i) carts[c].setQuantity(1 + static_cast<int>((c * 31 + i * 7919) % productCount), Size::M, 1);
+        }
+        long after = currentRssKB();
+        printf("\n%ld flat carts of %d lines: %.0f ms, %.1f MB, %.0f bytes/cart\n", cartCount, lines,
+               sw.elapsedMs(), (after - before) / 1024.0, (after - before) * 1024.0 / cartCount);
+    }
+    return 0;
+}
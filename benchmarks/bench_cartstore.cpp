@@ -0,0 +1,88 @@
+// Cart persistence: one cart_<userID>.txt per user against the single CartStore log.
+// usage: bench_cartstore [users=50000] [saves=200000]
+//
+// Every save is one cart change (the menu saves after each add/update/remove) by a random user
+// with a 1-5 line cart. "write-behind" is the application's setting: saves are queued and
+// appended in batches; "write-through" appends every save on its own. Also timed: loading carts,
+// opening a store (replaying the log) and migrating per-user files into a store.
+
+#include <random>
+
+#include "BenchUtil.h"
+#include "../CartStore.h"
+
+static void report(const char* name, long ops, double ms) {
+    printf("%-44s %8.0f ms %12.0f ops/s\n", name, ms, ops / (ms / 1000.0));
+}
+
+static long fileBytes(const string& path) {
+    error_code ec;
+    auto size = filesystem::file_size(path, ec);
+    return ec ? 0 : static_cast<long>(size);
+}
+
+int main(int argc, char** argv) {
+    long userCount = max(1L, argOr(argc, argv, 1, 50000));
+    long saveCount = max(1L, argOr(argc, argv, 2, 200000));
+
+    ScratchDir scratch("shop_bench_cartstore");
+    filesystem::create_directory("legacy");
+
+    // a fixed cart per user, and the order in which users save
+    vector<ShoppingCart> carts(static_cast<size_t>(userCount) + 1);
+    mt19937 rng(42);
+    for (long u = 1; u <= userCount; ++u) {
+        int lines = 1 + static_cast<int>(rng() % 5);
+        for (int i = 0; i < lines; ++i) {
+            carts[u].setQuantity(1 + static_cast<int>(rng() % 100000), static_cast<Size>(rng() % 6), 1 + static_cast<int>(rng() % 3));
+        }
+    }
+    vector<int> order(static_cast<size_t>(saveCount));
+    for (int& u : order) u = 1 + static_cast<int>(rng() % userCount);
+    printf("%ld users, %ld saves\n\n", userCount, saveCount);
+
+    {
+        Stopwatch sw;
+        for (int u : order) carts[u].saveToFile("legacy/" + ShoppingCart::getShoppingCartFileName(u));
+        report("save: per-user files", saveCount, sw.elapsedMs());
+    }
+    {
+        CartStore store("through.log");
+        store.setFlushInterval(0);
+        Stopwatch sw;
+        for (int u : order) store.save(u, carts[u]);
+        report("save: CartStore write-through", saveCount, sw.elapsedMs());
+    }
+    {
+        CartStore store("carts.log");
+        Stopwatch sw;
+        for (int u : order) store.save(u, carts[u]);
+        store.flush();
+        report("save: CartStore write-behind", saveCount, sw.elapsedMs());
+    }
+    printf("carts.log: %.1f MB\n\n", fileBytes("carts.log") / 1048576.0);
+
+    {
+        ShoppingCart cart;
+        Stopwatch sw;
+        for (int u : order) cart.loadFromFile("legacy/" + ShoppingCart::getShoppingCartFileName(u));
+        report("load: per-user files", saveCount, sw.elapsedMs());
+    }
+    {
+        Stopwatch sw;
+        CartStore store("carts.log");
+        store.ensureLoaded();
+        report("open: replay carts.log (carts)", static_cast<long>(store.cartCount()), sw.elapsedMs());
+        ShoppingCart cart;
+        sw.reset();
+        for (int u : order) store.load(u, cart);
+        report("load: CartStore", saveCount, sw.elapsedMs());
+    }
+    {
+        CartStore store("migrated.log");
+        Stopwatch sw;
+        size_t moved = store.migrateLegacyFiles("legacy");
+        report("migrate: per-user files (files)", static_cast<long>(moved), sw.elapsedMs());
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Catalog lookups: dense ID-indexed table vs the previous nested hash layout.
+// usage: bench_catalog [products=1000000] [lookups=10000000]
+//
+// "legacy" is a copy of the old ProductManager storage
+// (vector<vector<unordered_map<int,Product>>> + productID->category map)
+// with the same getProduct / displayByCategory / checkStock loops.
+
+#include <map>
+#include <random>
+#include <unordered_map>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../ProductManager.h"
+#include "../ShoppingCart.h"
+#include "../Transaction.h"
+
+struct LegacyCatalog {
+    vector<vector<unordered_map<int, Product>>> products;
+    unordered_map<int, int> categoryOf;    // old ProductManager::map
+
+    LegacyCatalog() : products(4, vector<unordered_map<int, Product>>(3)) {}
+
+    static int sectionIndex(Category cat, Section sec) {
+        if (cat == Category::Kids) return sec == Section::Boys ? 0 : sec == Section::Girls ? 1 : 2;
+        if (cat == Category::Other) return 2;
+        return sec == Section::Eastern ? 0 : sec == Section::Western ? 1 : 2;
+    }
+    void add(const Product& p) {
+        int cat = static_cast<int>(p.getCategory());
+        products[cat][sectionIndex(p.getCategory(), p.getSection())][p.getProductID()] = p;
+        categoryOf[p.getProductID()] = cat;
+    }
+    const Product* getProduct(int productID) const {
+        auto it = categoryOf.find(productID);
+        if (it == categoryOf.end()) return nullptr;
+        for (const auto& secMap : products[it->second]) {
+            auto prodIt = secMap.find(productID);
+            if (prodIt != secMap.end()) return &(prodIt->second);
+        }
+        return nullptr;
+    }
+    void displayByCategory(Category cat) const {
+        cout << "Products in category: " << categoryToString(cat) << endl;
+        for (const auto& secMap : products[static_cast<int>(cat)]) {
+            for (const auto& pair : secMap) {
+                const Product& p = pair.second;
+                cout << "ID: " << p.getProductID() << ", Name: " << p.getProductName()
+                     << ", Section: " << sectionToString(p.getSection())
+                     << ", Price: " << p.getPrice() << ", Total Stock: " << p.getTotalStock();
+                vector<int> stock(p.getSizeStock().begin(), p.getSizeStock().end());  // old copy
+                if (p.getHasSize()) {
+                    cout << ", Stock for size XS: " << stock[0] << ", S: " << stock[1]
+                         << ", M: " << stock[2] << ", L: " << stock[3] << ", XL: " << stock[4];
+                }
+                cout << endl;
+            }
+        }
+    }
+    map<int, vector<pair<Size, int>>> checkStock(const ShoppingCart& cart) const {
+        map<int, vector<pair<Size, int>>> shortages;
+        for (const auto& line : cart.getItems()) {
+            const Product* p = getProduct(line.productID);
+            if (!p) continue;
+            const auto& stock = p->getSizeStock();
+            vector<pair<Size, int>> itemShortages;
+            for (int i = 0; i < 6; ++i) {
+                int qty = line.qty[i];
+                if (qty > 0 && qty > stock[i]) itemShortages.push_back({static_cast<Size>(i), qty - stock[i]});
+            }
+            if (!itemShortages.empty()) shortages[line.productID] = itemShortages;
+        }
+        return shortages;
+    }
+};
+
+static void report(const char* op, const char* layout, double ms, long ops) {
+    printf("%-20s %-8s %10.1f ms %12.1f ns/op\n", op, layout, ms, ms * 1e6 / ops);
+}
+
+int main(int argc, char** argv) {
+    long productCount = argOr(argc, argv, 1, 1000000);
+    long lookups = argOr(argc, argv, 2, 10000000);
+
+    ScratchDir scratch("shop_bench_catalog");
+    writeProductsFile(productCount);
+    writeCartFile("cart.txt", 20, productCount);
+
+    ProductManager pm;
+    LegacyCatalog legacy;
+    ShoppingCart cart;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+        cart.loadFromFile("cart.txt");
+    }
+    for (long id = 1; id <= productCount; ++id) legacy.add(*pm.getProduct(static_cast<int>(id)));
+    cout << "products: " << pm.getProductCount() << endl;
+
+    // random getProduct
+    vector<int> ids(1 << 16);
+    mt19937 rng(1);
+    uniform_int_distribution<int> dist(1, static_cast<int>(productCount));
+    for (int& id : ids) id = dist(rng);
+    const ProductManager& cpm = pm;
+    double sum = 0;
+    Stopwatch sw;
+    for (long i = 0; i < lookups; ++i) sum += cpm.getProduct(ids[i & 0xFFFF])->getPrice();
+    report("getProduct", "flat", sw.elapsedMs(), lookups);
+    sw.reset();
+    for (long i = 0; i < lookups; ++i) sum += legacy.getProduct(ids[i & 0xFFFF])->getPrice();
+    report("getProduct", "legacy", sw.elapsedMs(), lookups);
+
+    // full category listing into a discarding stream
+    {
+        QuietCout quiet;
+        sw.reset();
+        for (int c = 0; c < 4; ++c) pm.displayByCategory(static_cast<Category>(c));
+        double flatMs = sw.elapsedMs();
+        sw.reset();
+        for (int c = 0; c < 4; ++c) legacy.displayByCategory(static_cast<Category>(c));
+        double legacyMs = sw.elapsedMs();
+        report("displayByCategory", "flat", flatMs, productCount);
+        report("displayByCategory", "legacy", legacyMs, productCount);
+    }
+
+    // stock check of a 20-line cart
+    TransactionManager txm;
+    long rounds = lookups / 20;
+    size_t shortageCount = 0;
+    sw.reset();
+    for (long r = 0; r < rounds; ++r) shortageCount += txm.checkStock(cart, pm).size();
+    report("checkStock(20 lines)", "flat", sw.elapsedMs(), rounds);
+    sw.reset();
+    for (long r = 0; r < rounds; ++r) shortageCount += legacy.checkStock(cart).size();
+    report("checkStock(20 lines)", "legacy", sw.elapsedMs(), rounds);
+
+    cout << "(checksum " << sum << ", " << shortageCount << ")" << endl;
+    return 0;
+}
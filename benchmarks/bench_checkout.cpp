@@ -0,0 +1,139 @@
+// Concurrent checkout: correctness under contention and throughput by thread count.
+// usage: bench_checkout [maxThreads=8] [checkoutsPerThread=20000] [products=1000]
+//
+// Stress: many threads check out random carts from a small catalog until the stock
+// runs dry; afterwards every size must satisfy initial - final == units recorded in
+// the committed transactions, and no counter may be negative. Exits with 1 otherwise.
+// Throughput: the same carts against unlimited stock, with 1..maxThreads shoppers,
+// for commitCheckout() as is and wrapped in one global lock (the pre-atomic behaviour).
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+
+static const int CART_COUNT = 64;
+
+// CART_COUNT carts of 1..4 lines over products 1..productCount
+static vector<ShoppingCart> makeCarts(long productCount) {
+    vector<ShoppingCart> carts(CART_COUNT);
+    QuietCout quiet;
+    for (int i = 0; i < CART_COUNT; ++i) {
+        writeCartFile("cart.txt", 1 + i % 4, productCount, 100 + i);
+        carts[i].loadFromFile("cart.txt");
+    }
+    return carts;
+}
+
+// threads x perThread checkouts of random carts; returns successful checkouts
+static long runShoppers(ProductManager& pm, TransactionStore& store, const vector<ShoppingCart>& carts,
+                        int threads, int perThread, mutex* globalLock) {
+    atomic<long> committed(0);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            TransactionManager txm(2 + t, store);
+            mt19937 rng(1234 + t);
+            long ok = 0;
+            for (int i = 0; i < perThread; ++i) {
+                const ShoppingCart& cart = carts[rng() % carts.size()];
+                CheckoutStatus status;
+                if (globalLock) {
+                    lock_guard<mutex> guard(*globalLock);
+                    status = txm.commitCheckout(cart, pm, 1, false);
+                } else {
+                    status = txm.commitCheckout(cart, pm, 1, false);
+                }
+                if (status == CheckoutStatus::Success) ++ok;
+            }
+            committed += ok;
+        });
+    }
+    for (auto& w : workers) w.join();
+    return committed;
+}
+
+static bool stressNoOversell(int threads, long productCount) {
+    writeProductsFile(productCount);
+    writeTransactionFile(0, 1);
+    ProductManager pm;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+    }
+    vector<SizeStock> initial(productCount + 1);
+    for (long id = 1; id <= productCount; ++id) initial[id] = pm.getProduct(id)->getSizeStock();
+
+    TransactionStore store("TransactionRecord.txt");
+    store.reload();
+    vector<ShoppingCart> carts = makeCarts(productCount);
+    // far more attempts than the stock can serve, so every thread keeps hitting empty sizes
+    long committed = runShoppers(pm, store, carts, threads, 4000, nullptr);
+
+    vector<SizeStock> sold(productCount + 1, SizeStock{});
+    set<int> ids;
+    for (const auto& tx : store.all()) {
+        ids.insert(tx.getTransactionID());
+        for (const auto& item : tx.getItems()) {
+            for (int i = 0; i < 6; ++i) sold[item.productID][i] += item.quantities[i];
+        }
+    }
+
+    bool ok = static_cast<long>(store.all().size()) == committed &&
+              static_cast<long>(ids.size()) == committed;
+    long units = 0;
+    for (long id = 1; id <= productCount; ++id) {
+        SizeStock now = pm.getProduct(id)->getSizeStock();
+        for (int i = 0; i < 6; ++i) {
+            units += sold[id][i];
+            if (now[i] < 0 || initial[id][i] - now[i] != sold[id][i]) {
+                printf("MISMATCH product %ld size %d: initial %d now %d sold %d\n",
+                       id, i, initial[id][i], now[i], sold[id][i]);
+                ok = false;
+            }
+        }
+    }
+    printf("stress: %d threads, %ld checkouts, %ld units sold, %zu unique IDs -> %s\n",
+           threads, committed, units, ids.size(), ok ? "OK (no oversell)" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = static_cast<int>(argOr(argc, argv, 1, 8));
+    int perThread = static_cast<int>(argOr(argc, argv, 2, 20000));
+    long productCount = argOr(argc, argv, 3, 1000);
+
+    ScratchDir scratch("shop_bench_checkout");
+    bool ok = stressNoOversell(maxThreads, 200);
+
+    writeProductsFile(productCount);
+    ProductManager pm;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+    }
+    SizeStock plenty;
+    plenty.fill(1 << 30);
+    for (long id = 1; id <= productCount; ++id) pm.getProduct(id)->setSizeStock(plenty);
+    vector<ShoppingCart> carts = makeCarts(productCount);
+
+    cout << "\nthreads   atomic_checkouts/s   global_lock_checkouts/s" << endl;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double rate[2];
+        for (int locked = 0; locked < 2; ++locked) {
+            writeTransactionFile(0, 1);
+            TransactionStore store("TransactionRecord.txt");
+            store.reload();
+            mutex globalLock;
+            Stopwatch sw;
+            long n = runShoppers(pm, store, carts, threads, perThread, locked ? &globalLock : nullptr);
+            rate[locked] = n / (sw.elapsedMs() / 1000.0);
+        }
+        printf("%-9d %18.0f   %23.0f\n", threads, rate[0], rate[1]);
+    }
+    return ok ? 0 : 1;
+}
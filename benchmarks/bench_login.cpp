@@ -0,0 +1,69 @@
+// Login / registration throughput as the number of accounts grows.
+// usage: bench_login [maxUsers=1000000] [logins=100000]
+//
+// "indexed" is User::login / User::registerUser on a UserList (hash lookup);
+// "scan" replays the old per-call loop over every account for comparison.
+
+#include <random>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../User.h"
+
+// The pre-index login: compare every account until one matches
+static const User* scanLogin(const UserList& users, const string& name, const string& pwd) {
+    for (const auto& u : users) {
+        if (u.username == name && u.password == pwd) return &u;
+    }
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    long maxUsers = argOr(argc, argv, 1, 1000000);
+    long logins = argOr(argc, argv, 2, 100000);
+
+    ScratchDir scratch("shop_bench_login");
+    writeTransactionFile(0, 1);
+    cout << "users       load_ms   indexed_logins/s   scan_logins/s   indexed_registers/s" << endl;
+    for (long n = 1000; n <= maxUsers; n *= 10) {
+        writeUsersFile(n);
+        UserList users;
+        int nextUserID = 0;
+        Stopwatch loadSw;
+        User::loadAll(users, nextUserID);
+        double loadMs = loadSw.elapsedMs();
+
+        mt19937 rng(99);
+        uniform_int_distribution<long> pick(2, n);
+        long found = 0;
+        double indexedRate, scanRate, registerRate;
+        {
+            QuietCout quiet;
+            Stopwatch sw;
+            for (long i = 0; i < logins; ++i) {
+                long id = pick(rng);
+                if (User::login(users, "user" + to_string(id), "pass" + to_string(id))) ++found;
+            }
+            indexedRate = logins / (sw.elapsedMs() / 1000.0);
+
+            // the scan is O(n) per login; keep its total work bounded
+            long scans = max(10L, min(logins, 200000000L / n));
+            Stopwatch scanSw;
+            for (long i = 0; i < scans; ++i) {
+                long id = pick(rng);
+                if (scanLogin(users, "user" + to_string(id), "pass" + to_string(id))) ++found;
+            }
+            scanRate = scans / (scanSw.elapsedMs() / 1000.0);
+
+            long registers = min(logins, 10000L);
+            Stopwatch regSw;
+            for (long i = 0; i < registers; ++i) {
+                User::registerUser(users, nextUserID, "new" + to_string(i), "pass1234");
+            }
+            registerRate = registers / (regSw.elapsedMs() / 1000.0);
+        }
+        printf("%-10ld %8.1f %18.0f %15.0f %21.0f\n", n, loadMs, indexedRate, scanRate, registerRate);
+        if (found == 0) printf("  (no login succeeded - check the generated users file)\n");
+    }
+    return 0;
+}
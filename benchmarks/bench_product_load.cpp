@@ -0,0 +1,81 @@
+// Loading products.txt: in-place from_chars parser vs the old split-and-stoi parser.
+// usage: bench_product_load [count=10000000]
+//
+// "load" is ProductManager::loadFromFile (mapping, parsing and building the catalog).
+// "legacy parse" only tokenizes the same file the old way (getline, substr/erase,
+// stoi/stod) without building anything, so it is a lower bound for the old loader.
+
+#include <fstream>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../ProductManager.h"
+
+static long legacyParse(const char* path) {
+    ifstream file(path);
+    string line;
+    getline(file, line);
+    long parsed = 0;
+    while (getline(file, line)) {
+        if (line.empty()) continue;
+        size_t pos = 0;
+        vector<string> tokens;
+        string tmp = line;
+        while ((pos = tmp.find(',')) != string::npos) {
+            tokens.push_back(tmp.substr(0, pos));
+            tmp.erase(0, pos + 1);
+        }
+        tokens.push_back(tmp);
+        if (tokens.size() < 11) continue;
+        int sum = stoi(tokens[0]) + stoi(tokens[2]) + stoi(tokens[3]);
+        double price = stod(tokens[4]);
+        for (size_t i = 5; i < 11; ++i) sum += stoi(tokens[i]);
+        if (sum >= 0 && price >= 0) ++parsed;
+    }
+    return parsed;
+}
+
+int main(int argc, char** argv) {
+    long count = argOr(argc, argv, 1, 10000000);
+
+    ScratchDir scratch("shop_bench_product_load");
+    cout << "generating " << count << " products..." << endl;
+    writeProductsFile(count);
+    double mb = 0;
+    {
+        ifstream f("products.txt", ios::binary | ios::ate);
+        mb = static_cast<double>(f.tellg()) / (1024.0 * 1024.0);
+    }
+
+    {
+        ProductManager pm;
+        Stopwatch sw;
+        {
+            QuietCout quiet;
+            pm.loadFromFile("products.txt");
+        }
+        double ms = sw.elapsedMs();
+        printf("load:          %10.0f ms  %6.1f M products/s  %7.1f MB/s  (%zu products, peak RSS %ld MB)\n",
+               ms, pm.getProductCount() / ms / 1000.0, mb / (ms / 1000.0),
+               pm.getProductCount(), peakRssKB() / 1024);
+    }
+    {
+        Stopwatch sw;
+        long parsed = legacyParse("products.txt");
+        double ms = sw.elapsedMs();
+        printf("legacy parse:  %10.0f ms  %6.1f M products/s  %7.1f MB/s  (%ld records)\n",
+               ms, parsed / ms / 1000.0, mb / (ms / 1000.0), parsed);
+    }
+
+    // malformed lines are reported and skipped, the rest still loads
+    {
+        FILE* f = fopen("bad.txt", "w");
+        fprintf(f, "5\n1,Good,0,0,10,1,2,3,4,5,0\n2,Short,0,0\nx,Bad,0,0,10,1,1,1,1,1,0\n"
+                   "3,BadPrice,0,0,1o,1,1,1,1,1,0\n4,Good2,1,1,20.5,0,0,0,0,0,7\r\n");
+        fclose(f);
+        ProductManager pm;
+        pm.loadFromFile("bad.txt");
+        printf("malformed file: %zu of 4 product lines loaded (expected 2)\n", pm.getProductCount());
+    }
+    return 0;
+}
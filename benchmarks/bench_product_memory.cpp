@@ -0,0 +1,70 @@
+// Resident memory per product for the catalog.
+// usage: bench_product_memory [products=10000000] [layout=flat|legacy]
+//
+// "flat" loads a generated products.txt into ProductManager.
+// "legacy" builds the previous layout in memory for comparison: a Product with
+// a std::string name and a heap vector<int> for stock, inside
+// vector<vector<unordered_map<int,Product>>> plus the productID->category map
+// and the name->ID map. Run the two layouts as separate processes.
+
+#include <cstring>
+#include <unordered_map>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../ProductManager.h"
+
+struct LegacyProduct {
+    int productID;
+    string productName;
+    int category;
+    int section;
+    vector<int> sizeStock;
+    bool hasSize;
+    double price;
+};
+
+int main(int argc, char** argv) {
+    long productCount = argOr(argc, argv, 1, 10000000);
+    bool legacy = argc > 2 && strcmp(argv[2], "legacy") == 0;
+
+    if (legacy) {
+        long before = currentRssKB();
+        vector<vector<unordered_map<int, LegacyProduct>>> products(4, vector<unordered_map<int, LegacyProduct>>(3));
+        unordered_map<int, int> categoryOf;
+        unordered_map<string, int> nameMap;
+        for (long id = 1; id <= productCount; ++id) {
+            int cat = static_cast<int>(id % 4);
+            string name = "Product_" + to_string(id);
+            LegacyProduct p{static_cast<int>(id), name, cat, 0, vector<int>(6, 5), true, 10.0};
+            products[cat][(id / 4) % 3][static_cast<int>(id)] = p;
+            categoryOf[static_cast<int>(id)] = cat;
+            nameMap[name] = static_cast<int>(id);
+        }
+        long after = currentRssKB();
+        printf("layout:             legacy\n");
+        printf("products:           %ld\n", productCount);
+        printf("sizeof(Product):    %zu bytes (+ heap stock vector and name)\n", sizeof(LegacyProduct));
+        printf("RSS growth:         %ld kB\n", after - before);
+        printf("bytes per product:  %.1f\n", (after - before) * 1024.0 / productCount);
+        return 0;
+    }
+
+    ScratchDir scratch("shop_bench_product_memory");
+    writeProductsFile(productCount);
+    long before = currentRssKB();
+    ProductManager pm;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+    }
+    long after = currentRssKB();
+    printf("layout:             flat\n");
+    printf("products:           %zu\n", pm.getProductCount());
+    printf("sizeof(Product):    %zu bytes (stock inline, name interned)\n", sizeof(Product));
+    printf("name table:         %zu names, ~%zu kB\n", NameTable::size(), NameTable::memoryUsage() / 1024);
+    printf("RSS growth:         %ld kB\n", after - before);
+    printf("bytes per product:  %.1f (table, section lists, name table, name index)\n",
+           (after - before) * 1024.0 / pm.getProductCount());
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Rendering throughput of the product listing and the transaction views, in rows per second.
+// usage: bench_render [products=200000] [transactions=200000]
+//
+// "endl" rows are the old way of rendering: field by field to cout with endl on every line,
+// so every row is a flush (a write() call). Everything else renders through an OutputSink,
+// which hands text to its destination in 64 KB blocks. cout is redirected to a scratch file
+// so the console cases measure the write path without a terminal.
+
+#include <fstream>
+#include <random>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../OutputSink.h"
+#include "../TransactionStore.h"
+
+// cout into a file while in scope
+class CoutToFile {
+private:
+    ofstream file;
+    streambuf* old;
+public:
+    explicit CoutToFile(const string& path) : file(path, ios::binary | ios::trunc), old(cout.rdbuf(file.rdbuf())) {}
+    ~CoutToFile() { cout.rdbuf(old); }
+};
+
+// The listing as displayAllProducts() printed it before the sinks: cout and endl per row
+static void oldDisplayAllProducts(const ProductManager& pm) {
+    cout << "All products in the system:" << endl;
+    for (int catIdx = 0; catIdx < 4; ++catIdx) {
+        Category cat = static_cast<Category>(catIdx);
+        cout << "Category: " << categoryToString(cat) << endl;
+        for (Section sec : {Section::Eastern, Section::Western, Section::Boys, Section::Girls, Section::Other}) {
+            if (cat == Category::Other && sec != Section::Other) continue;
+            const vector<int>& ids = pm.getSectionProductIDs(cat, sec);
+            if (ids.empty()) continue;
+            cout << "  Section: " << sectionToString(sec) << endl;
+            for (int id : ids) {
+                const Product& p = *pm.getProduct(id);
+                cout << "    ID: " << p.getProductID()
+                     << ", Name: " << p.getProductName()
+                     << ", Price: " << p.getPrice()
+                     << ", Total Stock: " << p.getTotalStock();
+                const SizeStock& stock = p.getSizeStock();
+                if (p.getHasSize()) {
+                    cout << ", Stock for size XS: " << stock[0]
+                         << ", S: " << stock[1]
+                         << ", M: " << stock[2]
+                         << ", L: " << stock[3]
+                         << ", XL: " << stock[4];
+                }
+                cout << endl;
+            }
+        }
+    }
+}
+
+static const char* const OUT_FILE = "out.txt";
+
+// Time one rendering of `rows` rows and print rows/s. render() returns the bytes it kept in
+// memory; 0 means it wrote OUT_FILE.
+template <typename Render>
+static void timeRender(const char* name, long rows, Render render) {
+    Stopwatch sw;
+    size_t bytes = render();
+    double ms = sw.elapsedMs();
+    error_code ec;
+    if (bytes == 0) bytes = static_cast<size_t>(filesystem::file_size(OUT_FILE, ec));
+    printf("%-50s %8.0f ms %12.0f rows/s %8.1f MB\n", name, ms, rows / (ms / 1000.0), bytes / 1048576.0);
+}
+
+int main(int argc, char** argv) {
+    long productCount = max(1L, argOr(argc, argv, 1, 200000));
+    long txCount = max(1L, argOr(argc, argv, 2, 200000));
+
+    ScratchDir scratch("shop_bench_render");
+    writeProductsFile(productCount);
+    writeTransactionFile(txCount, 1000);
+    ProductManager pm;
+    TransactionStore store("TransactionRecord.txt");
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+        store.reload();
+    }
+    TransactionManager admin(-1, store);
+    printf("%ld products, %ld transactions\n\n", productCount, txCount);
+
+    timeRender("product listing: cout + endl (old)", productCount, [&]() -> size_t {
+        CoutToFile redirect(OUT_FILE);
+        oldDisplayAllProducts(pm);
+        return 0;
+    });
+    timeRender("product listing: displayAllProducts()", productCount, [&]() -> size_t {
+        CoutToFile redirect(OUT_FILE);
+        pm.displayAllProducts();
+        return 0;
+    });
+    timeRender("product listing: FileSink", productCount, [&]() -> size_t {
+        FileSink sink(OUT_FILE);
+        pm.displayAllProducts(sink.stream());
+        return 0;
+    });
+    timeRender("product listing: StringSink", productCount, [&]() -> size_t {
+        StringSink sink;
+        pm.displayAllProducts(sink.stream());
+        return sink.str().size();
+    });
+
+    // ~80-byte buffer: about one write per line, what endl did
+    timeRender("transaction summary: FileSink, 80 B buffer", txCount, [&]() -> size_t {
+        FileSink sink(OUT_FILE, 80);
+        admin.displayTransactionSummary(sink.stream());
+        return 0;
+    });
+    timeRender("transaction summary: displayTransactionSummary()", txCount, [&]() -> size_t {
+        CoutToFile redirect(OUT_FILE);
+        admin.displayTransactionSummary();
+        return 0;
+    });
+    timeRender("transaction summary: FileSink", txCount, [&]() -> size_t {
+        FileSink sink(OUT_FILE);
+        admin.displayTransactionSummary(sink.stream());
+        return 0;
+    });
+
+    timeRender("invoices: FileSink, 80 B buffer", txCount, [&]() -> size_t {
+        FileSink sink(OUT_FILE, 80);
+        admin.displayAllTransactions(sink.stream());
+        return 0;
+    });
+    timeRender("invoices: displayAllTransactions()", txCount, [&]() -> size_t {
+        CoutToFile redirect(OUT_FILE);
+        admin.displayAllTransactions();
+        return 0;
+    });
+    timeRender("invoices: FileSink", txCount, [&]() -> size_t {
+        FileSink sink(OUT_FILE);
+        admin.displayAllTransactions(sink.stream());
+        return 0;
+    });
+    timeRender("invoices: StringSink", txCount, [&]() -> size_t {
+        StringSink sink;
+        admin.displayAllTransactions(sink.stream());
+        return sink.str().size();
+    });
+    return 0;
+}
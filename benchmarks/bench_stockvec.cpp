@@ -0,0 +1,188 @@
+// Six-size stock arithmetic: one slot at a time against StockVec (scalar and SSE2 builds).
+// usage: bench_stockvec [products=1000000] [cartLines=200000] [reps=20]
+//
+// Kernels, each over the whole catalog or one large cart:
+//   total stock    sum of the sizes of every product (Product::getTotalStock)
+//   stock check    which sizes of each cart line are short, and by how much (checkStock)
+//   deduction      stock left after taking each cart line, if every size is available
+// "per slot" is the loop the code used before StockVec. The checks run against the live
+// catalog (six atomic loads per product) and against a plain SizeStock copy of it, which
+// isolates the arithmetic.
+
+#include <random>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+
+static void report(const char* name, long items, int reps, double ms, long checksum) {
+    double perItem = ms * 1e6 / (static_cast<double>(items) * reps);
+    printf("%-44s %8.1f ms %8.2f ns/item   (checksum %ld)\n", name, ms, perItem, checksum);
+}
+
+// ---- per slot ----
+static int totalPerSlot(const SizeStock& stock, bool hasSize) {
+    if (!hasSize) return stock[5];
+    int total = 0;
+    for (int i = 0; i < 5; ++i) total += stock[i];
+    return total;
+}
+static long checkPerSlot(const SizeStock& want, const SizeStock& have) {
+    long missing = 0;
+    for (int i = 0; i < 6; ++i) {
+        if (want[i] > 0 && want[i] > have[i]) missing += want[i] - have[i];
+    }
+    return missing;
+}
+static bool deductPerSlot(const SizeStock& want, SizeStock& have) {
+    for (int i = 0; i < 6; ++i) {
+        if (want[i] > have[i]) return false;
+    }
+    for (int i = 0; i < 6; ++i) have[i] -= want[i];
+    return true;
+}
+
+// ---- StockVec (either implementation) ----
+template <typename Vec>
+static int totalVec(const SizeStock& stock, bool hasSize) {
+    if (!hasSize) return stock[5];
+    return Vec(stock).sum() - stock[5];
+}
+template <typename Vec>
+static long checkVec(const SizeStock& want, const SizeStock& have) {
+    Vec w = Vec(want).clampNegative();
+    Vec missing = w.shortage(Vec(have));
+    if ((missing.positiveMask() & w.positiveMask()) == 0) return 0;
+    return missing.sum();
+}
+template <typename Vec>
+static bool deductVec(const SizeStock& want, SizeStock& have) {
+    Vec h(have), w(want);
+    if (w.greaterThan(h) != 0) return false;
+    have = (h - w).toArray();
+    return true;
+}
+
+int main(int argc, char** argv) {
+    long productCount = max(1L, argOr(argc, argv, 1, 1000000));
+    long lineCount = max(1L, argOr(argc, argv, 2, 200000));
+    int reps = static_cast<int>(max(1L, argOr(argc, argv, 3, 20)));
+
+    ScratchDir scratch("shop_bench_stockvec");
+    writeProductsFile(productCount);
+    ProductManager pm;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+    }
+    vector<const Product*> products;
+    vector<SizeStock> stocks;
+    vector<char> hasSize;
+    for (long id = 1; id <= productCount; ++id) {
+        const Product* p = pm.getProduct(static_cast<int>(id));
+        products.push_back(p);
+        stocks.push_back(p->getSizeStock());
+        hasSize.push_back(p->getHasSize());
+    }
+
+    // one large cart; quantities 1-30 so that some sizes are short
+    ShoppingCart cart;
+    mt19937 rng(7);
+    while (static_cast<long>(cart.getItems().size()) < min(lineCount, productCount)) {
+        int id = 1 + static_cast<int>(rng() % productCount);
+        Size size = products[id - 1]->getHasSize() ? static_cast<Size>(rng() % 5) : Size::None;
+        cart.setQuantity(id, size, 1 + static_cast<int>(rng() % 30));
+    }
+    const CartLines& lines = cart.getItems();
+    long cartLines = static_cast<long>(lines.size());
+#ifdef SHOP_SIMD_STOCK
+    const char* simd = "SSE2";
+#else
+    const char* simd = "none (scalar build)";
+#endif
+    printf("%ld products, %ld cart lines, %d reps, StockVec SIMD: %s\n\n", productCount, cartLines, reps, simd);
+
+    auto run = [&](const char* name, long items, auto kernel) {
+        long checksum = 0;
+        Stopwatch sw;
+        for (int r = 0; r < reps; ++r) checksum += kernel();
+        report(name, items, reps, sw.elapsedMs(), checksum);
+    };
+
+    run("total stock, catalog: per slot", productCount, [&]() {
+        long sum = 0;
+        for (size_t i = 0; i < stocks.size(); ++i) sum += totalPerSlot(stocks[i], hasSize[i]);
+        return sum;
+    });
+    run("total stock, catalog: ScalarStockVec", productCount, [&]() {
+        long sum = 0;
+        for (size_t i = 0; i < stocks.size(); ++i) sum += totalVec<ScalarStockVec>(stocks[i], hasSize[i]);
+        return sum;
+    });
+    run("total stock, catalog: StockVec", productCount, [&]() {
+        long sum = 0;
+        for (size_t i = 0; i < stocks.size(); ++i) sum += totalVec<StockVec>(stocks[i], hasSize[i]);
+        return sum;
+    });
+    run("total stock, live: Product::getTotalStock", productCount, [&]() {
+        long sum = 0;
+        for (const Product* p : products) sum += p->getTotalStock();
+        return sum;
+    });
+    printf("\n");
+
+    run("stock check, live: per slot", cartLines, [&]() {
+        long missing = 0;
+        for (const CartLine& line : lines) missing += checkPerSlot(line.qty, pm.getProduct(line.productID)->getSizeStock());
+        return missing;
+    });
+    run("stock check, live: StockVec", cartLines, [&]() {
+        long missing = 0;
+        for (const CartLine& line : lines) {
+            StockVec want = StockVec(line.qty).clampNegative();
+            StockVec missingHere = want.shortage(pm.getProduct(line.productID)->getStockVec());
+            if ((missingHere.positiveMask() & want.positiveMask()) != 0) missing += missingHere.sum();
+        }
+        return missing;
+    });
+    run("stock check, snapshot: per slot", cartLines, [&]() {
+        long missing = 0;
+        for (const CartLine& line : lines) missing += checkPerSlot(line.qty, stocks[line.productID - 1]);
+        return missing;
+    });
+    run("stock check, snapshot: ScalarStockVec", cartLines, [&]() {
+        long missing = 0;
+        for (const CartLine& line : lines) missing += checkVec<ScalarStockVec>(line.qty, stocks[line.productID - 1]);
+        return missing;
+    });
+    run("stock check, snapshot: StockVec", cartLines, [&]() {
+        long missing = 0;
+        for (const CartLine& line : lines) missing += checkVec<StockVec>(line.qty, stocks[line.productID - 1]);
+        return missing;
+    });
+    TransactionStore store("TransactionRecord.txt");
+    TransactionManager txm(2, store);
+    run("checkStock() (builds the shortage list)", cartLines, [&]() {
+        return static_cast<long>(txm.checkStock(cart, pm).size());
+    });
+    printf("\n");
+
+    // deduction on a copy of the snapshot, restored (untimed) before every rep so each rep
+    // does the same work
+    vector<SizeStock> work;
+    auto deduct = [&](const char* name, auto kernel) {
+        long taken = 0;
+        double ms = 0;
+        for (int r = 0; r < reps; ++r) {
+            work = stocks;
+            Stopwatch sw;
+            for (const CartLine& line : lines) taken += kernel(line.qty, work[line.productID - 1]);
+            ms += sw.elapsedMs();
+        }
+        report(name, cartLines, reps, ms, taken);
+    };
+    deduct("deduction, snapshot: per slot", deductPerSlot);
+    deduct("deduction, snapshot: ScalarStockVec", deductVec<ScalarStockVec>);
+    deduct("deduction, snapshot: StockVec", deductVec<StockVec>);
+    return 0;
+}
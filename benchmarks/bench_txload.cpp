@@ -0,0 +1,113 @@
+// Loading TransactionRecord.txt: stream-based parser vs the in-place parser, 1..N threads.
+// usage: bench_txload [transactions=2000000] [maxThreads=4]
+//
+// "istringstream" replays the previous loader (getline, a vector<string> per record,
+// istringstream + stoi/stod per line); the others are TransactionStore::reload().
+// Every run must produce the same number of records and the same checksum.
+
+#include <fstream>
+#include <sstream>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+
+static vector<string> splitBar(const string& line) {
+    istringstream iss(line);
+    string token;
+    vector<string> parts;
+    while (getline(iss, token, '|')) parts.push_back(token);
+    return parts;
+}
+
+// The pre-mmap loader, building the same Transaction objects
+static optional<Transaction> legacyDeserialize(const vector<string>& lines) {
+    vector<string> parts = splitBar(lines[0]);
+    if (parts.size() != 9 || parts[0] != "TX") return nullopt;
+    try {
+        int itemCount = stoi(parts[8]);
+        vector<TransactionItem> items;
+        for (size_t i = 1; i < lines.size() && i <= static_cast<size_t>(itemCount); ++i) {
+            vector<string> f = splitBar(lines[i]);
+            if (f.size() != 13 || f[0] != "ITEM") continue;
+            vector<int> q(6);
+            for (int j = 0; j < 6; ++j) q[j] = stoi(f[6 + j]);
+            items.emplace_back(stoi(f[1]), f[2], static_cast<Category>(stoi(f[3])),
+                               static_cast<Section>(stoi(f[4])), stod(f[5]), q);
+        }
+        return Transaction(stoi(parts[1]), stoi(parts[2]), items, stod(parts[3]), stod(parts[4]),
+                           stod(parts[5]), parts[6], stoi(parts[7]));
+    } catch (...) {
+        return nullopt;
+    }
+}
+
+static vector<Transaction> legacyLoad(const char* path) {
+    vector<Transaction> out;
+    ifstream fin(path);
+    string line;
+    getline(fin, line);
+    vector<string> current;
+    while (getline(fin, line)) {
+        if (line.empty()) continue;
+        if (line.rfind("TX|", 0) == 0) {
+            if (!current.empty()) {
+                auto tx = legacyDeserialize(current);
+                if (tx.has_value()) out.push_back(std::move(*tx));
+                current.clear();
+            }
+            current.push_back(line);
+        } else if (line.rfind("ITEM|", 0) == 0) {
+            current.push_back(line);
+        }
+    }
+    if (!current.empty()) {
+        auto tx = legacyDeserialize(current);
+        if (tx.has_value()) out.push_back(std::move(*tx));
+    }
+    return out;
+}
+
+template <typename Container>
+static double checksum(const Container& txs) {
+    double sum = 0;
+    for (const auto& tx : txs) {
+        sum += tx.getFinalTotal() + tx.getTransactionID();
+        for (const auto& item : tx.getItems()) sum += item.productID + item.quantities[1];
+    }
+    return sum;
+}
+
+int main(int argc, char** argv) {
+    long txCount = argOr(argc, argv, 1, 2000000);
+    int maxThreads = static_cast<int>(argOr(argc, argv, 2, 4));
+
+    ScratchDir scratch("shop_bench_txload");
+    writeTransactionFile(txCount, 100000);
+    double mb;
+    {
+        ifstream f("TransactionRecord.txt", ios::binary | ios::ate);
+        mb = static_cast<double>(f.tellg()) / (1024.0 * 1024.0);
+    }
+    printf("%ld transactions, %.0f MB\n", txCount, mb);
+    printf("%-16s %10s %12s %10s %16s\n", "parser", "ms", "records", "MB/s", "checksum");
+
+    {
+        Stopwatch sw;
+        vector<Transaction> txs = legacyLoad("TransactionRecord.txt");
+        double ms = sw.elapsedMs();
+        printf("%-16s %10.0f %12zu %10.1f %16.0f\n", "istringstream", ms, txs.size(),
+               mb / (ms / 1000.0), checksum(txs));
+    }
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        TransactionStore store("TransactionRecord.txt");
+        store.setLoadThreads(threads);
+        Stopwatch sw;
+        store.reload();
+        double ms = sw.elapsedMs();
+        string name = "in-place x" + to_string(threads);
+        printf("%-16s %10.0f %12zu %10.1f %16.0f\n", name.c_str(), ms, store.all().size(),
+               mb / (ms / 1000.0), checksum(store.all()));
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Per-checkout cost of persisting a transaction as the history grows.
+// usage: bench_txlog [maxHistory=1000000] [checkouts=200] [threads=8]
+//
+// For each history size the store is loaded from a generated
+// TransactionRecord.txt and new records are appended in every log mode.
+// The last section compares fsync-per-checkout with group commit when
+// several shoppers check out at the same time.
+
+#include <algorithm>
+#include <thread>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+
+struct LatencyStats {
+    double avgUs;
+    double p99Us;
+};
+
+static LatencyStats summarize(vector<double>& us) {
+    sort(us.begin(), us.end());
+    double sum = 0;
+    for (double v : us) sum += v;
+    size_t p99 = min(us.size() - 1, static_cast<size_t>(us.size() * 0.99));
+    return {sum / us.size(), us[p99]};
+}
+
+static LatencyStats timeAppends(TransactionStore& store, int count, int userID) {
+    vector<double> us;
+    us.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Transaction tx = makeTransaction(store.getNextTransactionID(), userID, 1 + i % 1000);
+        Stopwatch sw;
+        store.append(tx);
+        us.push_back(sw.elapsedMs() * 1000.0);
+    }
+    return summarize(us);
+}
+
+// threads x perThread concurrent appends; returns checkouts per second
+static double concurrentAppends(TransactionStore& store, int threads, int perThread) {
+    vector<thread> workers;
+    Stopwatch sw;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&store, t, perThread]() {
+            for (int i = 0; i < perThread; ++i) {
+                // IDs only need to be unique for this benchmark
+                int id = 1000000000 - (t * perThread + i);
+                store.append(makeTransaction(id, 2 + t, 1 + i % 1000));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    return threads * perThread / (sw.elapsedMs() / 1000.0);
+}
+
+int main(int argc, char** argv) {
+    long maxHistory = argOr(argc, argv, 1, 1000000);
+    int checkouts = static_cast<int>(argOr(argc, argv, 2, 200));
+    int threads = static_cast<int>(argOr(argc, argv, 3, 8));
+
+    ScratchDir scratch("shop_bench_txlog");
+    cout << "history      mode             avg_us      p99_us" << endl;
+    for (long history = 0; history <= maxHistory; history = history ? history * 10 : 1000) {
+        writeTransactionFile(history, 1000);
+        TransactionStore store("TransactionRecord.txt");
+        store.reload();
+
+        struct Mode { const char* name; LogMode log; Durability dur; int count; };
+        Mode modes[] = {
+            {"rewrite",       LogMode::Rewrite, Durability::None,  max(1, checkouts / 10)},
+            {"append",        LogMode::Append,  Durability::None,  checkouts},
+            {"append+fsync",  LogMode::Append,  Durability::Fsync, checkouts},
+        };
+        for (const Mode& m : modes) {
+            store.setLogMode(m.log);
+            store.setDurability(m.dur);
+            LatencyStats st = timeAppends(store, m.count, 2);
+            printf("%-12ld %-16s %10.1f  %10.1f\n", history, m.name, st.avgUs, st.p99Us);
+        }
+        if (history == 0 && maxHistory == 0) break;
+    }
+
+    cout << "\nconcurrent checkouts (" << threads << " threads, " << checkouts << " each)" << endl;
+    writeTransactionFile(0, 1000);
+    TransactionStore store("TransactionRecord.txt");
+    store.reload();
+    store.setDurability(Durability::Fsync);
+    printf("fsync per checkout:        %10.0f checkouts/s\n",
+           concurrentAppends(store, threads, checkouts));
+    store.setDurability(Durability::GroupCommit);
+    printf("group commit:              %10.0f checkouts/s\n",
+           concurrentAppends(store, threads, checkouts));
+    store.setDurability(Durability::GroupCommit, 200);
+    printf("group commit (200us wait): %10.0f checkouts/s\n",
+           concurrentAppends(store, threads, checkouts));
+    return 0;
+}
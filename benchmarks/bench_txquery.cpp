@@ -0,0 +1,140 @@
+// Per-user and admin transaction queries against a large shared history.
+// usage: bench_txquery [transactions=1000000] [users=10000] [queries=2000]
+//
+// Each query runs through TransactionManager views on one loaded store; "scan" is
+// the old approach (walk every record and filter by user) for comparison.
+
+#include <random>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+
+// The pre-index filter: every record, every query
+static double scanTotal(const TransactionStore& store, int userID) {
+    double total = 0;
+    for (const auto& tx : store.all()) {
+        if (tx.getUserID() == userID) total += tx.getFinalTotal();
+    }
+    return total;
+}
+
+// The old amount filter over every record
+static double scanAmountRange(const TransactionStore& store, double lo, double hi) {
+    double count = 0;
+    for (const auto& tx : store.all()) {
+        if (tx.getFinalTotal() >= lo && tx.getFinalTotal() <= hi) ++count;
+    }
+    return count;
+}
+
+// The old date filter: format and compare the date prefix of every record
+static double scanDateRange(const TransactionStore& store, const string& from, const string& to) {
+    double count = 0;
+    for (const auto& tx : store.all()) {
+        string date = tx.getTimestamp().substr(0, 10);
+        if (date >= from && date <= to) ++count;
+    }
+    return count;
+}
+
+template <typename Query>
+static void timeQuery(const char* name, int queries, Query query) {
+    mt19937 rng(5);
+    double checksum = 0;
+    Stopwatch sw;
+    for (int i = 0; i < queries; ++i) checksum += query(rng);
+    printf("%-28s %12.2f us/query   (checksum %.0f)\n", name, sw.elapsedMs() * 1000.0 / queries, checksum);
+}
+
+int main(int argc, char** argv) {
+    long txCount = argOr(argc, argv, 1, 1000000);
+    long userCount = argOr(argc, argv, 2, 10000);
+    int queries = static_cast<int>(argOr(argc, argv, 3, 2000));
+
+    ScratchDir scratch("shop_bench_txquery");
+    writeTransactionFile(txCount, userCount);
+    TransactionStore store("TransactionRecord.txt");
+    Stopwatch loadSw;
+    store.reload();
+    printf("%ld transactions, %ld users, load + index %.0f ms\n\n", txCount, userCount, loadSw.elapsedMs());
+
+    uniform_int_distribution<int> pickUser(2, static_cast<int>(max(2L, userCount)));
+    uniform_int_distribution<int> pickTx(1, static_cast<int>(max(1L, txCount)));
+
+    timeQuery("user getTransactionCount", queries, [&](mt19937& rng) {
+        return TransactionManager(pickUser(rng), store).getTransactionCount();
+    });
+    timeQuery("user getTotalSpent", queries, [&](mt19937& rng) {
+        return TransactionManager(pickUser(rng), store).getTotalSpent();
+    });
+    timeQuery("user getAverageSpent", queries, [&](mt19937& rng) {
+        return TransactionManager(pickUser(rng), store).getAverageSpent();
+    });
+    timeQuery("user findByAmountRange", queries, [&](mt19937& rng) {
+        return static_cast<double>(TransactionManager(pickUser(rng), store).findByAmountRange(50, 150).size());
+    });
+    timeQuery("user countByAmountRange", queries, [&](mt19937& rng) {
+        return static_cast<double>(TransactionManager(pickUser(rng), store).countByAmountRange(50, 150));
+    });
+    timeQuery("user getTopOrders(5)", queries, [&](mt19937& rng) {
+        auto top = TransactionManager(pickUser(rng), store).getTopOrders(5);
+        return top.empty() ? 0.0 : top.front()->getFinalTotal();
+    });
+    timeQuery("user p95 order value", queries, [&](mt19937& rng) {
+        return TransactionManager(pickUser(rng), store).getOrderPercentile(95);
+    });
+    timeQuery("user findByDateRange", queries, [&](mt19937& rng) {
+        return static_cast<double>(
+            TransactionManager(pickUser(rng), store).findByDateRange("2025-12-01", "2025-12-31").size());
+    });
+    timeQuery("user findByDateRange (hours)", queries, [&](mt19937& rng) {
+        return static_cast<double>(TransactionManager(pickUser(rng), store)
+                                       .findByDateRange("2024-03-01 09:00", "2024-03-01 17:30").size());
+    });
+    timeQuery("user findTransaction", queries, [&](mt19937& rng) {
+        const Transaction* tx = TransactionManager(pickUser(rng), store).findTransaction(pickTx(rng));
+        return tx ? 1.0 : 0.0;
+    });
+    timeQuery("admin findTransaction", queries, [&](mt19937& rng) {
+        const Transaction* tx = TransactionManager(-1, store).findTransaction(pickTx(rng));
+        return tx ? tx->getFinalTotal() : 0.0;
+    });
+    uniform_real_distribution<double> pickAmount(10, 290);
+    timeQuery("admin findByAmountRange ($1)", queries, [&](mt19937& rng) {
+        double lo = pickAmount(rng);
+        return static_cast<double>(TransactionManager(-1, store).findByAmountRange(lo, lo + 1).size());
+    });
+    timeQuery("admin countByAmountRange", queries, [&](mt19937& rng) {
+        double lo = pickAmount(rng);
+        return static_cast<double>(TransactionManager(-1, store).countByAmountRange(lo, lo + 50));
+    });
+    timeQuery("admin getTopOrders(100)", queries, [&](mt19937&) {
+        auto top = TransactionManager(-1, store).getTopOrders(100);
+        return top.empty() ? 0.0 : top.back()->getFinalTotal();
+    });
+    timeQuery("admin p50/p95/p99", queries, [&](mt19937&) {
+        TransactionManager admin(-1, store);
+        return admin.getOrderPercentile(50) + admin.getOrderPercentile(95) + admin.getOrderPercentile(99);
+    });
+    timeQuery("scan amount range (old)", max(1, queries / 100), [&](mt19937& rng) {
+        double lo = pickAmount(rng);
+        return scanAmountRange(store, lo, lo + 50);
+    });
+    timeQuery("admin findByDateRange (day)", queries, [&](mt19937&) {
+        return static_cast<double>(TransactionManager(-1, store).findByDateRange("2023-06-15", "2023-06-15").size());
+    });
+    timeQuery("admin findByDateRange (1y)", max(1, queries / 100), [&](mt19937&) {
+        return static_cast<double>(TransactionManager(-1, store).findByDateRange("2023-01-01", "2023-12-31").size());
+    });
+    timeQuery("admin findByDateRange (all)", max(1, queries / 100), [&](mt19937&) {
+        return static_cast<double>(TransactionManager(-1, store).findByDateRange(HISTORY_START, HISTORY_END).size());
+    });
+    timeQuery("scan date range 1y (old)", max(1, queries / 100), [&](mt19937&) {
+        return scanDateRange(store, "2023-01-01", "2023-12-31");
+    });
+    timeQuery("scan getTotalSpent (old)", max(1, queries / 100), [&](mt19937& rng) {
+        return scanTotal(store, pickUser(rng));
+    });
+    return 0;
+}
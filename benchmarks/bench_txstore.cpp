@@ -0,0 +1,81 @@
+// Startup cost of the shared transaction store.
+// usage: bench_txstore [users=100000] [transactions=10000000]
+//
+// Writes users.txt and TransactionRecord.txt into a scratch directory, then
+// measures User::loadAll (which constructs one TransactionManager per user)
+// and the peak RSS of the process afterwards, followed by per-user queries and
+// User::checkout latency on top of the full history.
+
+#include <cmath>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+#include "../User.h"
+
+int main(int argc, char** argv) {
+    long userCount = argOr(argc, argv, 1, 100000);
+    long txCount = argOr(argc, argv, 2, 10000000);
+
+    ScratchDir scratch("shop_bench_txstore");
+    cout << "generating " << userCount << " users, " << txCount << " transactions..." << endl;
+    writeUsersFile(userCount);
+    writeTransactionFile(txCount, userCount);
+
+    long rssBefore = currentRssKB();
+    UserList users;
+    int nextUserID = 1;
+    Stopwatch sw;
+    {
+        QuietCout quiet;
+        User::loadAll(users, nextUserID);
+    }
+    double loadMs = sw.elapsedMs();
+
+    cout << "users loaded:            " << users.size() << endl;
+    cout << "transactions in store:   " << TransactionStore::instance().all().size() << endl;
+    cout << "startup (loadAll) ms:    " << loadMs << endl;
+    cout << "RSS before load (kB):    " << rssBefore << endl;
+    cout << "RSS after load (kB):     " << currentRssKB() << endl;
+    cout << "peak RSS (kB):           " << peakRssKB() << endl;
+    cout << "sizeof(TransactionManager): " << sizeof(TransactionManager) << " bytes per user view" << endl;
+
+    // a few filtered queries through per-user views
+    sw.reset();
+    double checksum = 0;
+    const int queries = 10;
+    for (int i = 0; i < queries; ++i) {
+        User& u = users[(i * 7919) % users.size()];
+        checksum += u.txm.getTotalSpent();
+    }
+    cout << "per-user getTotalSpent ms (avg of " << queries << "): "
+         << sw.elapsedMs() / queries << " (checksum " << checksum << ")" << endl;
+
+    // checkouts must not depend on the history size (no reload, no rescan)
+    writeProductsFile(1000);
+    ProductManager pm;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+    }
+    SizeStock plenty;
+    plenty.fill(1 << 30);
+    for (int id = 1; id <= 1000; ++id) pm.getProduct(id)->setSizeStock(plenty);
+    User& shopper = users[users.size() / 2];
+    const int checkouts = 20;
+    double spentBefore = shopper.totalSpent, recorded = shopper.txm.getTotalSpent();
+    double checkoutMs = 0;
+    for (int i = 0; i < checkouts; ++i) {
+        writeCartFile(shopper.cartFileName(), 2, 1000, i);
+        QuietCout quiet;
+        shopper.loadCartFromFile();
+        Stopwatch checkoutSw;
+        shopper.checkout(pm);
+        checkoutMs += checkoutSw.elapsedMs();
+    }
+    double added = shopper.totalSpent - spentBefore;
+    bool consistent = fabs(added - (shopper.txm.getTotalSpent() - recorded)) < 0.01;
+    cout << "User::checkout ms (avg of " << checkouts << "):   " << checkoutMs / checkouts
+         << (consistent ? "  (spend delta matches the records)" : "  (SPEND DELTA MISMATCH)") << endl;
+    return consistent ? 0 : 1;
+}
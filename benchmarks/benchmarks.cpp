@@ -0,0 +1,240 @@
+// Micro-benchmark suite for the hot paths of the core classes.
+// usage: benchmarks [scale=100000] [reps=15] [jsonFile] [filter]
+//
+// scale is the number of products and of stored transactions (users: scale / 10).
+// Every benchmark runs through BenchSuite (calibrated batches, warm-up, outlier
+// rejection) and reports ns per operation; with jsonFile the results are also
+// written there as JSON, for comparing runs. filter runs only the benchmarks whose
+// name contains it, e.g. "benchmarks 100000 15 out.json product".
+//
+// Benchmarks that print (processTransaction, login, ...) run with cout discarded,
+// so formatting is measured but terminal I/O is not.
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "BenchData.h"
+#include "BenchHarness.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+#include "../User.h"
+
+static const int CART_LINES = 20;
+static const int NAME_POOL = 4096;  // precomputed lookup keys, cycled through
+
+// A cart of CART_LINES random products (one unit each), built without stock checks
+static ShoppingCart makeCart(const ProductManager& pm, long productCount, int seed) {
+    ShoppingCart cart;
+    mt19937 rng(seed);
+    uniform_int_distribution<long> pick(1, productCount);
+    while (cart.getItems().size() < static_cast<size_t>(min<long>(CART_LINES, productCount))) {
+        int id = static_cast<int>(pick(rng));
+        cart.setQuantity(id, pm.getProduct(id)->getHasSize() ? Size::M : Size::None, 1);
+    }
+    return cart;
+}
+
+// A stored-style transaction with lineCount items
+static Transaction makeOrder(int lineCount) {
+    vector<TransactionItem> items;
+    double total = 0;
+    for (int i = 1; i <= lineCount; ++i) {
+        vector<int> qtys(6, 0);
+        qtys[i % 6] = 1 + i % 3;
+        double price = 10.0 + i * 3.25;
+        items.emplace_back(i * 17, "Product_" + to_string(i * 17), static_cast<Category>(i % 4),
+                           Section::Other, price, qtys);
+        total += price * qtys[i % 6];
+    }
+    return Transaction(42, 7, items, total, 0.95, total * 0.95, "2025-12-08 10:00:00", 2);
+}
+
+static vector<string> splitLines(const string& text) {
+    vector<string> lines;
+    size_t start = 0, end;
+    while ((end = text.find('\n', start)) != string::npos) {
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return lines;
+}
+
+int main(int argc, char** argv) {
+    long scale = max(100L, argOr(argc, argv, 1, 100000));
+    int reps = static_cast<int>(argOr(argc, argv, 2, 15));
+    // resolve before ScratchDir changes the working directory
+    string jsonPath = argc > 3 && argv[3][0] ? filesystem::absolute(argv[3]).string() : "";
+    string filter = argc > 4 ? argv[4] : "";
+    long userCount = max(10L, scale / 10);
+
+    ScratchDir scratch("shop_benchmarks");
+    writeProductsFile(scale);
+    writeUsersFile(userCount);
+    writeTransactionFile(0, 1);     // TransactionStore::instance(), bound on login
+    writeTransactionFile(scale, userCount, "tx_bench.txt");
+
+    ProductManager pm;
+    UserList users;
+    int nextUserID = 1;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+        User::loadAll(users, nextUserID);
+    }
+    ShoppingCart cart = makeCart(pm, scale, 11);
+
+    mt19937 rng(2025);
+    uniform_int_distribution<long> pickProduct(1, scale);
+    uniform_int_distribution<long> pickUser(2, userCount);
+    vector<int> productIDs(NAME_POOL);
+    vector<string> productNames(NAME_POOL), userNames(NAME_POOL), passwords(NAME_POOL);
+    for (int i = 0; i < NAME_POOL; ++i) {
+        productIDs[i] = static_cast<int>(pickProduct(rng));
+        productNames[i] = "Product_" + to_string(productIDs[i]);
+        long u = pickUser(rng);
+        userNames[i] = "user" + to_string(u);
+        passwords[i] = "pass" + to_string(u);
+    }
+
+    printf("scale %ld: %zu products, %zu users, %ld stored transactions, %d cart lines, %d reps\n\n",
+           scale, pm.getProductCount(), users.size(), scale, CART_LINES, reps);
+    BenchSuite suite(reps, 3, 10, filter);
+    BenchSuite::printHeader();
+    size_t next = 0;
+
+    // ---- catalog and cart ----
+    suite.run("ProductManager::getProduct", [&]() {
+        doNotOptimize(pm.getProduct(productIDs[next++ % NAME_POOL]));
+    });
+    suite.run("ProductManager::getProductID", [&]() {
+        doNotOptimize(pm.getProductID(productNames[next++ % NAME_POOL]));
+    });
+    suite.run("ShoppingCart::calculateTotal", [&]() {
+        doNotOptimize(cart.calculateTotal(pm));
+    });
+    {
+        // setQuantity() with the line's own value changes nothing but drops the cached total
+        const CartLine first = *cart.getItems().begin();
+        Size firstSize = static_cast<Size>(find_if(first.qty.begin(), first.qty.end(), [](int q) { return q > 0; }) -
+                                           first.qty.begin());
+        ShoppingCart edited = cart;
+        suite.run("ShoppingCart::calculateTotal (edited)", [&]() {
+            edited.setQuantity(first.productID, firstSize, first.qty[static_cast<int>(firstSize)]);
+            doNotOptimize(edited.calculateTotal(pm));
+        });
+    }
+    suite.run("TransactionManager::quote", [&]() {
+        doNotOptimize(TransactionManager::quote(cart, pm, 2, false));
+    });
+    {
+        TransactionStore checkoutStore("tx_checkout.txt");
+        TransactionManager txm(2, checkoutStore);
+        suite.run("TransactionManager::checkStock", [&]() {
+            doNotOptimize(txm.checkStock(cart, pm).size());
+        });
+
+        // unlimited stock, so every checkout commits (and appends a record)
+        if (suite.selected("TransactionManager::checkout") || suite.selected("TransactionManager::processTransaction")) {
+            SizeStock plenty;
+            plenty.fill(1 << 30);
+            for (long id = 1; id <= scale; ++id) pm.getProduct(static_cast<int>(id))->setSizeStock(plenty);
+            suite.run("TransactionManager::checkout", [&]() {
+                ShoppingCart c = cart;  // checkout empties the cart
+                doNotOptimize(txm.checkout(c, pm, 1, false, ShortagePolicy::Reject));
+            });
+            QuietCout quiet;
+            suite.run("TransactionManager::processTransaction", [&]() {
+                ShoppingCart c = cart;  // checkout empties the cart
+                doNotOptimize(txm.processTransaction(c, pm, 1, false, nullptr));
+            });
+        }
+    }
+
+    // ---- users ----
+    {
+        QuietCout quiet;
+        suite.run("User::login", [&]() {
+            size_t i = next++ % NAME_POOL;
+            doNotOptimize(User::login(users, userNames[i], passwords[i]));
+        });
+        suite.run("User::saveAll", [&]() {
+            doNotOptimize(User::saveAll(users, nextUserID, "users_bench.txt"));
+        });
+        suite.run("User::loadAll", [&]() {
+            UserList loaded;
+            int nextID = 0;
+            doNotOptimize(User::loadAll(loaded, nextID, "users_bench.txt"));
+        });
+    }
+
+    // ---- persistence ----
+    {
+        QuietCout quiet;
+        // alternate between two files so every save is a full write, not a journal append
+        const char* const files[2] = {"products_a.txt", "products_b.txt"};
+        suite.run("ProductManager::saveToFile", [&]() {
+            doNotOptimize(pm.saveToFile(files[next++ % 2]));
+        });
+        suite.run("ProductManager::loadFromFile", [&]() {
+            ProductManager loaded;
+            doNotOptimize(loaded.loadFromFile(files[next++ % 2]));
+        });
+        suite.run("ShoppingCart::saveToFile", [&]() {
+            doNotOptimize(cart.saveToFile("cart_bench.txt"));
+        });
+        suite.run("ShoppingCart::loadFromFile", [&]() {
+            ShoppingCart loaded;
+            doNotOptimize(loaded.loadFromFile("cart_bench.txt"));
+        });
+        TransactionStore store("tx_bench.txt");
+        store.reload();
+        suite.run("TransactionStore::save", [&]() {
+            doNotOptimize(store.save());
+        });
+        suite.run("TransactionStore::reload", [&]() {
+            doNotOptimize(store.reload());
+        });
+    }
+
+    // ---- cursor pages (20 rows from a random cursor) ----
+    {
+        TransactionStore store("tx_bench.txt");
+        {
+            QuietCout quiet;
+            store.reload();
+        }
+        suite.run("ProductManager::getProductPage(section)", [&]() {
+            int id = productIDs[next++ % NAME_POOL];
+            const Product* p = pm.getProduct(id);
+            doNotOptimize(pm.getProductPage(p->getCategory(), p->getSection(), id, 20).size());
+        });
+        suite.run("ProductManager::getProductPage(category)", [&]() {
+            int id = productIDs[next++ % NAME_POOL];
+            doNotOptimize(pm.getProductPage(pm.getProduct(id)->getCategory(), id, 20).size());
+        });
+        suite.run("TransactionStore::pageAfter(user)", [&]() {
+            size_t i = next++ % NAME_POOL;
+            doNotOptimize(store.pageAfter(productIDs[i], 20, static_cast<int>(2 + productIDs[i] % (userCount - 1))).size());
+        });
+        suite.run("TransactionStore::pageAfter(all)", [&]() {
+            doNotOptimize(store.pageAfter(productIDs[next++ % NAME_POOL], 20).size());
+        });
+    }
+
+    // ---- transaction records ----
+    Transaction order = makeOrder(5);
+    vector<string> orderLines = splitLines(order.serialize());
+    suite.run("Transaction::serialize", [&]() {
+        doNotOptimize(order.serialize());
+    });
+    suite.run("Transaction::deserialize", [&]() {
+        doNotOptimize(Transaction::deserialize(orderLines));
+    });
+
+    if (!jsonPath.empty()) {
+        if (!suite.writeJson(jsonPath, {{"scale", scale}, {"users", userCount}, {"cartLines", CART_LINES}})) return 1;
+        printf("\nresults written to %s\n", jsonPath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,584 @@
+// Synthetic dataset generator: products.txt, users.txt, TransactionRecord.txt and cart_<id>.txt
+// usage: datagen [outDir=datagen_out] [products=1000000] [users=100000] [transactions=1000000]
+//                [carts=1000] [threads=0] [seed=1]
+//
+// Writes files the application loads as they are (same formats, valid field combinations):
+//   products   Men/Women/Kids/Other with valid sections, ~70% sized (stock per XS..XL),
+//              the rest size-less (stock in None); log-normal prices ending in 9, ~5% sold out
+//   TX history transactions spread evenly over HISTORY_START..HISTORY_END (time ordered),
+//              1-8 lines each; products are Zipf-popular (s = 1.0), shoppers Zipf-active
+//              (s = 0.8), both ranks shuffled over the IDs
+//   users      user 1 is the default admin, then user<id> / pass<id>; totalSpent is the exact
+//              sum of the user's generated transactions and level follows from it (500 / 2000)
+//   carts      cart_<id>.txt for the `carts` most active shoppers
+// A transaction's level (and discount) is the shopper's level predicted from their expected
+// spend, so it can differ from the level the final total gives; the store does not check it.
+//
+// Files are cut into blocks that worker threads format in parallel and write in order
+// through one large buffered stream. Every block draws from its own random stream, so the
+// output depends on the seed only, not on the thread count. threads=0 uses one per core.
+
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../ShoppingCart.h"
+
+static const long PRODUCT_BLOCK = 65536;
+static const long USER_BLOCK = 65536;
+static const long TX_BLOCK = 16384;
+static const int MAX_ORDER_LINES = 8;
+static const int MAX_CART_LINES = 6;
+static const double PRODUCT_ZIPF = 1.0;
+static const double SHOPPER_ZIPF = 0.8;
+
+// independent random streams per kind of record
+enum Stream : uint64_t { CatalogStream = 1, StockStream, OrderStream, CartStream, SampleStream, ShuffleStream };
+
+static uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// SplitMix64 generator, seeded per (seed, stream, index) so any record can be regenerated alone
+struct SplitMix {
+    using result_type = uint64_t;
+    uint64_t state;
+    SplitMix(uint64_t seed, uint64_t stream, uint64_t index)
+        : state(mix64(seed * 0x9E3779B97F4A7C15ull ^ mix64(stream << 48 ^ index))) {}
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+    uint64_t operator()() { return mix64(state += 0x9E3779B97F4A7C15ull); }
+    double unit() { return static_cast<double>(operator()() >> 11) * 0x1.0p-53; }    // [0, 1)
+    long below(long n) { return static_cast<long>(operator()() % static_cast<uint64_t>(n)); }
+};
+
+// Bijection on 1..n (rank -> ID), so popular ranks are scattered over the ID range
+struct Shuffle {
+    long n = 1;
+    uint64_t a = 1, b = 0;
+    Shuffle() = default;
+    Shuffle(long count, uint64_t seed) : n(max(count, 1L)) {
+        SplitMix r(seed, ShuffleStream, static_cast<uint64_t>(count));
+        a = 1 + r() % static_cast<uint64_t>(n);
+        while (gcd(a, static_cast<uint64_t>(n)) != 1) ++a;
+        b = r() % static_cast<uint64_t>(n);
+    }
+    long operator()(long rank) const {
+        unsigned __int128 x = static_cast<unsigned __int128>(a) * static_cast<uint64_t>(rank - 1) + b;
+        return 1 + static_cast<long>(x % static_cast<uint64_t>(n));
+    }
+};
+
+// ---- catalog ----
+
+static const char* const SIZED_NOUNS[] = {"Shirt", "Tshirt", "Dress", "Jacket", "Trousers", "Hoodie", "Skirt", "Sweater"};
+static const char* const SIZELESS_NOUNS[] = {"Boots", "Accessory", "Bag", "Hat", "Scarf", "Belt", "Watch"};
+static const bool WOMENSWEAR[] = {false, false, true, false, false, false, true, false};    // per SIZED_NOUNS
+static const int SIZED_NOUN_COUNT = sizeof(SIZED_NOUNS) / sizeof(SIZED_NOUNS[0]);
+static const int SIZELESS_NOUN_COUNT = sizeof(SIZELESS_NOUNS) / sizeof(SIZELESS_NOUNS[0]);
+
+// Everything a transaction line needs about a product, 8 bytes per product
+struct ProductInfo {
+    int32_t price;
+    Category category;
+    Section section;
+    bool hasSize;
+    uint8_t noun;   // index into SIZED_NOUNS / SIZELESS_NOUNS
+};
+
+static ProductInfo makeProductInfo(uint64_t seed, long id) {
+    SplitMix r(seed, CatalogStream, static_cast<uint64_t>(id));
+    ProductInfo p{};
+    double u = r.unit();
+    p.category = u < 0.35 ? Category::Men : u < 0.70 ? Category::Women : u < 0.92 ? Category::Kids : Category::Other;
+    double v = r.unit();
+    switch (p.category) {
+        case Category::Men:
+        case Category::Women:
+            p.section = v < 0.40 ? Section::Eastern : v < 0.85 ? Section::Western : Section::Other;
+            break;
+        case Category::Kids:
+            p.section = v < 0.45 ? Section::Boys : v < 0.90 ? Section::Girls : Section::Other;
+            break;
+        default:
+            p.section = Section::Other;
+    }
+    p.hasSize = p.category != Category::Other && r.unit() < 0.78;
+    p.noun = static_cast<uint8_t>(r.below(p.hasSize ? SIZED_NOUN_COUNT : SIZELESS_NOUN_COUNT));
+    bool menswear = p.category == Category::Men || p.section == Section::Boys;
+    while (p.hasSize && menswear && WOMENSWEAR[p.noun]) p.noun = static_cast<uint8_t>(r.below(SIZED_NOUN_COUNT));
+    // log-normal price (median ~$45), rounded to end in 9
+    double z = sqrt(-2.0 * log(1.0 - r.unit())) * cos(6.283185307179586 * r.unit());
+    long price = llround(exp(3.8 + 0.7 * z));
+    p.price = static_cast<int32_t>(min(max(price, 5L), 2990L) / 10 * 10 + 9);
+    return p;
+}
+
+// Catalog facts shared by every generator: product attributes and popularity
+struct Catalog {
+    uint64_t seed;
+    long productCount;
+    vector<ProductInfo> info;   // [id], id 0 unused
+    ZipfSampler popularity;
+    Shuffle productOfRank;
+    vector<string> namePrefix;  // "<Category><Noun>_<Section>_" by (sized, category, section, noun)
+
+    Catalog(uint64_t s, long count, int threads)
+        : seed(s), productCount(count), info(count + 1), popularity(count, PRODUCT_ZIPF),
+          productOfRank(count, s) {
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([this, t, threads]() {
+                for (long id = 1 + t; id <= productCount; id += threads) info[id] = makeProductInfo(seed, id);
+            });
+        }
+        for (auto& w : workers) w.join();
+        namePrefix.resize(prefixIndex(false, 3, 4, 7) + 1);
+        for (bool sized : {true, false}) {
+            for (int c = 0; c < 4; ++c) {
+                for (int sec = 0; sec < 5; ++sec) {
+                    for (int n = 0; n < (sized ? SIZED_NOUN_COUNT : SIZELESS_NOUN_COUNT); ++n) {
+                        namePrefix[prefixIndex(sized, c, sec, n)] = categoryToString(intToCategory(c)) +
+                            (sized ? SIZED_NOUNS[n] : SIZELESS_NOUNS[n]) + "_" + sectionToString(intToSection(sec)) + "_";
+                    }
+                }
+            }
+        }
+    }
+
+    static size_t prefixIndex(bool sized, int cat, int sec, int noun) {
+        return ((static_cast<size_t>(sized ? 0 : 1) * 4 + cat) * 5 + sec) * 8 + noun;
+    }
+    const string& prefixOf(const ProductInfo& p) const {
+        return namePrefix[prefixIndex(p.hasSize, static_cast<int>(p.category), static_cast<int>(p.section), p.noun)];
+    }
+
+    template <typename Rng>
+    long popularProduct(Rng& rng) const { return productOfRank(popularity(rng)); }
+};
+
+// ---- text formatting (no locale, no printf) ----
+
+static void appendInt(string& out, long long v) {
+    char buf[24];
+    auto res = to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+// cents as dollars with two decimals
+static void appendCents(string& out, long long cents) {
+    appendInt(out, cents / 100);
+    out += '.';
+    out += static_cast<char>('0' + cents % 100 / 10);
+    out += static_cast<char>('0' + cents % 10);
+}
+
+static void append2(string& out, int v) {
+    out += static_cast<char>('0' + v / 10);
+    out += static_cast<char>('0' + v % 10);
+}
+
+// "YYYY-MM-DD HH:MM:SS"; the date part is cached since consecutive records share the day
+struct TimestampFormatter {
+    int64_t day = INT64_MIN;
+    string date;
+    void append(string& out, int64_t epoch) {
+        int64_t d = epoch / 86400;
+        if (d != day) {
+            day = d;
+            date = Transaction::formatTimestamp(d * 86400).substr(0, 11);
+        }
+        int secs = static_cast<int>(epoch - d * 86400);
+        out += date;
+        append2(out, secs / 3600);
+        out += ':';
+        append2(out, secs / 60 % 60);
+        out += ':';
+        append2(out, secs % 60);
+    }
+};
+
+// ---- parallel ordered writer ----
+
+// Write blockCount blocks to path, in block order, after head. produce(block, out) appends
+// the block's text to out and runs on `threads` workers; workers claim blocks in increasing
+// order and wait for their turn to write, so at most `threads` formatted blocks are in memory.
+static bool writeBlocks(const string& path, const string& head, long blockCount, int threads,
+                        const function<void(long, string&)>& produce, uint64_t& bytes) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        cout << "Failed to open file for writing: " << path << endl;
+        return false;
+    }
+    setvbuf(f, nullptr, _IOFBF, 8 << 20);
+    bool ok = fwrite(head.data(), 1, head.size(), f) == head.size();
+    bytes = head.size();
+    atomic<long> nextBlock(0);
+    long turn = 0;
+    mutex m;
+    condition_variable cv;
+    auto worker = [&]() {
+        string buf;
+        for (long b; (b = nextBlock.fetch_add(1)) < blockCount;) {
+            buf.clear();
+            produce(b, buf);
+            unique_lock<mutex> lock(m);
+            cv.wait(lock, [&]() { return turn == b; });
+            if (ok && fwrite(buf.data(), 1, buf.size(), f) != buf.size()) ok = false;
+            bytes += buf.size();
+            ++turn;
+            cv.notify_all();
+        }
+    };
+    vector<thread> workers;
+    for (int t = 1; t < threads; ++t) workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers) w.join();
+    if (fclose(f) != 0) ok = false;
+    if (!ok) cout << "Failed to write file: " << path << endl;
+    return ok;
+}
+
+// ---- records ----
+
+struct OrderLine {
+    long productID;
+    int quantities[6];
+};
+
+// A basket of 1..maxLines distinct Zipf-popular products; returns the line count
+template <size_t N>
+static int makeBasket(SplitMix& r, const Catalog& catalog, int maxLines, double moreProb, OrderLine (&lines)[N]) {
+    int count = 1;
+    while (count < maxLines && count < static_cast<int>(catalog.productCount) && r.unit() < moreProb) ++count;
+    for (int i = 0; i < count; ++i) {
+        long id;
+        bool duplicate;
+        do {
+            id = catalog.popularProduct(r);
+            duplicate = false;
+            for (int j = 0; j < i; ++j) duplicate = duplicate || lines[j].productID == id;
+        } while (duplicate);
+        OrderLine& line = lines[i];
+        line.productID = id;
+        fill(begin(line.quantities), end(line.quantities), 0);
+        double q = r.unit();
+        int qty = q < 0.80 ? 1 : q < 0.95 ? 2 : 3;
+        if (catalog.info[id].hasSize) {
+            double s = r.unit();   // size mix XS 8%, S 20%, M 32%, L 27%, XL 13%
+            int size = s < 0.08 ? 0 : s < 0.28 ? 1 : s < 0.60 ? 2 : s < 0.87 ? 3 : 4;
+            line.quantities[size] = qty;
+        } else {
+            line.quantities[static_cast<int>(Size::None)] = qty;
+        }
+    }
+    return count;
+}
+
+static long long basketCents(const Catalog& catalog, const OrderLine* lines, int count) {
+    long long cents = 0;
+    for (int i = 0; i < count; ++i) {
+        int units = accumulate(begin(lines[i].quantities), end(lines[i].quantities), 0);
+        cents += 100LL * catalog.info[lines[i].productID].price * units;
+    }
+    return cents;
+}
+
+// products.txt stores the section as its slot inside the category (as ProductManager does):
+// Eastern/Boys 0, Western/Girls 1, Other 2. Transaction items store the Section value itself.
+static int sectionSlot(Section sec) {
+    switch (sec) {
+        case Section::Eastern:
+        case Section::Boys: return 0;
+        case Section::Western:
+        case Section::Girls: return 1;
+        default: return 2;
+    }
+}
+
+static void appendProductLine(string& out, const Catalog& catalog, long id) {
+    const ProductInfo& p = catalog.info[id];
+    SplitMix r(catalog.seed, StockStream, static_cast<uint64_t>(id));
+    int stock[6] = {0, 0, 0, 0, 0, 0};
+    if (r.unit() >= 0.05) {     // ~5% sold out
+        if (p.hasSize) {
+            static const double SIZE_WEIGHT[5] = {0.5, 1.0, 1.4, 1.2, 0.6};
+            long base = 5 + r.below(56);
+            for (int s = 0; s < 5; ++s) stock[s] = static_cast<int>(llround(base * SIZE_WEIGHT[s] * (0.5 + r.unit())));
+        } else {
+            stock[5] = static_cast<int>(1 + r.below(200));
+        }
+    }
+    appendInt(out, id);
+    out += ',';
+    out += catalog.prefixOf(p);
+    appendInt(out, id);
+    out += ',';
+    appendInt(out, static_cast<int>(p.category));
+    out += ',';
+    appendInt(out, sectionSlot(p.section));
+    out += ',';
+    appendInt(out, p.price);
+    for (int s : stock) {
+        out += ',';
+        appendInt(out, s);
+    }
+    out += '\n';
+}
+
+// Shoppers: users 2..userCount, activity rank -> user ID through a shuffle
+struct Shoppers {
+    long count;     // userCount - 1
+    ZipfSampler activity;
+    Shuffle userOfRank;
+    Shoppers(long userCount, uint64_t seed)
+        : count(max(userCount - 1, 1L)), activity(count, SHOPPER_ZIPF), userOfRank(count, seed ^ 0x5EED) {}
+    long userOf(long rank) const { return 1 + userOfRank(rank); }
+    template <typename Rng>
+    long pick(Rng& rng) const { return userOf(activity(rng)); }
+};
+
+static int levelFor(double spent) { return spent >= 2000 ? 3 : spent >= 500 ? 2 : 1; }
+static const char* rateText(int level) { return level >= 3 ? "0.95" : level == 2 ? "0.98" : "1.00"; }
+
+static void report(const char* what, long records, uint64_t bytes, const Stopwatch& sw) {
+    double sec = sw.elapsedMs() / 1000.0;
+    printf("%-22s %12ld records %10.1f MB %8.1f s %8.1f MB/s\n", what, records, bytes / 1048576.0, sec,
+           bytes / 1048576.0 / max(sec, 1e-9));
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    filesystem::path outDir = argc > 1 ? argv[1] : "datagen_out";
+    long productCount = max(1L, argOr(argc, argv, 2, 1000000));
+    long userCount = max(1L, argOr(argc, argv, 3, 100000));
+    long txCount = max(0L, argOr(argc, argv, 4, 1000000));
+    long cartCount = max(0L, argOr(argc, argv, 5, 1000));
+    int threads = static_cast<int>(argOr(argc, argv, 6, 0));
+    uint64_t seed = static_cast<uint64_t>(argOr(argc, argv, 7, 1));
+    if (threads <= 0) threads = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    if (userCount < 2) txCount = cartCount = 0;     // only the admin: nobody shops
+    cartCount = min(cartCount, userCount - 1);
+
+    error_code ec;
+    filesystem::create_directories(outDir, ec);
+    if (ec) {
+        cout << "Cannot create " << outDir.string() << ": " << ec.message() << endl;
+        return 1;
+    }
+    printf("%ld products, %ld users, %ld transactions, %ld carts, %d threads, seed %llu -> %s\n\n",
+           productCount, userCount, txCount, cartCount, threads, static_cast<unsigned long long>(seed),
+           outDir.string().c_str());
+    Stopwatch total;
+
+    Catalog catalog(seed, productCount, threads);
+    Shoppers shoppers(userCount, seed);
+
+    // products.txt: nextProductID, then id,name,catIdx,secIdx,price,XS,S,M,L,XL,None
+    {
+        Stopwatch sw;
+        uint64_t bytes = 0;
+        long blocks = (productCount + PRODUCT_BLOCK - 1) / PRODUCT_BLOCK;
+        bool ok = writeBlocks((outDir / "products.txt").string(), to_string(productCount + 1) + "\n", blocks, threads,
+                              [&](long b, string& out) {
+                                  long last = min(productCount, (b + 1) * PRODUCT_BLOCK);
+                                  for (long id = b * PRODUCT_BLOCK + 1; id <= last; ++id) appendProductLine(out, catalog, id);
+                              }, bytes);
+        if (!ok) return 1;
+        report("products.txt", productCount, bytes, sw);
+    }
+
+    // Predicted level per shopper from their expected spend (Zipf share x average order)
+    vector<uint8_t> predictedLevel(static_cast<size_t>(userCount) + 1, 1);
+    if (txCount > 0) {
+        double harmonic = 0;
+        for (long k = 1; k <= shoppers.count; ++k) harmonic += pow(static_cast<double>(k), -SHOPPER_ZIPF);
+        long long sampleCents = 0;
+        const int SAMPLES = 4096;
+        for (int i = 0; i < SAMPLES; ++i) {
+            SplitMix r(seed, SampleStream, static_cast<uint64_t>(i));
+            OrderLine lines[MAX_ORDER_LINES];
+            int n = makeBasket(r, catalog, MAX_ORDER_LINES, 0.45, lines);
+            sampleCents += basketCents(catalog, lines, n);
+        }
+        double averageOrder = sampleCents / 100.0 / SAMPLES;
+        for (long rank = 1; rank <= shoppers.count; ++rank) {
+            double expectedOrders = txCount * pow(static_cast<double>(rank), -SHOPPER_ZIPF) / harmonic;
+            predictedLevel[shoppers.userOf(rank)] = static_cast<uint8_t>(levelFor(expectedOrders * averageOrder));
+        }
+    }
+
+    // TransactionRecord.txt: fixed-width nextTransactionID, then TX| lines each followed by its ITEM| lines
+    vector<atomic<long long>> spentCents(static_cast<size_t>(userCount) + 1);
+    {
+        Stopwatch sw;
+        uint64_t bytes = 0;
+        atomic<long> lineCount(0);
+        int64_t start = 0, end = 0;
+        Transaction::parseTimestamp(HISTORY_START, start);
+        Transaction::parseTimestamp(HISTORY_END, end);
+        double span = static_cast<double>(end - start);
+        char head[32];
+        snprintf(head, sizeof(head), "%010ld\n", txCount + 1);
+        long blocks = (txCount + TX_BLOCK - 1) / TX_BLOCK;
+        bool ok = writeBlocks((outDir / "TransactionRecord.txt").string(), head, blocks, threads,
+                              [&](long b, string& out) {
+            TimestampFormatter when;
+            long lines = 0;
+            long last = min(txCount, (b + 1) * TX_BLOCK);
+            for (long id = b * TX_BLOCK + 1; id <= last; ++id) {
+                SplitMix r(seed, OrderStream, static_cast<uint64_t>(id));
+                long userID = shoppers.pick(r);
+                OrderLine items[MAX_ORDER_LINES];
+                int n = makeBasket(r, catalog, MAX_ORDER_LINES, 0.45, items);
+                long long raw = basketCents(catalog, items, n);
+                int level = predictedLevel[userID];
+                long long finalCents = level >= 3 ? llround(raw * 0.95) : level == 2 ? llround(raw * 0.98) : raw;
+                spentCents[userID].fetch_add(finalCents, memory_order_relaxed);
+                // evenly spaced with jitter inside the slot, so timestamps never go backwards
+                int64_t epoch = start + static_cast<int64_t>((static_cast<double>(id - 1) + r.unit()) * span / txCount);
+
+                // TX|transactionID|userID|rawTotal|discountRate|finalTotal|timestamp|userLevel|itemCount
+                out += "TX|";
+                appendInt(out, id);
+                out += '|';
+                appendInt(out, userID);
+                out += '|';
+                appendCents(out, raw);
+                out += '|';
+                out += rateText(level);
+                out += '|';
+                appendCents(out, finalCents);
+                out += '|';
+                when.append(out, epoch);
+                out += '|';
+                appendInt(out, level);
+                out += '|';
+                appendInt(out, n);
+                out += '\n';
+                // ITEM|productID|productName|category|section|unitPrice|q0|q1|q2|q3|q4|q5|subtotal
+                for (int i = 0; i < n; ++i) {
+                    const ProductInfo& p = catalog.info[items[i].productID];
+                    out += "ITEM|";
+                    appendInt(out, items[i].productID);
+                    out += '|';
+                    out += catalog.prefixOf(p);
+                    appendInt(out, items[i].productID);
+                    out += '|';
+                    appendInt(out, static_cast<int>(p.category));
+                    out += '|';
+                    appendInt(out, static_cast<int>(p.section));
+                    out += '|';
+                    appendCents(out, 100LL * p.price);
+                    int units = 0;
+                    for (int q : items[i].quantities) {
+                        out += '|';
+                        appendInt(out, q);
+                        units += q;
+                    }
+                    out += '|';
+                    appendCents(out, 100LL * p.price * units);
+                    out += '\n';
+                }
+                lines += 1 + n;
+            }
+            lineCount.fetch_add(lines, memory_order_relaxed);
+        }, bytes);
+        if (!ok) return 1;
+        report("TransactionRecord.txt", txCount, bytes, sw);
+        printf("%-22s %12ld lines\n", "", lineCount.load());
+    }
+
+    // users.txt: nextUserID, then userID|username|password|level|isAdmin|totalSpent
+    long levelCount[4] = {0, 0, 0, 0};
+    {
+        Stopwatch sw;
+        uint64_t bytes = 0;
+        mutex levelLock;
+        long blocks = (userCount + USER_BLOCK - 1) / USER_BLOCK;
+        bool ok = writeBlocks((outDir / "users.txt").string(), to_string(userCount + 1) + "\n", blocks, threads,
+                              [&](long b, string& out) {
+            long levels[4] = {0, 0, 0, 0};
+            long last = min(userCount, (b + 1) * USER_BLOCK);
+            for (long id = b * USER_BLOCK + 1; id <= last; ++id) {
+                if (id == 1) {
+                    out += "1|admin|passwd123|1|1|0.000000\n";
+                    continue;
+                }
+                long long cents = spentCents[id].load(memory_order_relaxed);
+                int level = levelFor(cents / 100.0);
+                ++levels[level];
+                appendInt(out, id);
+                out += "|user";
+                appendInt(out, id);
+                out += "|pass";
+                appendInt(out, id);
+                out += '|';
+                appendInt(out, level);
+                out += "|0|";
+                appendCents(out, cents);
+                out += "0000\n";
+            }
+            lock_guard<mutex> lock(levelLock);
+            for (int l = 1; l <= 3; ++l) levelCount[l] += levels[l];
+        }, bytes);
+        if (!ok) return 1;
+        report("users.txt", userCount, bytes, sw);
+        printf("%-22s %12s Silver %ld, Gold %ld, Diamond %ld\n", "", "", levelCount[1], levelCount[2], levelCount[3]);
+    }
+
+    // cart_<userID>.txt for the most active shoppers: line count, then productID q0 q1 q2 q3 q4 q5
+    if (cartCount > 0) {
+        Stopwatch sw;
+        atomic<long> nextRank(1);
+        atomic<uint64_t> bytes(0);
+        atomic<bool> ok(true);
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&]() {
+                string out;
+                for (long rank; (rank = nextRank.fetch_add(1)) <= cartCount && ok;) {
+                    int userID = static_cast<int>(shoppers.userOf(rank));
+                    SplitMix r(seed, CartStream, static_cast<uint64_t>(userID));
+                    OrderLine lines[MAX_CART_LINES];
+                    int n = makeBasket(r, catalog, MAX_CART_LINES, 0.55, lines);
+                    out.clear();
+                    appendInt(out, n);
+                    out += '\n';
+                    for (int i = 0; i < n; ++i) {
+                        appendInt(out, lines[i].productID);
+                        for (int q : lines[i].quantities) {
+                            out += ' ';
+                            appendInt(out, q);
+                        }
+                        out += '\n';
+                    }
+                    string path = (outDir / ShoppingCart::getShoppingCartFileName(userID)).string();
+                    FILE* f = fopen(path.c_str(), "wb");
+                    bool written = f && fwrite(out.data(), 1, out.size(), f) == out.size();
+                    if (f && fclose(f) != 0) written = false;
+                    if (!written) {
+                        cout << "Failed to write file: " << path << endl;
+                        ok = false;
+                    }
+                    bytes += out.size();
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        if (!ok) return 1;
+        report("cart_<id>.txt", cartCount, bytes, sw);
+    }
+
+    printf("\ndone in %.1f s\n", total.elapsedMs() / 1000.0);
+    return 0;
+}
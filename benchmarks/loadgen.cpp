@@ -0,0 +1,205 @@
+// Load generator: concurrent shoppers against one catalog and one transaction store.
+// usage: loadgen [threads=4] [opsPerThread=20000] [seed=1] [mix=40,40,10,10]
+//                [products=10000] [users=1000] [history=100000] [limitedStock=0]
+//
+// Builds a synthetic catalog, users.txt and a transaction history in a scratch directory,
+// then every thread drives its own shoppers (users 2..users, split by thread) through a
+// random sequence of operations, weighted by mix = browse,add,checkout,history:
+//   browse    one page (20 products) of a random category/section, reading price and stock
+//   add       add a Zipf-popular product (random size, 1-2 units) to the shopper's cart
+//   checkout  TransactionManager::checkout with ShortagePolicy::DropShort
+//   history   the shopper's stats plus their transactions of the last 90 days
+// Reports throughput and p50/p99/p999 latency per operation.
+//
+// Each thread's operation sequence depends only on the seed and the thread number, so
+// "ops digest" is identical between runs with the same arguments. With limitedStock=0
+// (every size gets effectively unlimited stock) the outcomes are identical too
+// ("outcome digest"); with limitedStock=1 shoppers compete for the generated stock and
+// outcomes depend on thread timing.
+
+#include <atomic>
+#include <thread>
+
+#include "BenchData.h"
+#include "BenchUtil.h"
+#include "../TransactionStore.h"
+#include "../User.h"
+
+enum Op { Browse, AddToCart, Checkout, History, OP_COUNT };
+static const char* const OP_NAMES[OP_COUNT] = {"browse", "add", "checkout", "history"};
+static const int PAGE_SIZE = 20;
+
+// FNV-1a over 64-bit values
+struct Digest {
+    uint64_t h = 1469598103934665603ull;
+    void add(uint64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            h ^= (v >> (i * 8)) & 0xFF;
+            h *= 1099511628211ull;
+        }
+    }
+};
+
+struct ThreadResult {
+    vector<double> latencyUs[OP_COUNT];
+    Digest ops, outcomes;
+};
+
+static void runShopper(int t, int threads, long opsPerThread, uint64_t seed, const int (&mix)[OP_COUNT],
+                       ProductManager& pm, UserList& users, const ZipfSampler& popularity,
+                       int64_t historyFrom, ThreadResult& out) {
+    mt19937_64 rng(seed * 1000003ull + static_cast<uint64_t>(t));
+    const ProductManager& catalog = pm;
+    vector<User*> shoppers;     // users 2.. dealt round-robin, so no two threads share a cart
+    for (size_t i = 1 + t; i < users.size(); i += threads) shoppers.push_back(&users[i]);
+    if (shoppers.empty()) return;
+    int mixTotal = 0;
+    for (int w : mix) mixTotal += w;
+    for (auto& v : out.latencyUs) v.reserve(static_cast<size_t>(opsPerThread) * 2 / OP_COUNT);
+
+    for (long i = 0; i < opsPerThread; ++i) {
+        int pick = static_cast<int>(rng() % mixTotal);
+        int op = 0;
+        while (pick >= mix[op]) pick -= mix[op++];
+        User& u = *shoppers[rng() % shoppers.size()];
+        out.ops.add(static_cast<uint64_t>(op) << 32 | static_cast<uint32_t>(u.userID));
+
+        // draw the arguments before starting the clock
+        static const Section ADULT[3] = {Section::Eastern, Section::Western, Section::Other};
+        static const Section KIDS[3] = {Section::Boys, Section::Girls, Section::Other};
+        Category cat = static_cast<Category>(rng() % 4);
+        int secDraw = static_cast<int>(rng() % 3);
+        Section sec = cat == Category::Kids ? KIDS[secDraw] : cat == Category::Other ? Section::Other : ADULT[secDraw];
+        uint64_t pageDraw = rng();
+        int productID = static_cast<int>(popularity(rng));
+        int sizeDraw = static_cast<int>(rng() % 5);
+        int quantity = 1 + static_cast<int>(rng() % 2);
+
+        uint64_t outcome = 0;
+        Stopwatch sw;
+        switch (op) {
+            case Browse: {
+                const vector<int>& ids = catalog.getSectionProductIDs(cat, sec);
+                if (ids.empty()) break;
+                size_t first = pageDraw % ids.size();
+                double sum = 0;
+                for (size_t k = first; k < ids.size() && k < first + PAGE_SIZE; ++k) {
+                    const Product* p = catalog.getProduct(ids[k]);
+                    sum += p->getPrice() + (p->getTotalStock() > 0 ? 1 : 0);
+                }
+                outcome = static_cast<uint64_t>(sum);
+                break;
+            }
+            case AddToCart: {
+                const Product* p = catalog.getProduct(productID);
+                Size size = p && p->getHasSize() ? static_cast<Size>(sizeDraw) : Size::None;
+                outcome = static_cast<uint64_t>(u.addToCart(productID, size, quantity, pm));
+                break;
+            }
+            case Checkout: {
+                Transaction receipt;
+                CheckoutStatus status = u.txm.checkout(u.cart, pm, u.level, false,
+                                                       ShortagePolicy::DropShort, &receipt);
+                outcome = static_cast<uint64_t>(status);
+                if (status == CheckoutStatus::Success) {
+                    u.totalSpent += receipt.getFinalTotal();
+                    outcome = outcome * 31 + static_cast<uint64_t>(receipt.getFinalTotal() * 100);
+                }
+                break;
+            }
+            case History: {
+                TransactionStats stats = u.txm.getStats();
+                auto recent = u.txm.findByTimeRange(historyFrom, INT64_MAX);
+                outcome = static_cast<uint64_t>(stats.count) * 31 + recent.size();
+                break;
+            }
+        }
+        out.latencyUs[op].push_back(sw.elapsedMs() * 1000.0);
+        out.outcomes.add(outcome);
+    }
+}
+
+static double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[min(max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+int main(int argc, char** argv) {
+    int threads = static_cast<int>(max(1L, argOr(argc, argv, 1, 4)));
+    long opsPerThread = argOr(argc, argv, 2, 20000);
+    uint64_t seed = static_cast<uint64_t>(argOr(argc, argv, 3, 1));
+    int mix[OP_COUNT] = {40, 40, 10, 10};
+    if (argc > 4 && sscanf(argv[4], "%d,%d,%d,%d", &mix[0], &mix[1], &mix[2], &mix[3]) != 4) {
+        cout << "mix must be four weights: browse,add,checkout,history" << endl;
+        return 2;
+    }
+    if (mix[0] < 0 || mix[1] < 0 || mix[2] < 0 || mix[3] < 0 || mix[0] + mix[1] + mix[2] + mix[3] <= 0) {
+        cout << "mix weights must be >= 0 with a positive sum" << endl;
+        return 2;
+    }
+    long productCount = max(1L, argOr(argc, argv, 5, 10000));
+    long userCount = max(2L, argOr(argc, argv, 6, 1000));
+    long history = argOr(argc, argv, 7, 100000);
+    bool limitedStock = argOr(argc, argv, 8, 0) != 0;
+
+    ScratchDir scratch("shop_loadgen");
+    writeProductsFile(productCount);
+    writeUsersFile(userCount);
+    writeTransactionFile(history, userCount);
+
+    ProductManager pm;
+    UserList users;
+    int nextUserID = 1;
+    {
+        QuietCout quiet;
+        pm.loadFromFile("products.txt");
+        User::loadAll(users, nextUserID);
+    }
+    if (!limitedStock) {
+        SizeStock plenty;
+        plenty.fill(1 << 30);
+        for (long id = 1; id <= productCount; ++id) pm.getProduct(static_cast<int>(id))->setSizeStock(plenty);
+    }
+    ZipfSampler popularity(productCount, 1.0);
+    int64_t historyFrom = 0;
+    Transaction::parseTimestamp("2025-10-01", historyFrom);
+
+    printf("%d threads x %ld ops, seed %llu, mix browse/add/checkout/history = %d/%d/%d/%d\n",
+           threads, opsPerThread, static_cast<unsigned long long>(seed), mix[0], mix[1], mix[2], mix[3]);
+    printf("%ld products, %zu users, %ld past transactions, %s stock\n\n",
+           productCount, users.size(), history, limitedStock ? "limited" : "unlimited");
+
+    vector<ThreadResult> results(threads);
+    vector<thread> workers;
+    Stopwatch wall;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(runShopper, t, threads, opsPerThread, seed, cref(mix), ref(pm), ref(users),
+                             cref(popularity), historyFrom, ref(results[t]));
+    }
+    for (auto& w : workers) w.join();
+    double wallSec = wall.elapsedMs() / 1000.0;
+
+    printf("%-10s %10s %12s %10s %10s %10s %10s\n", "op", "count", "ops/s", "p50_us", "p99_us", "p999_us", "max_us");
+    long total = 0;
+    for (int op = 0; op < OP_COUNT; ++op) {
+        vector<double> all;
+        for (const auto& r : results) all.insert(all.end(), r.latencyUs[op].begin(), r.latencyUs[op].end());
+        sort(all.begin(), all.end());
+        total += static_cast<long>(all.size());
+        printf("%-10s %10zu %12.0f %10.2f %10.2f %10.2f %10.2f\n", OP_NAMES[op], all.size(),
+               all.size() / wallSec, percentile(all, 50), percentile(all, 99), percentile(all, 99.9),
+               all.empty() ? 0.0 : all.back());
+    }
+    Digest ops, outcomes;
+    for (const auto& r : results) {
+        ops.add(r.ops.h);
+        outcomes.add(r.outcomes.h);
+    }
+    printf("%-10s %10ld %12.0f\n\n", "total", total, total / wallSec);
+    printf("transactions in store: %zu\n", TransactionStore::instance().all().size());
+    printf("ops digest:     %016llx\n", static_cast<unsigned long long>(ops.h));
+    printf("outcome digest: %016llx%s\n", static_cast<unsigned long long>(outcomes.h),
+           limitedStock ? "  (timing dependent with limited stock)" : "");
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Binary snapshot tool: inspect a snapshot, or convert between it and the text data files
+// usage: snapshot_tool info <snapshot>
+//        snapshot_tool export <snapshot> <dir>    write products.txt, users.txt and
+//                                                 TransactionRecord.txt into dir
+//        snapshot_tool import <dir> <snapshot>    read those files from dir, write the snapshot
+//
+// import stamps the files it read, so the application (run in dir) accepts the snapshot until
+// they change. export loads any valid snapshot, stale or not. Both print their load times.
+
+#include <cstdio>
+#include <filesystem>
+
+#include "BenchUtil.h"
+#include "../Snapshot.h"
+
+static void printInfo(const SnapshotInfo& info) {
+    printf("version            %u\n", info.version);
+    printf("created            %s\n", Transaction::formatTimestamp(info.createdEpoch).c_str());
+    printf("file size          %llu bytes\n", static_cast<unsigned long long>(info.fileBytes));
+    printf("products           %llu (next ID %d)\n", static_cast<unsigned long long>(info.products), info.nextProductID);
+    printf("users              %llu (next ID %d)\n", static_cast<unsigned long long>(info.users), info.nextUserID);
+    printf("transactions       %llu (next ID %d)\n", static_cast<unsigned long long>(info.transactions),
+           info.nextTransactionID);
+    printf("transaction items  %llu\n", static_cast<unsigned long long>(info.items));
+}
+
+static int usage() {
+    cout << "usage: snapshot_tool info <snapshot>\n"
+            "       snapshot_tool export <snapshot> <dir>\n"
+            "       snapshot_tool import <dir> <snapshot>\n";
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage();
+    string command = argv[1];
+
+    if (command == "info") {
+        SnapshotInfo info;
+        SnapshotStatus status = Snapshot::info(argv[2], info);
+        if (status != SnapshotStatus::Success) {
+            cout << argv[2] << ": " << snapshotStatusToString(status) << endl;
+            return 1;
+        }
+        printInfo(info);
+        return 0;
+    }
+    if (argc < 4 || (command != "export" && command != "import")) return usage();
+
+    if (command == "export") {
+        filesystem::path dir = argv[3];
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+        ProductManager pm;
+        UserList users;
+        int nextUserID = 1;
+        TransactionStore store((dir / "TransactionRecord.txt").string());
+
+        Stopwatch sw;
+        SnapshotStatus status = Snapshot::load(argv[2], pm, users, nextUserID, store);
+        if (status != SnapshotStatus::Success) {
+            cout << argv[2] << ": " << snapshotStatusToString(status) << endl;
+            return 1;
+        }
+        printf("snapshot loaded in %.1f ms\n", sw.elapsedMs());
+        sw.reset();
+        bool ok = pm.saveToFile((dir / "products.txt").string()) &&
+                  User::saveAll(users, nextUserID, (dir / User::usersFileName()).string()) &&
+                  store.save();
+        if (!ok) {
+            cout << "Export to " << dir.string() << " failed" << endl;
+            return 1;
+        }
+        printf("text files written to %s in %.1f ms\n", dir.string().c_str(), sw.elapsedMs());
+        return 0;
+    }
+
+    // import
+    filesystem::path dir = argv[2];
+    SnapshotSources sources;
+    sources.productFile = (dir / "products.txt").string();
+    sources.usersFile = (dir / User::usersFileName()).string();
+    sources.transactionFile = (dir / "TransactionRecord.txt").string();
+    ProductManager pm;
+    UserList users;
+    int nextUserID = 1;
+    TransactionStore store(sources.transactionFile);
+
+    Stopwatch sw;
+    bool ok;
+    {
+        QuietCout quiet;    // the loaders report to the console
+        ok = pm.loadFromFile(sources.productFile) && User::loadAll(users, nextUserID, sources.usersFile) &&
+             store.reload();
+    }
+    if (!ok) {
+        cout << "Cannot read the data files in " << dir.string() << endl;
+        return 1;
+    }
+    printf("text files loaded in %.1f ms\n", sw.elapsedMs());
+    sw.reset();
+    SnapshotStatus status = Snapshot::write(argv[3], pm, users, nextUserID, store, sources);
+    if (status != SnapshotStatus::Success) {
+        cout << argv[3] << ": " << snapshotStatusToString(status) << endl;
+        return 1;
+    }
+    printf("snapshot written in %.1f ms\n", sw.elapsedMs());
+
+    // time the startup path the application takes
+    ProductManager pm2;
+    UserList users2;
+    int nextUserID2 = 1;
+    TransactionStore store2(sources.transactionFile);
+    sw.reset();
+    status = Snapshot::load(argv[3], pm2, users2, nextUserID2, store2, &sources);
+    if (status != SnapshotStatus::Success) {
+        cout << argv[3] << ": " << snapshotStatusToString(status) << endl;
+        return 1;
+    }
+    printf("snapshot loaded in %.1f ms\n\n", sw.elapsedMs());
+    SnapshotInfo info;
+    if (Snapshot::info(argv[3], info) == SnapshotStatus::Success) printInfo(info);
+    return 0;
+}
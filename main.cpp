@@ -1,5 +1,6 @@
 #include "ProductManager.h"
 #include "ShoppingCart.h"
+#include "TransactionStore.h"
 #include "User.h"
 #include <iostream>
 #include <string>
@@ -9,28 +10,25 @@ using namespace std;
 void testAll() {
     ProductManager pm;
 
-    cout << "\n=== Add products via addProduct (follow console prompts) ===" << endl;
-    // 推荐输入序列见下方注释，确保覆盖有尺码和无尺码两种库存模式
-    int idMenEast = pm.addProduct("MenShirt_Eastern", Category::Men, Section::Eastern, 199.0);
-    // 输入建议：hasSize=1; XS=10 S=20 M=30 L=40 XL=50
-
-    int idMenWest = pm.addProduct("MenBoots_Western", Category::Men, Section::Western, 499.0);
-    // 输入建议：hasSize=0; total(None)=15
-
-    int idWomenEast = pm.addProduct("WomenDress_Eastern", Category::Women, Section::Eastern, 299.0);
-    // 输入建议：hasSize=1; XS=5 S=10 M=8 L=6 XL=3
-
-    int idWomenOther = pm.addProduct("WomenAccessory_Other", Category::Women, Section::Other, 99.0);
-    // 输入建议：hasSize=0; total(None)=100
-
-    int idKidsBoys = pm.addProduct("KidsToy_Boys", Category::Kids, Section::Boys, 59.0);
-    // 输入建议：hasSize=0; total(None)=200
-
-    int idKidsGirls = pm.addProduct("KidsSkirt_Girls", Category::Kids, Section::Girls, 149.0);
-    // 输入建议：hasSize=1; XS=2 S=3 M=4 L=2 XL=1
-
-    int idOther = pm.addProduct("GiftCard", Category::Other, Section::Other, 50.0);
-    // 输入建议：hasSize=0; total(None)=1000
+    cout << "\n=== Add products via addProduct ===" << endl;
+    // 覆盖有尺码和无尺码两种库存模式: SizeStock = {XS, S, M, L, XL, None}
+    auto add = [&pm](const string& name, Category cat, Section sec, double price,
+                     bool hasSize, const SizeStock& stock) {
+        int id = -1;
+        ProductStatus status = pm.addProduct(name, cat, sec, price, hasSize, stock, &id);
+        cout << "addProduct " << name << ": " << productStatusToString(status) << ", ID = " << id << endl;
+        return id;
+    };
+    int idMenEast = add("MenShirt_Eastern", Category::Men, Section::Eastern, 199.0, true, {10, 20, 30, 40, 50, 0});
+    int idMenWest = add("MenBoots_Western", Category::Men, Section::Western, 499.0, false, {0, 0, 0, 0, 0, 15});
+    add("WomenDress_Eastern", Category::Women, Section::Eastern, 299.0, true, {5, 10, 8, 6, 3, 0});
+    int idWomenOther = add("WomenAccessory_Other", Category::Women, Section::Other, 99.0, false, {0, 0, 0, 0, 0, 100});
+    int idKidsBoys = add("KidsToy_Boys", Category::Kids, Section::Boys, 59.0, false, {0, 0, 0, 0, 0, 200});
+    int idKidsGirls = add("KidsSkirt_Girls", Category::Kids, Section::Girls, 149.0, true, {2, 3, 4, 2, 1, 0});
+    int idOther = add("GiftCard", Category::Other, Section::Other, 50.0, false, {0, 0, 0, 0, 0, 1000});
+    // 重名与分类错误会被拒绝
+    add("GiftCard", Category::Other, Section::Other, 50.0, false, {0, 0, 0, 0, 0, 1});
+    add("BadSection", Category::Men, Section::Girls, 10.0, false, {0, 0, 0, 0, 0, 1});
 
     cout << "\n=== Display all products ===" << endl;
     pm.displayAllProducts();
@@ -72,25 +70,26 @@ void testAll() {
     pm2.removeProduct(idMenWest);
     pm2.displayAllProducts();
 
-    // 购物车测试（需要交互式输入）
-    cout << "\n=== Shopping cart operations (follow console prompts) ===" << endl;
+    cout << "\n=== Shopping cart operations ===" << endl;
     ShoppingCart cart;
 
     cout << "\n--- Add items to cart ---" << endl;
-    // 推荐：对有 None 库存的产品，系统会自动选择 Size::None
-    // 对有尺码的产品，系统会让你输入尺码索引（0-4）
-    cart.addItem(idMenEast, pm2);     // 输入建议：quantity=2，然后选择尺码，比如 2(M)
-    cart.addItem(idKidsGirls, pm2);   // 输入建议：quantity=3，选择尺码，比如 1(S)
-    cart.addItem(idOther, pm2);       // 输入建议：quantity=5（自动 None）
+    // 有尺码的产品使用 XS-XL，无尺码的产品使用 Size::None
+    cout << "add MenShirt M x2: " << cartStatusToString(cart.addItem(idMenEast, Size::M, 2, pm2)) << endl;
+    cout << "add KidsSkirt S x3: " << cartStatusToString(cart.addItem(idKidsGirls, Size::S, 3, pm2)) << endl;
+    cout << "add GiftCard x5: " << cartStatusToString(cart.addItem(idOther, Size::None, 5, pm2)) << endl;
+    cout << "add KidsSkirt XL x9 (too many): " << cartStatusToString(cart.addItem(idKidsGirls, Size::XL, 9, pm2)) << endl;
+    cout << "add GiftCard size M (no sizes): " << cartStatusToString(cart.addItem(idOther, Size::M, 1, pm2)) << endl;
 
     cout << "\n--- Display cart ---" << endl;
     cart.displayCart(pm2);
 
     cout << "\n--- Update item in cart ---" << endl;
-    cart.updateItem(idMenEast, pm2);  // 输入建议：quantity=4，选择尺码同上（覆盖原尺码数量）
+    // 覆盖原尺码数量
+    cout << "update MenShirt M x4: " << cartStatusToString(cart.updateItem(idMenEast, Size::M, 4, pm2)) << endl;
 
     cout << "\n--- Remove one item ---" << endl;
-    cart.removeItem(idOther);
+    cout << "remove GiftCard: " << cartStatusToString(cart.removeItem(idOther)) << endl;
 
     cout << "\n--- Calculate total ---" << endl;
     double total = cart.calculateTotal(pm2);
@@ -103,6 +102,19 @@ void testAll() {
     cart2.loadFromFile(cartFile);
     cart2.displayCart(pm2);
 
+    cout << "\n=== Checkout with a shortage policy ===" << endl;
+    // 只剩 1 件 XL: TrimToStock 把数量降到库存量后结算
+    TransactionStore store("TransactionRecord_test.txt");
+    store.reload();
+    TransactionManager txm(1001, store);
+    cart2.addItem(idKidsGirls, Size::XL, 1, pm2);
+    pm2.updateProduct(idKidsGirls, Size::XL, 0);
+    cout << "Reject: " << checkoutStatusToString(txm.checkout(cart2, pm2, 1, false, ShortagePolicy::Reject)) << endl;
+    Transaction receipt;
+    CheckoutStatus status = txm.checkout(cart2, pm2, 1, false, ShortagePolicy::TrimToStock, &receipt);
+    cout << "TrimToStock: " << checkoutStatusToString(status) << endl;
+    if (status == CheckoutStatus::Success) receipt.displayInvoice();
+
     cout << "\n=== Test finished ===" << endl;
 }
 
@@ -0,0 +1,94 @@
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// Small helpers shared by the regression tests (run by ctest). A test program returns
+// failures() from main, so any failed check fails the test.
+
+static int& failures() {
+    static int count = 0;
+    return count;
+}
+
+// Report a failed condition with its location; the test keeps going
+#define CHECK(cond) checkThat((cond), #cond, __FILE__, __LINE__)
+static void checkThat(bool ok, const char* what, const char* file, int line) {
+    if (ok) return;
+    ++failures();
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+}
+
+// Create an empty scratch directory and make it the working directory, so the data files
+// the classes use ("TransactionRecord.txt", ...) land there. Removed again unless
+// TEST_KEEP_DATA is set.
+class ScratchDir {
+private:
+    filesystem::path oldDir;
+    filesystem::path dir;
+public:
+    explicit ScratchDir(const string& name)
+        : oldDir(filesystem::current_path()),
+          dir(filesystem::temp_directory_path() / name) {
+        filesystem::remove_all(dir);
+        filesystem::create_directories(dir);
+        filesystem::current_path(dir);
+    }
+    ~ScratchDir() {
+        filesystem::current_path(oldDir);
+        if (!getenv("TEST_KEEP_DATA")) filesystem::remove_all(dir);
+    }
+};
+
+// Resident set size in kB from /proc/self/status; -1 if unavailable
+static long currentRssKB() {
+    ifstream fin("/proc/self/status");
+    string line;
+    while (getline(fin, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            istringstream iss(line.substr(6));
+            long kb = -1;
+            iss >> kb;
+            return kb;
+        }
+    }
+    return -1;
+}
+
+// Stream buffer that accepts and discards everything
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+// Discard everything written to cout while in scope
+class QuietCout {
+private:
+    NullBuffer nullBuf;
+    streambuf* old;
+public:
+    QuietCout() : old(cout.rdbuf(&nullBuf)) {}
+    ~QuietCout() { cout.rdbuf(old); }
+};
+
+// Collect everything written to cout while in scope
+class CaptureCout {
+private:
+    ostringstream captured;
+    streambuf* old;
+public:
+    CaptureCout() : old(cout.rdbuf(captured.rdbuf())) {}
+    ~CaptureCout() { cout.rdbuf(old); }
+    string text() const { return captured.str(); }
+};
+
+#endif // TESTUTIL_H
@@ -0,0 +1,47 @@
+// A cart log path that holds some other file: the store refuses to write to it or replace it,
+// and migrating per-user cart files neither imports nor deletes them.
+
+#include "TestUtil.h"
+#include "../CartStore.h"
+
+static string readAll(const string& path) {
+    ifstream in(path, ios::binary);
+    ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+int main() {
+    ScratchDir scratch("shop_test_cartstore");
+    const string foreign = "not a cart log\nsome,other,data\n";
+    {
+        ofstream out("carts.log", ios::binary);
+        out << foreign;
+    }
+    ShoppingCart legacy;
+    legacy.setQuantity(3, Size::M, 2);
+    const string legacyFile = ShoppingCart::getShoppingCartFileName(5);
+    CHECK(legacy.saveToFile(legacyFile));
+
+    CartStore store("carts.log");
+    store.setFlushInterval(0);
+    size_t migrated;
+    {
+        QuietCout quiet;
+        CHECK(!store.ensureLoaded());
+        migrated = store.migrateLegacyFiles(".");
+    }
+    CHECK(migrated == 0);
+    CHECK(filesystem::exists(legacyFile));
+
+    // carts still work for this session, but nothing reaches the file
+    store.save(1, legacy);
+    ShoppingCart loaded;
+    store.load(1, loaded);
+    CHECK(loaded.getItems().size() == 1);
+    CHECK(!store.flush());
+    CHECK(!store.compact());
+    CHECK(readAll("carts.log") == foreign);
+    CHECK(!filesystem::exists("carts.log.tmp"));
+    return failures();
+}
@@ -0,0 +1,66 @@
+// Checkout without console I/O: a cart line whose product was removed from the catalog is
+// reported through the status, nothing is printed and no stock stays taken. The rolled-back
+// attempt leaves nothing to journal; a successful one journals the products it took stock from.
+
+#include "TestUtil.h"
+#include "../TransactionStore.h"
+
+static long journalBytes() {
+    error_code ec;
+    auto size = filesystem::file_size("products.txt.journal", ec);
+    return ec ? 0 : static_cast<long>(size);
+}
+
+int main() {
+    ScratchDir scratch("shop_test_checkout");
+    ProductManager pm;
+    int kept = -1, removed = -1;
+    pm.addProduct("Shirt", Category::Men, Section::Eastern, 20.0, true, {5, 5, 5, 5, 5, 0}, &kept);
+    pm.addProduct("Scarf", Category::Women, Section::Other, 10.0, false, {0, 0, 0, 0, 0, 5}, &removed);
+
+    // the kept product comes first in the cart, so its stock is taken before the missing one is hit
+    ShoppingCart cart;
+    cart.setQuantity(kept, Size::M, 2);
+    cart.setQuantity(removed, Size::None, 1);
+    {
+        QuietCout quiet;
+        pm.saveToFile("products.txt");
+        pm.removeProduct(removed);
+        pm.saveToFile("products.txt");      // journals the removal
+    }
+    long journalBefore = journalBytes();
+
+    TransactionStore store("TransactionRecord.txt");
+    TransactionManager txm(1, store);
+    CheckoutStatus committed, checkedOut;
+    string output;
+    {
+        CaptureCout capture;
+        committed = txm.commitCheckout(cart, pm, 1, false);
+        checkedOut = txm.checkout(cart, pm, 1, false, ShortagePolicy::Reject);
+        output = capture.text();
+    }
+
+    CHECK(committed == CheckoutStatus::ProductNotFound);
+    CHECK(checkedOut == CheckoutStatus::OutOfStock);
+    CHECK(output.empty());
+    if (!output.empty()) fprintf(stderr, "unexpected output:\n%s", output.c_str());
+    CHECK(pm.getProduct(kept)->getStock(Size::M) == 5);
+    CHECK(cart.getItems().size() == 2);
+    {
+        QuietCout quiet;
+        pm.saveToFile("products.txt");
+    }
+    CHECK(journalBytes() == journalBefore);
+
+    // without the missing line the checkout goes through and its product is journaled
+    cart.removeItem(removed);
+    CHECK(txm.commitCheckout(cart, pm, 1, false) == CheckoutStatus::Success);
+    CHECK(pm.getProduct(kept)->getStock(Size::M) == 3);
+    {
+        QuietCout quiet;
+        pm.saveToFile("products.txt");
+    }
+    CHECK(journalBytes() > journalBefore);
+    return failures();
+}
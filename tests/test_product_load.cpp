@@ -0,0 +1,63 @@
+// Loading a product file whose records include a huge ID: the product is kept and found,
+// without the ID table growing to that size, and survives a save and reload.
+
+#include "TestUtil.h"
+#include "../ProductManager.h"
+
+int main() {
+    ScratchDir scratch("shop_test_product_load");
+    const int HUGE_ID = 2000000000;
+    {
+        ofstream out("products.txt");
+        out << "3\n"
+            << "1,Shirt,0,0,20,1,2,3,4,5,0\n"
+            << HUGE_ID << ",Lamp,3,2,15,0,0,0,0,0,7\n"
+            << "2,Dress,1,1,30,5,4,3,2,1,0\n";
+    }
+
+    long rssBefore = currentRssKB();
+    ProductManager pm;
+    bool loaded;
+    {
+        QuietCout quiet;
+        loaded = pm.loadFromFile("products.txt");
+    }
+    CHECK(loaded);
+    CHECK(pm.getProductCount() == 3);
+    const Product* lamp = pm.getProduct(HUGE_ID);
+    CHECK(lamp && lamp->getProductName() == "Lamp" && lamp->getStock(Size::None) == 7);
+    CHECK(pm.getNextProductID() == HUGE_ID + 1);
+    // a table up to the huge ID would be tens of gigabytes
+    CHECK(rssBefore < 0 || currentRssKB() - rssBefore < 64 * 1024);
+
+    vector<const Product*> page = pm.getProductPage(0, 10);
+    CHECK(page.size() == 3 && page[0]->getProductID() == 1 && page[1]->getProductID() == 2 &&
+          page[2]->getProductID() == HUGE_ID);
+    CHECK(pm.getProductPage(2, 10).size() == 1);
+    CHECK(pm.getSectionProductIDs(Category::Other, Section::Other) == vector<int>{HUGE_ID});
+
+    // new products continue after the huge ID; a removed sparse product is gone from every view
+    int added = -1;
+    CHECK(pm.addProduct("Hat", Category::Other, Section::Other, 5.0, false, {0, 0, 0, 0, 0, 3}, &added) ==
+          ProductStatus::Success);
+    CHECK(added == HUGE_ID + 1 && pm.getProduct(added) != nullptr);
+    {
+        QuietCout quiet;
+        CHECK(pm.removeProduct(HUGE_ID));
+        CHECK(pm.saveToFile("saved.txt"));
+    }
+    CHECK(pm.getProductCount() == 3);
+    CHECK(pm.getProductPage(2, 10).size() == 1 && pm.getProductPage(2, 10)[0]->getProductID() == added);
+
+    ProductManager reloaded;
+    {
+        QuietCout quiet;
+        CHECK(reloaded.loadFromFile("saved.txt"));
+    }
+    CHECK(reloaded.getProductCount() == 3);
+    const ProductManager& view = reloaded;
+    CHECK(view.getProduct(HUGE_ID) == nullptr);
+    CHECK(view.getProduct(added) && view.getProduct(added)->getProductName() == "Hat");
+    CHECK(reloaded.getNextProductID() == added + 1);
+    return failures();
+}
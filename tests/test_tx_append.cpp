@@ -0,0 +1,120 @@
+// Concurrent appendNew under each durability mode: every record reaches the file, in ID order
+// (reload and pageAfter rely on that order), while setDurability is called meanwhile. Failed
+// writes are reported to every caller of the batch and leave no partial record behind.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+#include "TestUtil.h"
+#include "../TransactionStore.h"
+
+// IDs of the TX| lines in file order
+static vector<int> idsInFile(const string& path) {
+    ifstream in(path);
+    string line;
+    vector<int> ids;
+    while (getline(in, line)) {
+        if (line.rfind("TX|", 0) == 0) ids.push_back(stoi(line.substr(3)));
+    }
+    return ids;
+}
+
+static Transaction sampleTx(int userID) {
+    vector<TransactionItem> items;
+    items.emplace_back(1, "Item", Category::Other, Section::Other, 1.0, vector<int>{0, 0, 0, 0, 0, 1});
+    return Transaction(0, userID, std::move(items), 1.0, 1.0, 1.0, Transaction::currentEpoch(), 1);
+}
+
+int main() {
+    ScratchDir scratch("shop_test_tx_append");
+    const int THREADS = 4, PER_THREAD = 200;
+
+    for (Durability mode : {Durability::None, Durability::Fsync, Durability::GroupCommit}) {
+        remove("TransactionRecord.txt");
+        TransactionStore store("TransactionRecord.txt");
+        CHECK(store.reload());
+        store.setDurability(mode, mode == Durability::GroupCommit ? 50 : 0);
+
+        vector<thread> workers;
+        for (int t = 0; t < THREADS; ++t) {
+            workers.emplace_back([&store, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    Transaction tx = sampleTx(t + 1);
+                    store.appendNew(tx);
+                }
+            });
+        }
+        // changing the mode while appends run must not race with them (the mode itself is kept)
+        for (int i = 0; i < 100; ++i) store.setDurability(mode, mode == Durability::GroupCommit ? 50 : 0);
+        for (auto& w : workers) w.join();
+
+        vector<int> ids = idsInFile("TransactionRecord.txt");
+        CHECK(ids.size() == static_cast<size_t>(THREADS * PER_THREAD));
+        bool ordered = true;
+        for (size_t i = 0; i < ids.size(); ++i) ordered = ordered && ids[i] == static_cast<int>(i) + 1;
+        CHECK(ordered);
+
+        TransactionStore reloaded("TransactionRecord.txt");
+        CHECK(reloaded.reload());
+        CHECK(reloaded.all().size() == ids.size() && reloaded.getNextTransactionID() == THREADS * PER_THREAD + 1);
+    }
+
+    // every batch fails here; a follower woken after a later batch failed must still see its own
+    {
+        QuietCout quiet;
+        TransactionStore store("no_such_dir/TransactionRecord.txt");
+        CHECK(store.reload());
+        store.setDurability(Durability::GroupCommit, 50);
+        atomic<int> succeeded(0);
+        vector<thread> workers;
+        for (int t = 0; t < THREADS; ++t) {
+            workers.emplace_back([&store, &succeeded, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    Transaction tx = sampleTx(t + 1);
+                    if (store.appendNew(tx)) ++succeeded;
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        CHECK(succeeded == 0);
+    }
+
+#ifndef _WIN32
+    // a write cut short (file size limit) is taken back out, so the next record starts cleanly
+    {
+        remove("TransactionRecord.txt");
+        TransactionStore store("TransactionRecord.txt");
+        CHECK(store.reload());
+        Transaction first = sampleTx(1);
+        CHECK(store.appendNew(first));
+
+        struct rlimit saved;
+        getrlimit(RLIMIT_FSIZE, &saved);
+        struct rlimit tight = saved;
+        tight.rlim_cur = static_cast<rlim_t>(ifstream("TransactionRecord.txt", ios::ate).tellg()) + 10;
+        signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &tight);
+        Transaction cut = sampleTx(2);
+        bool cutOk;
+        {
+            QuietCout quiet;
+            cutOk = store.appendNew(cut);
+        }
+        setrlimit(RLIMIT_FSIZE, &saved);
+        CHECK(!cutOk);
+
+        Transaction after = sampleTx(3);
+        CHECK(store.appendNew(after));
+        CHECK(idsInFile("TransactionRecord.txt") == vector<int>({1, 3}));
+        TransactionStore reloaded("TransactionRecord.txt");
+        CHECK(reloaded.reload());
+        CHECK(reloaded.all().size() == 2);
+    }
+#endif
+    return failures();
+}
@@ -0,0 +1,59 @@
+// Loading a transaction file with the old variable-width header and a record whose timestamp
+// cannot be read: the record is skipped like any malformed one and counted, the header upgrade
+// keeps it in the file as written instead of dropping or redating it, and nothing later
+// (save(), Rewrite mode) rewrites the file without it.
+
+#include "TestUtil.h"
+#include "../TransactionStore.h"
+
+static string readAll(const string& path) {
+    ifstream in(path, ios::binary);
+    ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+int main() {
+    ScratchDir scratch("shop_test_tx_load");
+    const string good = "TX|1|7|20.00|1.00|20.00|2025-12-08 10:30:00|1|1\n"
+                        "ITEM|3|Shirt|0|0|20.00|0|0|1|0|0|0|20.00\n";
+    const string badTime = "TX|2|7|15.00|1.00|15.00|someday|1|1\n"
+                           "ITEM|4|Scarf|1|2|15.00|0|0|0|0|0|1|15.00\n";
+    {
+        ofstream out("TransactionRecord.txt", ios::binary);
+        out << "3\n" << good << badTime;
+    }
+
+    TransactionStore store("TransactionRecord.txt");
+    {
+        CaptureCout out;
+        CHECK(store.reload());
+        CHECK(out.text().find("Skipped 1 unreadable") != string::npos);
+    }
+    CHECK(store.getSkippedRecords() == 1);
+    CHECK(store.all().size() == 1);
+    const Transaction* tx = store.findByID(1);
+    CHECK(tx && tx->getTimestamp() == "2025-12-08 10:30:00");
+    CHECK(store.findByID(2) == nullptr);
+
+    string text = readAll("TransactionRecord.txt");
+    CHECK(text == "0000000003\n" + good + badTime);
+
+    // a full rewrite would lose the skipped record: refused, and Rewrite mode appends instead
+    {
+        QuietCout quiet;
+        CHECK(!store.save());
+    }
+    CHECK(readAll("TransactionRecord.txt") == text);
+    store.setLogMode(LogMode::Rewrite);
+    vector<TransactionItem> items;
+    items.emplace_back(5, "Hat", Category::Other, Section::Other, 9.0, vector<int>{0, 0, 0, 0, 0, 1});
+    Transaction added(0, 7, std::move(items), 9.0, 1.0, 9.0, Transaction::currentEpoch(), 1);
+    CHECK(store.appendNew(added));
+    text = readAll("TransactionRecord.txt");
+    CHECK(text.find(badTime) != string::npos && text.find(added.serialize()) != string::npos);
+
+    // a long-range epoch formats without truncation
+    CHECK(Transaction::formatTimestamp(Transaction::epochOf(12345, 6, 7, 8, 9, 10)) == "12345-06-07 08:09:10");
+    return failures();
+}